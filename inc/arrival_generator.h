@@ -0,0 +1,169 @@
+#ifndef ARRIVAL_GENERATOR_H
+#define ARRIVAL_GENERATOR_H
+
+#include <cstddef>
+#include <vector>
+
+#include "constants.h"
+#include "ship.h"
+#include "ship_id_allocator.h"
+
+/* {{{ doc */
+/**
+ * @brief Generates ship arrivals for many time steps in one pass.
+ *
+ * Arrival counts, factions, and part counts for every buffered step are
+ * drawn into contiguous buffers first, and ships are then built from
+ * those buffers in arrival order. Arrivals are handed out one time step
+ * at a time by `next_step()`, which refills the buffer when it runs dry.
+ *
+ * Ship IDs come from the generator's own allocator, one block per
+ * refill, so every generator numbers its ships from
+ * `conf::starting_ship_id` up, whatever other threads are doing.
+ */
+/* }}} */
+class arrival_generator
+{
+public:
+
+  /* {{{ doc */
+  /**
+   * @brief Arrivals for a single time step. Ships may be moved out of
+   * the range. Valid until the next call to `next_step()` or
+   * `generate()`.
+   */
+  /* }}} */
+  struct arrivals {
+    std::vector<ship>::iterator first;
+    std::vector<ship>::iterator last;
+
+    [[nodiscard]] inline auto begin() const noexcept
+        -> std::vector<ship>::iterator
+    {
+      return first;
+    }
+
+    [[nodiscard]] inline auto end() const noexcept
+        -> std::vector<ship>::iterator
+    {
+      return last;
+    }
+
+    [[nodiscard]] inline auto size() const noexcept -> std::size_t
+    {
+      return static_cast<std::size_t>(last - first);
+    }
+  };
+
+private:
+
+  std::size_t m_lookahead;
+
+  // Number of arrivals for each buffered time step
+  std::vector<std::size_t> m_step_counts {};
+
+  // Every buffered arrival, in arrival order
+  std::vector<ship> m_ships {};
+
+  // Scratch buffers, kept to avoid reallocating on every refill
+  std::vector<ship::faction> m_factions {};
+  std::vector<std::size_t> m_part_counts {};
+
+  std::size_t m_next_step {0};
+  std::size_t m_next_ship {0};
+
+  ship_id_allocator m_ids {};
+
+  // Bytes allocated by the ships not yet handed out
+  std::size_t m_ship_bytes {0};
+
+public:
+
+  /* {{{ doc */
+  /**
+   * @param lookahead_steps Number of time steps to generate whenever
+   * the buffer runs dry. Must not be 0.
+   */
+  /* }}} */
+  explicit arrival_generator(
+      std::size_t lookahead_steps = conf::arrival_lookahead_steps) noexcept
+      : m_lookahead {lookahead_steps}
+  {}
+
+  /* {{{ doc */
+  /**
+   * @brief Generate arrivals for `steps` more time steps, appending them
+   * to the buffer.
+   */
+  /* }}} */
+  void generate(std::size_t steps) noexcept;
+
+  /* {{{ doc */
+  /**
+   * @brief Take arrivals for the next time step.
+   */
+  /* }}} */
+  auto next_step() noexcept -> arrivals;
+
+  /* {{{ doc */
+  /**
+   * @brief Number of time steps whose arrivals have been generated but
+   * not yet handed out.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto buffered_steps() const noexcept -> std::size_t
+  {
+    return m_step_counts.size() - m_next_step;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Number of arrivals in each time step generated but not yet
+   * handed out, in order.
+   */
+  /* }}} */
+  [[nodiscard]] auto pending_step_counts() const
+      -> std::vector<std::size_t>;
+
+  /* {{{ doc */
+  /**
+   * @brief Ship generated but not yet handed out, by index in order of
+   * arrival, which must be below the sum of `pending_step_counts()`.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto pending_ship(const std::size_t index) const
+      noexcept -> const ship&
+  {
+    return m_ships[m_next_ship + index];
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Replaces the buffered arrivals with those of another
+   * generator, as `pending_step_counts()` and `pending_ship()` gave them,
+   * and numbers ships generated from then on from `next_id`.
+   */
+  /* }}} */
+  void restore(std::vector<std::size_t>&& step_counts,
+               std::vector<ship>&& ships, ship::id_type next_id) noexcept;
+
+  /* {{{ doc */
+  /**
+   * @brief Bytes the generator has allocated, beyond its own size,
+   * including what the ships not yet handed out have allocated.
+   */
+  /* }}} */
+  [[nodiscard]] auto memory_footprint() const noexcept -> std::size_t;
+
+  /* {{{ doc */
+  /**
+   * @brief Allocator the generated ships take their IDs from.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto ids() noexcept -> ship_id_allocator&
+  {
+    return m_ids;
+  }
+};
+
+#endif
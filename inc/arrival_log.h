@@ -0,0 +1,282 @@
+#ifndef ARRIVAL_LOG_H
+#define ARRIVAL_LOG_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <future>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "arrival_generator.h"
+#include "utils/memory.hpp"
+
+#include "constants.h"
+#include "part_set.h"
+#include "ship.h"
+#include "ship_id_allocator.h"
+
+/* {{{ doc */
+/**
+ * @brief Binary recording of every ship arrival of a run, so that the
+ * exact same arrivals can be replayed into another run.
+ *
+ * An arrival log is a short header followed by one record per hour
+ * with arrivals, in increasing hour order. A record is the number of
+ * hours since the previous record, the number of ships, and then for
+ * each ship its faction, its number of damaged parts, and each part's
+ * ID and damage, all as LEB128 varints. The log ends with a record of
+ * no ships for the last hour recorded, so that replay knows how long
+ * the run was.
+ */
+/* }}} */
+namespace arrival_log {
+
+/* {{{ doc */
+/**
+ * @brief Bytes which begin every arrival log.
+ */
+/* }}} */
+constexpr inline std::array<char, 8> magic {'Z', 'E', 'B', 'R',
+                                            'A', 'A', 'R', 'R'};
+
+/* {{{ doc */
+/**
+ * @brief Records arrivals into an arrival log as a run goes.
+ */
+/* }}} */
+class writer
+{
+private:
+
+  std::FILE* m_file {nullptr};
+  std::uint64_t m_last_record_hour {0};
+  std::uint64_t m_last_hour {0};
+  std::vector<char> m_encoded {};
+
+  auto write_record(std::uint64_t hour,
+                    std::vector<ship>::const_iterator first,
+                    std::vector<ship>::const_iterator last) noexcept
+      -> bool;
+
+public:
+
+  /* {{{ doc */
+  /**
+   * @brief Creates or truncates the arrival log at `path`. Check
+   * `is_open()` for success.
+   */
+  /* }}} */
+  explicit writer(const std::string& path);
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be copied
+   */
+  /* }}} */
+  writer(const writer&) = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be copied
+   */
+  /* }}} */
+  auto operator=(const writer&) -> writer& = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be moved
+   */
+  /* }}} */
+  writer(writer&&) = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be moved
+   */
+  /* }}} */
+  auto operator=(writer&&) -> writer& = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Closes the log, if still open.
+   */
+  /* }}} */
+  ~writer() noexcept;
+
+  /* {{{ doc */
+  /**
+   * @brief Records the arrivals of one hour. Hours must be recorded in
+   * increasing order, starting from 1.
+   *
+   * @param hour Hour the ships arrive in, as counted by
+   * `space_station::step_count()` after that step.
+   *
+   * @param ships Ships arriving.
+   *
+   * @return False if the log is not open, or could not be written.
+   */
+  /* }}} */
+  auto record(std::uint64_t hour,
+              const arrival_generator::arrivals& ships) noexcept -> bool;
+
+  /* {{{ doc */
+  /**
+   * @brief Ends the log with the last hour recorded, and closes it.
+   *
+   * @return False if the log was not open, or could not be written.
+   */
+  /* }}} */
+  auto close() noexcept -> bool;
+
+  [[nodiscard]] inline auto is_open() const noexcept -> bool
+  {
+    return m_file != nullptr;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Bytes the writer has allocated, beyond its own size.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto memory_footprint() const noexcept
+      -> std::size_t
+  {
+    return ehanc::heap_bytes(m_encoded);
+  }
+};
+
+/* {{{ doc */
+/**
+ * @brief Replays the arrivals of an arrival log, hour by hour.
+ *
+ * The log is streamed from disk in chunks. While one chunk is being
+ * decoded, the next is read on another thread, so replay never holds
+ * more than two chunks of the log, and rarely waits on the disk.
+ */
+/* }}} */
+class reader
+{
+private:
+
+  std::FILE* m_file {nullptr};
+  std::size_t m_chunk_size;
+
+  // Bytes read but not yet decoded, starting at m_data_pos
+  std::vector<char> m_data {};
+  std::size_t m_data_pos {0};
+  std::future<std::vector<char>> m_next_chunk {};
+  bool m_file_done {false};
+
+  // Next record, decoded but not yet replayed
+  std::uint64_t m_record_hour {0};
+  bool m_have_record {false};
+  bool m_failed {false};
+  std::vector<ship::faction> m_factions {};
+  std::vector<part_set> m_part_sets {};
+
+  // Ships handed out by the most recent call to arrivals_for(), numbered
+  // the same way the recorded run's arrival_generator numbered them
+  std::vector<ship> m_ships {};
+  ship_id_allocator m_ids {};
+
+  void start_read();
+  auto refill() -> bool;
+  auto decode_record() -> bool;
+
+public:
+
+  /* {{{ doc */
+  /**
+   * @brief Opens the arrival log at `path`, and starts reading it. Check
+   * `is_open()` for success.
+   *
+   * @param path Path of arrival log to replay.
+   *
+   * @param chunk_size Number of bytes read from disk at a time.
+   */
+  /* }}} */
+  explicit reader(const std::string& path,
+                  std::size_t chunk_size = conf::arrival_log_chunk_size);
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be copied
+   */
+  /* }}} */
+  reader(const reader&) = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be copied
+   */
+  /* }}} */
+  auto operator=(const reader&) -> reader& = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be moved
+   */
+  /* }}} */
+  reader(reader&&) = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be moved
+   */
+  /* }}} */
+  auto operator=(reader&&) -> reader& = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Waits for any read in progress, and closes the log.
+   */
+  /* }}} */
+  ~reader() noexcept;
+
+  /* {{{ doc */
+  /**
+   * @brief Determine if the log was opened, and is an arrival log.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto is_open() const noexcept -> bool
+  {
+    return m_file != nullptr;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Bytes the reader has allocated, beyond its own size.
+   */
+  /* }}} */
+  [[nodiscard]] auto memory_footprint() const noexcept -> std::size_t;
+
+  /* {{{ doc */
+  /**
+   * @brief Determine if part of the log could not be read or decoded.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto failed() const noexcept -> bool
+  {
+    return m_failed;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Builds the ships which arrived in `hour`. Hours must be asked
+   * for in increasing order.
+   *
+   * @return The ships, which may be moved out of the range and are valid
+   * until the next call, or nothing if the log ended before `hour`, or
+   * could not be read.
+   */
+  /* }}} */
+  auto arrivals_for(std::uint64_t hour)
+      -> std::optional<arrival_generator::arrivals>;
+};
+
+} // namespace arrival_log
+
+#endif
@@ -0,0 +1,184 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "utils/memory.hpp"
+
+#include "constants.h"
+#include "space_station.h"
+
+/* {{{ doc */
+/**
+ * @brief Checkpoints of a running station, from which a run can be
+ * resumed exactly where it was.
+ *
+ * A checkpoint file is a short header followed by records. The first
+ * record is a full snapshot of the station, its base: its counters, the
+ * random engine, the arrivals generated but not yet handed out, every
+ * bay, and every waiting ship. Each record after it is incremental, and
+ * only holds what changed since the record before it: the counters,
+ * random engine and pending arrivals, which are small, the bays which
+ * docked a ship, the ships which left the queue, and the ships which
+ * joined it and still wait. So an incremental checkpoint costs as much
+ * as the work done since the last one, however deep the queue is.
+ *
+ * A bay is only recorded when it docks a ship, with the hour it docked
+ * in. Restoring redocks the ship and repairs it for as many hours as
+ * have passed since, which leaves the bay as it was.
+ *
+ * Every record is its kind, the length of its payload, the payload, and
+ * a checksum of the payload. Numbers in the payload are LEB128 varints.
+ * Records are appended and flushed as they are written, so if a run is
+ * interrupted mid-write, the cut off record fails its checksum, and the
+ * checkpoint restores to the record before it. Full snapshots are
+ * written to a new file which then replaces the old one, so the file
+ * never holds more than one base.
+ */
+/* }}} */
+namespace checkpoint {
+
+/* {{{ doc */
+/**
+ * @brief Bytes which begin every checkpoint file.
+ */
+/* }}} */
+constexpr inline std::array<char, 8> magic {'Z', 'E', 'B', 'R',
+                                            'A', 'C', 'K', 'P'};
+
+/* {{{ doc */
+/**
+ * @brief Writes checkpoints of a station as it runs.
+ */
+/* }}} */
+class writer
+{
+private:
+
+  std::string m_path;
+  std::size_t m_deltas_per_base;
+  std::FILE* m_file {nullptr};
+
+  // Incremental checkpoints written since the base, if there is one
+  std::optional<std::size_t> m_deltas {};
+
+  std::vector<char> m_payload {};
+  std::vector<char> m_record {};
+
+  auto write_base(space_station& station) noexcept -> bool;
+  auto write_delta(space_station& station) noexcept -> bool;
+  auto append_record(std::FILE* file) noexcept -> bool;
+
+public:
+
+  /* {{{ doc */
+  /**
+   * @brief Writes checkpoints to `path`, which is created or replaced by
+   * the first `save()`.
+   *
+   * @param deltas_per_base Number of incremental checkpoints written
+   * after each full one.
+   */
+  /* }}} */
+  explicit writer(
+      std::string path,
+      std::size_t deltas_per_base = conf::checkpoint_deltas_per_base);
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be copied
+   */
+  /* }}} */
+  writer(const writer&) = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be copied
+   */
+  /* }}} */
+  auto operator=(const writer&) -> writer& = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be moved
+   */
+  /* }}} */
+  writer(writer&&) = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be moved
+   */
+  /* }}} */
+  auto operator=(writer&&) -> writer& = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Closes the file, if open.
+   */
+  /* }}} */
+  ~writer() noexcept;
+
+  /* {{{ doc */
+  /**
+   * @brief Checkpoints `station`, along with the calling thread's random
+   * engine, which its arrivals are drawn from.
+   *
+   * The first checkpoint, every `deltas_per_base + 1`th after it, and
+   * the first after a failed one are full, and turn on tracking changes
+   * in the station. The rest only hold the changes since the checkpoint
+   * before, which they clear. Nothing else may clear the station's
+   * changes in between.
+   *
+   * @return False if the checkpoint could not be written.
+   */
+  /* }}} */
+  auto save(space_station& station) noexcept -> bool;
+
+  /* {{{ doc */
+  /**
+   * @brief Closes the file.
+   *
+   * @return False if the file was not open, or could not be closed.
+   */
+  /* }}} */
+  auto close() noexcept -> bool;
+
+  /* {{{ doc */
+  /**
+   * @brief Bytes the writer has allocated, beyond its own size.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto memory_footprint() const noexcept
+      -> std::size_t
+  {
+    return ehanc::heap_bytes(m_payload) + ehanc::heap_bytes(m_record);
+  }
+};
+
+/* {{{ doc */
+/**
+ * @brief Restores the station checkpointed to `path` into `station`,
+ * which must be newly constructed, with the same bays and policy as the
+ * station checkpointed, and restores the calling thread's random engine.
+ * Predicted dock hours are only restored if `station` checks
+ * predictions.
+ *
+ * @return The hour restored, as counted by
+ * `space_station::step_count()`, or nothing if the file could not be
+ * read, is not a checkpoint, or was written for a different station, in
+ * which case `station` is left as it was.
+ */
+/* }}} */
+auto restore(const std::string& path, space_station& station)
+    -> std::optional<std::uint64_t>;
+
+} // namespace checkpoint
+
+#endif
@@ -0,0 +1,170 @@
+#ifndef COMPRESSED_FILE_BUF_H
+#define COMPRESSED_FILE_BUF_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <ios>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "constants.h"
+#include "log_buf.h"
+
+/* {{{ doc */
+/**
+ * @brief Output stream buffer which writes an LZ4 compressed file.
+ *
+ * Written text is collected into large blocks, and each full block is
+ * handed to a background thread, which compresses it and writes it to
+ * the file. The writing thread only waits on the compressing thread if
+ * `queue_depth` blocks are already waiting to be compressed. The file
+ * can be read back with `lz4::decompress_frames()`, or `lz4 -d`.
+ */
+/* }}} */
+class compressed_file_buf : public log_buf
+{
+private:
+
+  std::FILE* m_file {nullptr};
+  std::size_t m_block_size;
+  std::size_t m_queue_depth;
+
+  // Block being written, used as the put area
+  std::vector<char> m_block {};
+  // Number of bytes in blocks already handed off
+  std::uint64_t m_handed_off {0};
+
+  // Bytes the compressing thread has allocated for its own use
+  std::atomic<std::size_t> m_compressor_bytes {0};
+
+  // Everything below is shared with the compressing thread
+  mutable std::mutex m_mutex {};
+  std::condition_variable m_work_ready {};
+  std::condition_variable m_space_ready {};
+  std::deque<std::vector<char>> m_pending {};
+  std::vector<std::vector<char>> m_spare {};
+  // Every block written to the file, and the bytes they hold
+  std::vector<block_position> m_written_blocks {};
+  std::uint64_t m_written_bytes {0};
+  bool m_finishing {false};
+  bool m_failed {false};
+
+  std::thread m_compressor {};
+
+  auto hand_off() -> bool;
+  void compress_pending() noexcept;
+
+protected:
+
+  auto overflow(int_type ch) -> int_type override;
+
+  auto sync() -> int override;
+
+  auto seekoff(off_type off, std::ios_base::seekdir dir,
+               std::ios_base::openmode which) -> pos_type override;
+
+public:
+
+  /* {{{ doc */
+  /**
+   * @brief Creates or truncates the file at `path`, and starts the
+   * compressing thread. Check `is_open()` for success.
+   *
+   * @param path Path of file to write.
+   *
+   * @param block_size Number of bytes compressed at a time, at most
+   * `lz4::max_block_size`.
+   *
+   * @param queue_depth Number of full blocks which may wait to be
+   * compressed before writing blocks.
+   */
+  /* }}} */
+  explicit compressed_file_buf(
+      const std::string& path,
+      std::size_t block_size  = conf::log_compression_block_size,
+      std::size_t queue_depth = conf::log_compression_queue_depth);
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be copied
+   */
+  /* }}} */
+  compressed_file_buf(const compressed_file_buf&) = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be copied
+   */
+  /* }}} */
+  auto operator=(const compressed_file_buf&)
+      -> compressed_file_buf& = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be moved
+   */
+  /* }}} */
+  compressed_file_buf(compressed_file_buf&&) = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be moved
+   */
+  /* }}} */
+  auto operator=(compressed_file_buf&&)
+      -> compressed_file_buf& = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Closes the file, if still open.
+   */
+  /* }}} */
+  ~compressed_file_buf() noexcept override;
+
+  /* {{{ doc */
+  /**
+   * @brief Compresses everything written so far, ends the compressed
+   * frame, and closes the file.
+   *
+   * @return False if the file was not open, or could not be written.
+   */
+  /* }}} */
+  auto close() noexcept -> bool override;
+
+  [[nodiscard]] inline auto is_open() const noexcept -> bool override
+  {
+    return m_file != nullptr;
+  }
+
+  [[nodiscard]] auto memory_footprint() const noexcept
+      -> std::size_t override;
+
+  /* {{{ doc */
+  /**
+   * @brief Finds the compressed block holding the byte written at
+   * `offset`, once the compressing thread has written it.
+   */
+  /* }}} */
+  [[nodiscard]] auto block_at(std::uint64_t offset) const
+      -> std::optional<block_position> override;
+
+  /* {{{ doc */
+  /**
+   * @brief Number of uncompressed bytes written so far.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto size() const noexcept -> std::uint64_t
+  {
+    return m_handed_off
+           + static_cast<std::uint64_t>(this->pptr() - this->pbase());
+  }
+};
+
+#endif
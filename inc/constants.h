@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <random>
 #include <string_view>
 
@@ -27,6 +28,91 @@ constexpr inline int default_time_steps {10'000};
  */
 constexpr inline std::string_view default_log_file {"zebra_diary.txt"};
 
+/**
+ * @brief Number of bytes the log file is grown and memory-mapped by at a
+ * time while writing.
+ *
+ * @note Submitting: `64 MiB`
+ */
+constexpr inline std::size_t log_map_extent {std::size_t {64} << 20U};
+
+/**
+ * @brief Default path of the log file when it is compressed.
+ * Can be overwritten by the command-line option `--logfile`.
+ *
+ * @note Submitting: `"zebra_diary.txt.lz4"`
+ */
+constexpr inline std::string_view default_compressed_log_file {
+    "zebra_diary.txt.lz4"};
+
+/**
+ * @brief Number of bytes of the log file compressed at a time, when
+ * compressing it. At most 4 MiB.
+ *
+ * @note Submitting: `4 MiB`
+ */
+constexpr inline std::size_t log_compression_block_size {std::size_t {4}
+                                                         << 20U};
+
+/**
+ * @brief Number of blocks of the log file which may wait to be
+ * compressed before the simulation waits for compression to catch up.
+ *
+ * @note Submitting: `4`
+ */
+constexpr inline std::size_t log_compression_queue_depth {4};
+
+/**
+ * @brief Number of steps indexed between writes of the log index, and so
+ * the most steps whose index records can be lost if a run is
+ * interrupted.
+ *
+ * @note Submitting: `64`
+ */
+constexpr inline std::size_t log_index_flush_interval {64};
+
+/**
+ * @brief Number of steps collected before they are encoded and written
+ * to the metrics file.
+ *
+ * @note Submitting: `65536`
+ */
+constexpr inline std::size_t metrics_block_rows {65536};
+
+/**
+ * @brief Number of bytes of an arrival log read from disk at a time when
+ * replaying it.
+ *
+ * @note Submitting: `1 MiB`
+ */
+constexpr inline std::size_t arrival_log_chunk_size {std::size_t {1}
+                                                     << 20U};
+
+/**
+ * @brief Number of time steps between checkpoints, when checkpointing.
+ * Can be overwritten by the command-line option `--checkpoint-every`.
+ *
+ * @note Submitting: `100`
+ */
+constexpr inline std::size_t checkpoint_interval {100};
+
+/**
+ * @brief Number of incremental checkpoints written after each full one,
+ * before the next full one. Restoring replays at most this many.
+ *
+ * @note Submitting: `16`
+ */
+constexpr inline std::size_t checkpoint_deltas_per_base {16};
+
+/**
+ * @brief Number of time steps of arrivals generated at once when several
+ * stations run in lockstep. Each station then runs the whole batch
+ * without waiting on the others.
+ *
+ * @note Submitting: `256`
+ */
+constexpr inline std::size_t lockstep_batch_steps {256};
+
 /**
  * @brief Determines if output will sent to stdout by default.
  * `true` will make available the command-line option `--quiet`
@@ -57,6 +143,41 @@ constexpr inline bool write_to_logfile_by_default {true};
  */
 constexpr inline int num_repair_bays {3};
 
+/**
+ * @brief Stations with at least this many repair bays step their bays
+ * in parallel, in shards of `bay_shard_size` bays.
+ *
+ * @note Submitting: `65'536`
+ */
+constexpr inline std::size_t parallel_bay_threshold {65'536};
+
+/**
+ * @brief Number of repair bays stepped together by one thread, when
+ * stepping bays in parallel.
+ *
+ * @note Submitting: `8'192`
+ */
+constexpr inline std::size_t bay_shard_size {8'192};
+
+/**
+ * @brief Priority of each faction under the faction priority queue
+ * policy, in the order human, ferengi, klingon, romulan, other. Ships of
+ * lower priority values dock first, and ships of equal priority dock in
+ * order of arrival.
+ *
+ * @note Submitting: `{1, 2, 0, 0, 3}`
+ */
+constexpr inline std::array<int, 5> faction_priority {1, 2, 0, 0, 3};
+
+/**
+ * @brief Under the aging queue policy, ships dock shortest repair first,
+ * but every hour spent waiting counts as this many hours less of repair,
+ * so that long repairs are not put off forever.
+ *
+ * @note Submitting: `1`
+ */
+constexpr inline int queue_aging_rate {1};
+
 /**
  * @brief Maximum number of ships in the repair queue before
  * program exits.
@@ -66,6 +187,35 @@ constexpr inline int num_repair_bays {3};
  */
 constexpr inline std::size_t cutoff_queue_size {5'000'000};
 
+/**
+ * @brief Number of time steps between checks of the memory footprint
+ * against `--max-memory`. Summing the footprint visits every bay, so it
+ * is not done every step; a run may overshoot its budget by at most
+ * this many steps worth of growth.
+ *
+ * @note Submitting: `64`
+ */
+constexpr inline std::uint64_t memory_check_interval {64};
+
+/**
+ * @brief Number of bytes of damaged part lists each page of a ship store
+ * holds. Waiting ships keep their part lists in these pages, and a page
+ * is only reused once every ship with parts in it has left.
+ *
+ * @note Submitting: `64 KiB`
+ */
+constexpr inline std::size_t ship_store_page_size {std::size_t {64}
+                                                   << 10U};
+
+/**
+ * @brief Number of time steps worth of ship arrivals to generate at
+ * once. Arrivals are generated in bulk, and handed out to the space
+ * station one time step at a time.
+ *
+ * @note Submitting: `64`
+ */
+constexpr inline std::size_t arrival_lookahead_steps {64};
+
 /**
  * @brief Separator to be used for the header of each hour's log.
  *
@@ -274,6 +424,14 @@ constexpr auto severity_to_time(int severity) noexcept -> int
   return std::max(severity / 5, 1);
 }
 
+/**
+ * @brief Exclusive upper bound on part IDs. Every ID in every part list
+ * below must be in the range [0, part_id_limit).
+ *
+ * @note Submitting: `1000`
+ */
+constexpr inline int part_id_limit {1000};
+
 /**
  * @brief List of valid part IDs for parts in a human ship.
  */
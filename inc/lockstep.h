@@ -0,0 +1,187 @@
+#ifndef LOCKSTEP_H
+#define LOCKSTEP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "utils/thread_pool.hpp"
+
+#include "arrival_generator.h"
+#include "constants.h"
+#include "repair_bay.h"
+#include "ship.h"
+#include "ship_queue.h"
+#include "space_station.h"
+
+/* {{{ doc */
+/**
+ * @brief Runs several differently configured stations side by side on
+ * one shared stream of arrivals.
+ *
+ * Arrivals are generated once per time step, and every station gets an
+ * identical copy of them, so the stations are compared on exactly the
+ * same traffic, and the cost of generating it is paid once. Arrivals are
+ * generated a batch of steps at a time, after which the stations run
+ * through the batch in parallel.
+ */
+/* }}} */
+class lockstep
+{
+public:
+
+  /* {{{ doc */
+  /**
+   * @brief How one of the stations is set up.
+   */
+  /* }}} */
+  struct config {
+    std::vector<bay_spec> bays;
+    ship_queue::policy order {ship_queue::policy::fifo};
+  };
+
+  /* {{{ doc */
+  /**
+   * @brief Running totals for one station, over every step so far.
+   */
+  /* }}} */
+  struct totals {
+    std::uint64_t arrived {0};
+    std::uint64_t repaired {0};
+    // Sum over every step of the queue size, and of the occupied bays
+    std::uint64_t queue_hours {0};
+    std::uint64_t occupied_bay_hours {0};
+    std::size_t max_queue_size {0};
+  };
+
+private:
+
+  std::vector<config> m_configs;
+  std::vector<std::unique_ptr<space_station>> m_stations {};
+  std::vector<totals> m_totals {};
+
+  // Each station's copy of the arrivals of the step it is on
+  std::vector<std::vector<ship>> m_staging {};
+
+  // Arrivals of the current batch, and how many arrive in each step
+  arrival_generator m_arrivals {};
+  std::vector<ship> m_batch {};
+  std::vector<std::size_t> m_batch_counts {};
+  std::size_t m_batch_steps;
+
+  ehanc::thread_pool m_pool;
+
+  void generate_batch(std::size_t steps);
+  void run_batch(space_station& station, totals& sums,
+                 std::vector<ship>& staging) const noexcept;
+
+public:
+
+  /* {{{ doc */
+  /**
+   * @brief Builds one station for each configuration.
+   *
+   * @param configs Configurations, in the order they are reported in.
+   *
+   * @param batch_steps Number of steps of arrivals generated at a time.
+   *
+   * @param threads Number of threads the stations are spread across.
+   * Zero picks one per hardware thread, but never more than the number
+   * of stations.
+   */
+  /* }}} */
+  explicit lockstep(std::vector<config> configs,
+                    std::size_t batch_steps = conf::lockstep_batch_steps,
+                    std::size_t threads = 0);
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be copied
+   */
+  /* }}} */
+  lockstep(const lockstep&) = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be copied
+   */
+  /* }}} */
+  auto operator=(const lockstep&) -> lockstep& = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be moved
+   */
+  /* }}} */
+  lockstep(lockstep&&) = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be moved
+   */
+  /* }}} */
+  auto operator=(lockstep&&) -> lockstep& = delete;
+
+  ~lockstep() = default;
+
+  /* {{{ doc */
+  /**
+   * @brief Advances every station by `steps` time steps.
+   */
+  /* }}} */
+  void run(std::size_t steps);
+
+  /* {{{ doc */
+  /**
+   * @brief Number of stations.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto size() const noexcept -> std::size_t
+  {
+    return m_stations.size();
+  }
+
+  [[nodiscard]] inline auto station(const std::size_t index) const
+      noexcept -> const space_station&
+  {
+    return *m_stations[index];
+  }
+
+  [[nodiscard]] inline auto get_config(const std::size_t index) const
+      noexcept -> const config&
+  {
+    return m_configs[index];
+  }
+
+  [[nodiscard]] inline auto get_totals(const std::size_t index) const
+      noexcept -> const totals&
+  {
+    return m_totals[index];
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Largest queue of any station right now.
+   */
+  /* }}} */
+  [[nodiscard]] auto largest_queue_size() const noexcept -> std::size_t;
+
+  /* {{{ doc */
+  /**
+   * @brief Bytes allocated by every station, and for the arrivals they
+   * share.
+   */
+  /* }}} */
+  [[nodiscard]] auto memory_footprint() const noexcept -> std::size_t;
+
+  /* {{{ doc */
+  /**
+   * @brief Prints a table comparing every station's totals.
+   */
+  /* }}} */
+  void display_summary(std::ostream& out) const;
+};
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef LOG_BUF_H
+#define LOG_BUF_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <streambuf>
+
+/* {{{ doc */
+/**
+ * @brief Interface of output stream buffers which back the log file.
+ * Reports are written through a `std::ostream` on top of one of these;
+ * `tellp()` on that stream reports the number of (uncompressed) bytes
+ * written so far.
+ */
+/* }}} */
+class log_buf : public std::streambuf
+{
+public:
+
+  /* {{{ doc */
+  /**
+   * @brief Where a block of the log file, which can be read on its own,
+   * begins: its offset in the file, and the number of (uncompressed)
+   * bytes written before it.
+   */
+  /* }}} */
+  struct block_position
+  {
+    std::uint64_t file_offset;
+    std::uint64_t start;
+  };
+
+  log_buf() = default;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be copied
+   */
+  /* }}} */
+  log_buf(const log_buf&) = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be copied
+   */
+  /* }}} */
+  auto operator=(const log_buf&) -> log_buf& = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be moved
+   */
+  /* }}} */
+  log_buf(log_buf&&) = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be moved
+   */
+  /* }}} */
+  auto operator=(log_buf&&) -> log_buf& = delete;
+
+  ~log_buf() noexcept override = default;
+
+  /* {{{ doc */
+  /**
+   * @brief Determine if the log file was opened successfully, and has
+   * not been closed.
+   */
+  /* }}} */
+  [[nodiscard]] virtual auto is_open() const noexcept -> bool = 0;
+
+  /* {{{ doc */
+  /**
+   * @brief Finish writing everything, and close the log file.
+   *
+   * @return False if the file was not open, or could not be finished.
+   */
+  /* }}} */
+  virtual auto close() noexcept -> bool = 0;
+
+  /* {{{ doc */
+  /**
+   * @brief Bytes the buffer has allocated, beyond its own size.
+   */
+  /* }}} */
+  [[nodiscard]] virtual auto memory_footprint() const noexcept
+      -> std::size_t = 0;
+
+  /* {{{ doc */
+  /**
+   * @brief Finds the block holding the byte written at (uncompressed)
+   * `offset`, from which the log can be read without reading everything
+   * before it.
+   *
+   * @return The block, or nothing if it has not reached the file yet.
+   */
+  /* }}} */
+  [[nodiscard]] virtual auto block_at(std::uint64_t offset) const
+      -> std::optional<block_position> = 0;
+};
+
+#endif
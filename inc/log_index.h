@@ -0,0 +1,281 @@
+#ifndef LOG_INDEX_H
+#define LOG_INDEX_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "utils/memory.hpp"
+
+#include "constants.h"
+#include "log_buf.h"
+
+/* {{{ doc */
+/**
+ * @brief Sidecar index of a log file, which maps step numbers to the
+ * byte offsets of their reports.
+ *
+ * An index file is a short header followed by fixed size records of four
+ * little-endian 64 bit integers: a step number, the offset of that
+ * step's report in the (uncompressed) log, and where the block of the
+ * log file holding the start of the report begins, both in the file and
+ * in the uncompressed log. For a compressed log, that is the LZ4 block
+ * to start decompressing at. For a plain log, every byte is its own
+ * block. Records are in increasing step order, so a reader can binary
+ * search the file without loading it. A partial record at the end of
+ * the file, as left by a crash, is ignored.
+ */
+/* }}} */
+namespace log_index {
+
+/* {{{ doc */
+/**
+ * @brief Bytes which begin every index file.
+ */
+/* }}} */
+constexpr inline std::array<char, 8> magic {'Z', 'E', 'B', 'R',
+                                            'A', 'I', 'X', '2'};
+
+/* {{{ doc */
+/**
+ * @brief Size in bytes of one record.
+ */
+/* }}} */
+constexpr inline std::size_t record_size {32};
+
+/* {{{ doc */
+/**
+ * @brief Path of the index of the log file at `log_path`.
+ */
+/* }}} */
+auto index_path(const std::string& log_path) -> std::string;
+
+/* {{{ doc */
+/**
+ * @brief Where the report of one step begins.
+ */
+/* }}} */
+struct entry
+{
+  std::uint64_t step;
+  std::uint64_t offset;
+  log_buf::block_position block;
+};
+
+/* {{{ doc */
+/**
+ * @brief Appends records to an index file as a log is written.
+ *
+ * Records are buffered, and written to the file every
+ * `flush_interval` records, so an interrupted run loses at most that
+ * many of the most recent records, and the rest of the index stays
+ * usable. A record whose block has not reached the log file yet waits
+ * in the buffer until it has.
+ */
+/* }}} */
+class writer
+{
+private:
+
+  std::FILE* m_file {nullptr};
+  std::size_t m_flush_interval;
+  const log_buf* m_log;
+  std::vector<char> m_pending {};
+
+  // Records whose block has not reached the log file yet, in order
+  std::vector<entry> m_unplaced {};
+
+  void place_records();
+
+public:
+
+  /* {{{ doc */
+  /**
+   * @brief Creates or truncates the index file at `path`. Check
+   * `is_open()` for success.
+   *
+   * @param path Path of index file to write.
+   *
+   * @param flush_interval Number of records to buffer before writing them
+   * to the file.
+   *
+   * @param log Log being indexed, which is asked where its blocks are.
+   * Without one, the log is taken to be plain text.
+   */
+  /* }}} */
+  explicit writer(
+      const std::string& path,
+      std::size_t flush_interval = conf::log_index_flush_interval,
+      const log_buf* log         = nullptr);
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be copied
+   */
+  /* }}} */
+  writer(const writer&) = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be copied
+   */
+  /* }}} */
+  auto operator=(const writer&) -> writer& = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be moved
+   */
+  /* }}} */
+  writer(writer&&) = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be moved
+   */
+  /* }}} */
+  auto operator=(writer&&) -> writer& = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Closes the file, if still open.
+   */
+  /* }}} */
+  ~writer() noexcept;
+
+  /* {{{ doc */
+  /**
+   * @brief Records that the report of `step` begins at `offset`.
+   * Steps must be added in increasing order.
+   *
+   * @return False if the file is not open, or could not be written.
+   */
+  /* }}} */
+  auto add(std::uint64_t step, std::uint64_t offset) -> bool;
+
+  /* {{{ doc */
+  /**
+   * @brief Writes all buffered records to the file.
+   *
+   * @return False if the file is not open, or could not be written.
+   */
+  /* }}} */
+  auto flush() noexcept -> bool;
+
+  /* {{{ doc */
+  /**
+   * @brief Writes all buffered records, and closes the file. Close the
+   * log first, so that every block has reached it; records whose block
+   * never did are dropped.
+   *
+   * @return False if the file was not open, or could not be written.
+   */
+  /* }}} */
+  auto close() noexcept -> bool;
+
+  [[nodiscard]] inline auto is_open() const noexcept -> bool
+  {
+    return m_file != nullptr;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Bytes the writer has allocated, beyond its own size.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto memory_footprint() const noexcept
+      -> std::size_t
+  {
+    return ehanc::heap_bytes(m_pending) + ehanc::heap_bytes(m_unplaced);
+  }
+};
+
+/* {{{ doc */
+/**
+ * @brief Looks up records in an index file, reading only the records
+ * visited by a binary search.
+ */
+/* }}} */
+class reader
+{
+private:
+
+  mutable std::ifstream m_file;
+  std::uint64_t m_size {0};
+
+  [[nodiscard]] auto read(std::uint64_t index) const -> entry;
+
+public:
+
+  /* {{{ doc */
+  /**
+   * @brief Opens the index file at `path`. Check `is_open()` for
+   * success.
+   */
+  /* }}} */
+  explicit reader(const std::string& path);
+
+  /* {{{ doc */
+  /**
+   * @brief Determine if the file was opened, and is an index file.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto is_open() const noexcept -> bool
+  {
+    return m_file.is_open();
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Number of complete records in the file.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto size() const noexcept -> std::uint64_t
+  {
+    return m_size;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Finds the first record of a step at or after `step`.
+   *
+   * @return The record, or nothing if every step indexed is before
+   * `step`.
+   */
+  /* }}} */
+  [[nodiscard]] auto find(std::uint64_t step) const
+      -> std::optional<entry>;
+};
+
+/* {{{ doc */
+/**
+ * @brief Copies the reports of steps `first` through `last` of a log
+ * file to `out`, seeking straight to them through the log's index.
+ * Logs written with `--compress-log` are recognized, and decompressed
+ * from the block holding the start of the range.
+ *
+ * @param log_path Path of the log file, whose index is at
+ * `index_path(log_path)`.
+ *
+ * @param first First step to copy.
+ *
+ * @param last Last step to copy, inclusive.
+ *
+ * @param out Stream to copy the reports to.
+ *
+ * @return False if the log or its index could not be read, or no step
+ * in the range was indexed.
+ */
+/* }}} */
+auto copy_steps(const std::string& log_path, std::uint64_t first,
+                std::uint64_t last, std::ostream& out) -> bool;
+
+} // namespace log_index
+
+#endif
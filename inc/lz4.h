@@ -0,0 +1,171 @@
+#ifndef LZ4_H
+#define LZ4_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+#include "utils/memory.hpp"
+
+/* {{{ doc */
+/**
+ * @brief Self-contained implementation of the LZ4 block and frame
+ * formats, enough to write compressed log files which the stock `lz4`
+ * tool can decompress, and to read them back.
+ *
+ * Frames are written with independent blocks of up to `max_block_size`
+ * bytes, and without checksums other than the mandatory header checksum.
+ */
+/* }}} */
+namespace lz4 {
+
+/* {{{ doc */
+/**
+ * @brief Largest block which may be written to a frame; the 4 MiB block
+ * size of the format.
+ */
+/* }}} */
+constexpr inline std::size_t max_block_size {std::size_t {4} << 20U};
+
+/* {{{ doc */
+/**
+ * @brief Upper bound of the compressed size of `size` bytes, for sizing
+ * output buffers.
+ */
+/* }}} */
+constexpr auto compress_bound(const std::size_t size) noexcept
+    -> std::size_t
+{
+  return size + (size / 255) + 16;
+}
+
+/* {{{ doc */
+/**
+ * @brief Computes the XXH32 hash of `size` bytes at `data`, as used for
+ * the frame header checksum.
+ */
+/* }}} */
+auto xxh32(const char* data, std::size_t size,
+           std::uint32_t seed = 0) noexcept -> std::uint32_t;
+
+/* {{{ doc */
+/**
+ * @brief Greedy, single-pass block compressor. Holds the table of recent
+ * match positions, so one should be reused for many blocks.
+ */
+/* }}} */
+class block_compressor
+{
+private:
+
+  std::vector<std::uint32_t> m_table;
+
+public:
+
+  block_compressor();
+
+  /* {{{ doc */
+  /**
+   * @brief Compresses one block as raw LZ4 block data.
+   *
+   * @param src Data to compress, at most `max_block_size` bytes.
+   *
+   * @param size Number of bytes at `src`.
+   *
+   * @param dst Output, which must have room for `compress_bound(size)`
+   * bytes.
+   *
+   * @return Number of bytes written to `dst`.
+   */
+  /* }}} */
+  auto compress(const char* src, std::size_t size, char* dst) noexcept
+      -> std::size_t;
+
+  [[nodiscard]] inline auto memory_footprint() const noexcept
+      -> std::size_t
+  {
+    return ehanc::heap_bytes(m_table);
+  }
+};
+
+/* {{{ doc */
+/**
+ * @brief Decompresses raw LZ4 block data.
+ *
+ * @param src Compressed block.
+ *
+ * @param size Number of bytes at `src`.
+ *
+ * @param dst Output buffer.
+ *
+ * @param capacity Number of bytes available at `dst`.
+ *
+ * @return Number of bytes written to `dst`, or nothing if the block is
+ * malformed or does not fit.
+ */
+/* }}} */
+auto decompress_block(const char* src, std::size_t size, char* dst,
+                      std::size_t capacity) noexcept
+    -> std::optional<std::size_t>;
+
+/* {{{ doc */
+/**
+ * @brief Bytes which begin a frame of independent 4 MiB blocks.
+ */
+/* }}} */
+auto frame_header() noexcept -> std::array<char, 7>;
+
+/* {{{ doc */
+/**
+ * @brief Bytes which end a frame.
+ */
+/* }}} */
+constexpr inline std::array<char, 4> frame_end {0, 0, 0, 0};
+
+/* {{{ doc */
+/**
+ * @brief Compresses one block of a frame, and appends it to `out` with
+ * its block header. Data which does not compress is stored as-is.
+ *
+ * @param compressor Compressor to use.
+ *
+ * @param src Data of the block, at most `max_block_size` bytes.
+ *
+ * @param size Number of bytes at `src`.
+ *
+ * @param out Buffer to append the encoded block to.
+ */
+/* }}} */
+void encode_block(block_compressor& compressor, const char* src,
+                  std::size_t size, std::vector<char>& out);
+
+/* {{{ doc */
+/**
+ * @brief Decompresses the blocks read from `in` into `out`, starting at
+ * a block header of a frame begun with `frame_header()`, and stopping at
+ * the end of the frame. As the blocks are independent, this can start
+ * at any block.
+ *
+ * @return False if the input is not a well-formed run of blocks ending
+ * the frame, or `out` fails, at which point decompression stops.
+ */
+/* }}} */
+auto decompress_frame_blocks(std::istream& in, std::ostream& out) -> bool;
+
+/* {{{ doc */
+/**
+ * @brief Decompresses every frame read from `in` into `out`.
+ *
+ * @return False if the input is not a sequence of well-formed LZ4
+ * frames, or `out` fails, at which point decompression stops.
+ */
+/* }}} */
+auto decompress_frames(std::istream& in, std::ostream& out) -> bool;
+
+} // namespace lz4
+
+#endif
@@ -0,0 +1,145 @@
+#ifndef MAPPED_FILE_BUF_H
+#define MAPPED_FILE_BUF_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <optional>
+#include <string>
+
+#include "constants.h"
+#include "log_buf.h"
+
+/* {{{ doc */
+/**
+ * @brief Output stream buffer which writes straight into a memory-mapped
+ * file.
+ *
+ * The file is grown and mapped one large extent at a time, and the
+ * mapped extent is used directly as the put area, so anything written
+ * through a `std::ostream` on top of this buffer is rendered into the
+ * page cache with no intermediate copies and no write syscalls. The file
+ * is truncated to the number of bytes actually written when closed.
+ *
+ * Each extent's disk blocks are allocated before it is mapped, so a full
+ * disk fails the stream with `badbit`, instead of killing the process
+ * when a write reaches a page with nothing behind it.
+ */
+/* }}} */
+class mapped_file_buf : public log_buf
+{
+private:
+
+  int m_fd {-1};
+  std::size_t m_extent;
+
+  // File offset of the currently mapped extent
+  std::size_t m_window_offset {0};
+  char* m_window {nullptr};
+
+  auto map_window(std::size_t offset) noexcept -> bool;
+  void unmap_window() noexcept;
+
+protected:
+
+  auto overflow(int_type ch) -> int_type override;
+
+  auto seekoff(off_type off, std::ios_base::seekdir dir,
+               std::ios_base::openmode which) -> pos_type override;
+
+public:
+
+  /* {{{ doc */
+  /**
+   * @brief Creates or truncates the file at `path` and maps its first
+   * extent. Check `is_open()` for success.
+   *
+   * @param path Path of file to write.
+   *
+   * @param extent Number of bytes to allocate and map the file by at a
+   * time. Rounded up to a multiple of the page size.
+   */
+  /* }}} */
+  explicit mapped_file_buf(
+      const std::string& path,
+      std::size_t extent = conf::log_map_extent) noexcept;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be copied
+   */
+  /* }}} */
+  mapped_file_buf(const mapped_file_buf&) = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be copied
+   */
+  /* }}} */
+  auto operator=(const mapped_file_buf&) -> mapped_file_buf& = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be moved
+   */
+  /* }}} */
+  mapped_file_buf(mapped_file_buf&&) = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be moved
+   */
+  /* }}} */
+  auto operator=(mapped_file_buf&&) -> mapped_file_buf& = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Closes the file, if still open.
+   */
+  /* }}} */
+  ~mapped_file_buf() noexcept override;
+
+  /* {{{ doc */
+  /**
+   * @brief Unmaps the file, truncates it to the number of bytes written,
+   * and closes it.
+   *
+   * @return False if the file was not open, or could not be truncated.
+   */
+  /* }}} */
+  auto close() noexcept -> bool override;
+
+  [[nodiscard]] inline auto is_open() const noexcept -> bool override
+  {
+    return m_window != nullptr;
+  }
+
+  // The window is mapped from the file, so the kernel can write it back
+  // and drop it at any time, rather than allocated
+  [[nodiscard]] inline auto memory_footprint() const noexcept
+      -> std::size_t override
+  {
+    return 0;
+  }
+
+  // Every byte is written to the file as is, so each is a block of its
+  // own
+  [[nodiscard]] inline auto block_at(const std::uint64_t offset) const
+      -> std::optional<block_position> override
+  {
+    return block_position {offset, offset};
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Number of bytes written so far.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto size() const noexcept -> std::size_t
+  {
+    return m_window_offset
+           + static_cast<std::size_t>(this->pptr() - this->pbase());
+  }
+};
+
+#endif
@@ -0,0 +1,270 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "constants.h"
+#include "space_station.h"
+
+/* {{{ doc */
+/**
+ * @brief Compact columnar export of per-step numeric metrics.
+ *
+ * A metrics file is a short header naming its columns and giving the
+ * number of its first step, followed by blocks of up to
+ * `conf::metrics_block_rows` steps. Each block holds its
+ * row count, then each column in turn as its byte length and its values,
+ * each stored as the zigzag-encoded difference from the value before it
+ * (or from zero, for a block's first value) in a LEB128 varint. Blocks
+ * are only written whole, and a partial block at the end of a file, as
+ * left by a crash, is ignored.
+ */
+/* }}} */
+namespace metrics {
+
+/* {{{ doc */
+/**
+ * @brief Bytes which begin every metrics file.
+ */
+/* }}} */
+constexpr inline std::array<char, 8> magic {'Z', 'E', 'B', 'R',
+                                            'A', 'M', 'T', '2'};
+
+/* {{{ doc */
+/**
+ * @brief Number of metrics recorded per step.
+ */
+/* }}} */
+constexpr inline std::size_t column_count {7};
+
+/* {{{ doc */
+/**
+ * @brief Names of the metrics, in the order they are stored.
+ */
+/* }}} */
+constexpr inline std::array<std::string_view, column_count>
+    column_names {"new_ships",          "leaving_ships",
+                  "queue_size",         "occupied_bays",
+                  "bay_time_remaining", "queue_repair_hours",
+                  "queue_parts"};
+
+/* {{{ doc */
+/**
+ * @brief Metrics of one step, in the order of `column_names`.
+ */
+/* }}} */
+using row = std::array<std::int64_t, column_count>;
+
+/* {{{ doc */
+/**
+ * @brief Takes the metrics of the step `station` just performed.
+ */
+/* }}} */
+auto sample(const space_station& station) noexcept -> row;
+
+/* {{{ doc */
+/**
+ * @brief Records metrics of every step into a metrics file.
+ *
+ * Recording a step only appends to in-memory columns; encoding and
+ * writing happen once per block.
+ */
+/* }}} */
+class writer
+{
+private:
+
+  std::FILE* m_file {nullptr};
+  std::size_t m_block_rows;
+  std::array<std::vector<std::int64_t>, column_count> m_columns {};
+  std::vector<char> m_encoded {};
+  std::vector<char> m_encoded_column {};
+
+  auto write_block() noexcept -> bool;
+
+public:
+
+  /* {{{ doc */
+  /**
+   * @brief Creates or truncates the metrics file at `path`. Check
+   * `is_open()` for success.
+   *
+   * @param path Path of metrics file to write.
+   *
+   * @param first_step Number of the first step to be recorded, which is
+   * not 1 if the run was resumed from a checkpoint.
+   *
+   * @param block_rows Number of steps to collect before encoding and
+   * writing them.
+   */
+  /* }}} */
+  explicit writer(const std::string& path, std::uint64_t first_step = 1,
+                  std::size_t block_rows = conf::metrics_block_rows);
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be copied
+   */
+  /* }}} */
+  writer(const writer&) = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be copied
+   */
+  /* }}} */
+  auto operator=(const writer&) -> writer& = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be moved
+   */
+  /* }}} */
+  writer(writer&&) = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be moved
+   */
+  /* }}} */
+  auto operator=(writer&&) -> writer& = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Closes the file, if still open.
+   */
+  /* }}} */
+  ~writer() noexcept;
+
+  /* {{{ doc */
+  /**
+   * @brief Records the metrics of one step.
+   *
+   * @return False if the file is not open, or could not be written.
+   */
+  /* }}} */
+  auto record(const row& values) -> bool;
+
+  /* {{{ doc */
+  /**
+   * @brief Writes the steps recorded so far as a final block, and closes
+   * the file.
+   *
+   * @return False if the file was not open, or could not be written.
+   */
+  /* }}} */
+  auto close() noexcept -> bool;
+
+  [[nodiscard]] inline auto is_open() const noexcept -> bool
+  {
+    return m_file != nullptr;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Bytes the writer has allocated, beyond its own size.
+   */
+  /* }}} */
+  [[nodiscard]] auto memory_footprint() const noexcept -> std::size_t;
+};
+
+/* {{{ doc */
+/**
+ * @brief Reads a metrics file one block at a time.
+ */
+/* }}} */
+class reader
+{
+private:
+
+  std::ifstream m_file;
+  std::uint64_t m_first_step {1};
+  std::array<std::vector<std::int64_t>, column_count> m_columns {};
+  std::vector<char> m_encoded {};
+
+public:
+
+  /* {{{ doc */
+  /**
+   * @brief Opens the metrics file at `path`, and reads its header. Check
+   * `is_open()` for success.
+   */
+  /* }}} */
+  explicit reader(const std::string& path);
+
+  /* {{{ doc */
+  /**
+   * @brief Determine if the file was opened, and is a metrics file with
+   * the expected columns.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto is_open() const noexcept -> bool
+  {
+    return m_file.is_open();
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Number of the first step in the file.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto first_step() const noexcept -> std::uint64_t
+  {
+    return m_first_step;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Decodes the next block of the file.
+   *
+   * @return False at the end of the file, or if the next block is
+   * malformed or incomplete.
+   */
+  /* }}} */
+  auto next_block() -> bool;
+
+  /* {{{ doc */
+  /**
+   * @brief Values of one column in the most recently decoded block.
+   *
+   * @param index Index of the column in `column_names`.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto column(const std::size_t index) const noexcept
+      -> const std::vector<std::int64_t>&
+  {
+    return m_columns[index];
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Number of steps in the most recently decoded block.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto block_rows() const noexcept -> std::size_t
+  {
+    return m_columns[0].size();
+  }
+};
+
+/* {{{ doc */
+/**
+ * @brief Writes a metrics file out as CSV, with a header row and a step
+ * number column first, counting from the file's first step.
+ *
+ * @return False if the file could not be read.
+ */
+/* }}} */
+auto write_csv(const std::string& path, std::ostream& out) -> bool;
+
+} // namespace metrics
+
+#endif
@@ -0,0 +1,282 @@
+#ifndef PART_SET_H
+#define PART_SET_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "utils/bit.hpp"
+#include "utils/memory.hpp"
+
+#include "constants.h"
+
+/* {{{ doc */
+/**
+ * @brief Set of damaged parts, each with a severity of damage.
+ *
+ * Part IDs are stored as one bit each in a fixed-size bitmask, and
+ * damage values are stored packed, one byte each, in ascending ID
+ * order. The position of a part's damage value is the number of set
+ * bits below its ID, so membership tests, counts, and lookups are all
+ * bit operations, and the size of a set is predictable.
+ */
+/* }}} */
+class part_set
+{
+public:
+
+  struct part {
+    int id;
+    int damage;
+
+    // NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
+    part(int id_arg, int damage_arg) // It must be this way
+        : id(id_arg)
+        , damage(damage_arg)
+    {}
+  };
+
+  static constexpr std::size_t word_bits {64};
+
+  static constexpr std::size_t word_count {
+      (static_cast<std::size_t>(conf::part_id_limit) + word_bits - 1)
+      / word_bits};
+
+  /* {{{ doc */
+  /**
+   * @brief One bit for every possible part ID.
+   */
+  /* }}} */
+  using mask = std::array<std::uint64_t, word_count>;
+
+  /* {{{ doc */
+  /**
+   * @brief Builds a mask with a bit set for every ID in `ids`.
+   * Usable at compile time.
+   *
+   * @param ids Part IDs, each in [0, conf::part_id_limit).
+   */
+  /* }}} */
+  template <std::size_t N>
+  static constexpr auto make_mask(const std::array<int, N>& ids) noexcept
+      -> mask
+  {
+    mask retval {};
+    for ( const int id : ids ) {
+      const auto index {static_cast<std::size_t>(id)};
+      retval[index / word_bits] |= std::uint64_t {1}
+                                   << (index % word_bits);
+    }
+    return retval;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Number of bits set in a mask.
+   */
+  /* }}} */
+  static constexpr auto mask_count(const mask& bits) noexcept
+      -> std::size_t
+  {
+    std::size_t count {0};
+    for ( const std::uint64_t word : bits ) {
+      count += static_cast<std::size_t>(::ehanc::popcount(word));
+    }
+    return count;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Read-only forward iterator over parts, in ascending ID order.
+   * Dereferences to a `part` by value.
+   */
+  /* }}} */
+  class const_iterator
+  {
+  public:
+
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = part;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = void;
+    using reference         = part;
+
+  private:
+
+    const part_set* m_set {nullptr};
+    std::size_t m_word {word_count};
+    std::uint64_t m_bits {0};
+    std::size_t m_index {0};
+
+    // Move to the next word with a set bit, if out of set bits
+    inline void skip_empty_words() noexcept
+    {
+      while ( m_bits == 0 && ++m_word < word_count ) {
+        m_bits = m_set->m_ids[m_word];
+      }
+    }
+
+  public:
+
+    const_iterator() noexcept = default;
+
+    const_iterator(const part_set& set, std::size_t word) noexcept
+        : m_set {&set}
+        , m_word {word}
+        , m_bits {word < word_count ? set.m_ids[word] : 0}
+    {
+      if ( m_word < word_count ) {
+        this->skip_empty_words();
+      }
+    }
+
+    [[nodiscard]] inline auto operator*() const noexcept -> part
+    {
+      return {static_cast<int>((m_word * word_bits)
+                               + static_cast<std::size_t>(
+                                   ::ehanc::countr_zero(m_bits))),
+              static_cast<int>(m_set->m_damage[m_index])};
+    }
+
+    inline auto operator++() noexcept -> const_iterator&
+    {
+      m_bits &= m_bits - 1;
+      ++m_index;
+      this->skip_empty_words();
+      return *this;
+    }
+
+    inline auto operator++(int) noexcept -> const_iterator
+    {
+      const_iterator retval {*this};
+      ++(*this);
+      return retval;
+    }
+
+    [[nodiscard]] inline auto operator==(const const_iterator& rhs) const
+        noexcept -> bool
+    {
+      return m_word == rhs.m_word && m_bits == rhs.m_bits;
+    }
+
+    [[nodiscard]] inline auto operator!=(const const_iterator& rhs) const
+        noexcept -> bool
+    {
+      return not(*this == rhs);
+    }
+  };
+
+private:
+
+  mask m_ids {};
+
+  // Damage of each part, in ascending order of ID
+  std::vector<std::uint8_t> m_damage {};
+
+  // Position of id's damage value in m_damage
+  [[nodiscard]] auto rank(int id) const noexcept -> std::size_t;
+
+public:
+
+  /* {{{ doc */
+  /**
+   * @brief Adds a part to the set.
+   *
+   * @param id Part ID, in [0, conf::part_id_limit).
+   *
+   * @param damage Severity of damage, in [0, 255].
+   *
+   * @return False if the part was already in the set, in which case the
+   * set is unchanged.
+   */
+  /* }}} */
+  auto insert(int id, int damage) noexcept -> bool;
+
+  /* {{{ doc */
+  /**
+   * @brief Determine if a part is in the set.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto contains(int id) const noexcept -> bool
+  {
+    const auto index {static_cast<std::size_t>(id)};
+    return ((m_ids[index / word_bits] >> (index % word_bits)) & 1U) != 0;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Determine if every part in the set is also in `bits`.
+   */
+  /* }}} */
+  [[nodiscard]] auto is_subset_of(const mask& bits) const noexcept -> bool;
+
+  /* {{{ doc */
+  /**
+   * @brief Damage of a part in the set, or 0 if not in the set.
+   */
+  /* }}} */
+  [[nodiscard]] auto damage(int id) const noexcept -> int;
+
+  /* {{{ doc */
+  /**
+   * @brief Sum of damage of all parts in the set.
+   */
+  /* }}} */
+  [[nodiscard]] auto total_damage() const noexcept -> int;
+
+  [[nodiscard]] inline auto size() const noexcept -> std::size_t
+  {
+    return m_damage.size();
+  }
+
+  [[nodiscard]] inline auto empty() const noexcept -> bool
+  {
+    return m_damage.empty();
+  }
+
+  inline void clear() noexcept
+  {
+    m_ids = mask {};
+    m_damage.clear();
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Bytes the set has allocated, beyond its own size.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto memory_footprint() const noexcept
+      -> std::size_t
+  {
+    return ehanc::heap_bytes(m_damage);
+  }
+
+  [[nodiscard]] inline auto ids() const noexcept -> const mask&
+  {
+    return m_ids;
+  }
+
+  [[nodiscard]] inline auto begin() const noexcept -> const_iterator
+  {
+    return {*this, 0};
+  }
+
+  [[nodiscard]] inline auto end() const noexcept -> const_iterator
+  {
+    return {};
+  }
+
+  [[nodiscard]] inline auto cbegin() const noexcept -> const_iterator
+  {
+    return this->begin();
+  }
+
+  [[nodiscard]] inline auto cend() const noexcept -> const_iterator
+  {
+    return this->end();
+  }
+};
+
+#endif
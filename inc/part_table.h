@@ -0,0 +1,122 @@
+#ifndef PART_TABLE_H
+#define PART_TABLE_H
+
+#include <cstddef>
+#include <iterator>
+
+#include "constants.h"
+#include "part_set.h"
+
+/* {{{ doc */
+/**
+ * @brief Compile-time view of a list of part IDs, such as the
+ * `conf::*_part_list` arrays.
+ *
+ * If the list is an arithmetic progression, which is detected at compile
+ * time, the ID at an index and whether an ID is in the list are computed
+ * from the first ID and the stride, which are constants, so neither
+ * touches memory. Any other list falls back to indexing the array, and
+ * to a bitmask for membership.
+ *
+ * @tparam Ids Array of distinct part IDs, each in
+ * [0, conf::part_id_limit), with static storage duration.
+ */
+/* }}} */
+template <const auto& Ids>
+class part_table
+{
+private:
+
+  static constexpr std::size_t count {std::size(Ids)};
+
+  static_assert(count != 0, "A part list must not be empty");
+
+  static constexpr auto detect_progression() noexcept -> bool
+  {
+    if ( count < 2 ) {
+      return true;
+    }
+
+    const int step {Ids[1] - Ids[0]};
+    if ( step <= 0 ) {
+      return false;
+    }
+    for ( std::size_t i {2}; i != count; ++i ) {
+      if ( Ids[i] - Ids[i - 1] != step ) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+public:
+
+  /* {{{ doc */
+  /**
+   * @brief Whether the list is an arithmetic progression with a positive
+   * stride.
+   */
+  /* }}} */
+  static constexpr bool is_progression {detect_progression()};
+
+  static constexpr int first {Ids[0]};
+
+  static constexpr int stride {count < 2 ? 1 : Ids[1] - Ids[0]};
+
+  /* {{{ doc */
+  /**
+   * @brief One bit for every ID in the list.
+   */
+  /* }}} */
+  static constexpr part_set::mask mask {part_set::make_mask(Ids)};
+
+  static_assert(part_set::mask_count(mask) == count,
+                "Part lists must not contain duplicate IDs");
+
+  [[nodiscard]] static constexpr auto size() noexcept -> std::size_t
+  {
+    return count;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief ID at `index` in the list, which must be below `size()`.
+   */
+  /* }}} */
+  [[nodiscard]] static constexpr auto id(const std::size_t index) noexcept
+      -> int
+  {
+    if constexpr ( is_progression ) {
+      return first + (stride * static_cast<int>(index));
+    } else {
+      return Ids[index];
+    }
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Determines if `part_id` is in the list. Any value may be
+   * tested.
+   */
+  /* }}} */
+  [[nodiscard]] static constexpr auto contains(const int part_id) noexcept
+      -> bool
+  {
+    if constexpr ( is_progression ) {
+      const int offset {part_id - first};
+      return offset >= 0 && offset % stride == 0
+             && static_cast<std::size_t>(offset / stride) < count;
+    } else {
+      if ( part_id < 0 || part_id >= conf::part_id_limit ) {
+        return false;
+      }
+      const auto index {static_cast<std::size_t>(part_id)};
+      return ((mask[index / part_set::word_bits]
+               >> (index % part_set::word_bits))
+              & 1U)
+             != 0;
+    }
+  }
+};
+
+#endif
@@ -2,21 +2,164 @@
 #define RANDOM_HPP
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <ctime>
 #include <iterator>
 #include <random>
 #include <type_traits>
 
+#include "utils/alias_table.hpp"
+#include "utils/bounded_int.hpp"
+
 #include "constants.h"
 #include "ship.h"
 
+/* {{{ doc */
+/**
+ * @brief Returns the calling thread's random engine. Each thread has its
+ * own engine, seeded from the time and the order in which threads first
+ * asked for one, unless reseeded with `seed_random_engine()`.
+ */
+/* }}} */
 inline auto random_engine() noexcept -> conf::random_engine&
 {
-  static conf::random_engine gen(static_cast<std::size_t>(time(nullptr)));
+  static std::atomic<std::size_t> thread_count {0};
+
+  thread_local conf::random_engine gen(
+      static_cast<std::size_t>(time(nullptr)) + thread_count++);
   return gen;
 }
 
+/* {{{ doc */
+/**
+ * @brief Reseeds the calling thread's random engine, making everything it
+ * generates from then on reproducible.
+ */
+/* }}} */
+inline void seed_random_engine(const std::uint32_t seed) noexcept
+{
+  random_engine().seed(seed);
+}
+
+/* {{{ doc */
+/**
+ * @brief Number of outcomes in the precomputed tables used for
+ * part counts and new ship counts.
+ */
+/* }}} */
+constexpr inline std::size_t sample_table_size {32};
+
+/* {{{ doc */
+/**
+ * @brief Total weight of each precomputed sample table. Chosen so that
+ * `sample_table_size * sample_table_weight` is exactly the range of a
+ * 32-bit engine, letting raw engine output index the table directly.
+ */
+/* }}} */
+constexpr inline std::uint64_t sample_table_weight {
+    (std::uint64_t {1} << 32U) / sample_table_size};
+
+/* {{{ doc */
+/**
+ * @brief Whether the part count table covers every value with
+ * non-negligible probability (more than 8 standard deviations above the
+ * mean). If not, part counts fall back to sampling the normal
+ * distribution with rejection.
+ */
+/* }}} */
+constexpr inline bool part_count_table_covers {
+    conf::broken_part_count_mean + (8.0 * conf::broken_part_count_stddev)
+    < static_cast<double>(conf::broken_part_count_min)
+          + static_cast<double>(sample_table_size)};
+
+/* {{{ doc */
+/**
+ * @brief Whether the new ship count table covers every value with
+ * non-negligible probability. If not, new ship counts fall back to
+ * `std::poisson_distribution`.
+ */
+/* }}} */
+constexpr inline bool new_ship_count_table_covers {
+    conf::new_ship_count_poisson_mean <= 4.0};
+
+/* {{{ doc */
+/**
+ * @brief Table over part counts `conf::broken_part_count_min` through
+ * `conf::broken_part_count_min + sample_table_size - 1`.
+ *
+ * `get_part_count()` truncates a normal sample to an integer and
+ * rejects values below the minimum, so each part count `k` is drawn
+ * with the normal probability of the interval truncating to `k`,
+ * renormalized over the accepted values. The table holds exactly
+ * those probabilities, replacing the rejection loop with one draw.
+ */
+/* }}} */
+inline auto part_count_table() noexcept
+    -> const ehanc::alias_table<sample_table_size>&
+{
+  static const ehanc::alias_table<sample_table_size> table {[]() {
+    auto normal_cdf {[](const double x) -> double {
+      return 0.5
+             * std::erfc(-(x - conf::broken_part_count_mean)
+                         / (conf::broken_part_count_stddev
+                            * std::sqrt(2.0)));
+    }};
+
+    std::array<double, sample_table_size> probabilities {};
+
+    for ( std::size_t i {0}; i != sample_table_size; ++i ) {
+      const double k {
+          static_cast<double>(conf::broken_part_count_min)
+          + static_cast<double>(i)};
+
+      // static_cast<int> truncates towards zero
+      if ( k > 0.5 ) {
+        probabilities[i] = normal_cdf(k + 1.0) - normal_cdf(k);
+      } else if ( k > -0.5 ) {
+        probabilities[i] = normal_cdf(1.0) - normal_cdf(-1.0);
+      } else {
+        probabilities[i] = normal_cdf(k) - normal_cdf(k - 1.0);
+      }
+    }
+
+    return ehanc::alias_table<sample_table_size> {
+        ehanc::quantize_weights(probabilities, sample_table_weight)};
+  }()}; // IILE
+
+  return table;
+}
+
+/* {{{ doc */
+/**
+ * @brief Table over new ship counts 0 through `sample_table_size - 1`,
+ * holding the poisson probabilities for
+ * `conf::new_ship_count_poisson_mean`.
+ */
+/* }}} */
+inline auto new_ship_count_table() noexcept
+    -> const ehanc::alias_table<sample_table_size>&
+{
+  static const ehanc::alias_table<sample_table_size> table {[]() {
+    std::array<double, sample_table_size> probabilities {};
+
+    probabilities[0] = std::exp(-conf::new_ship_count_poisson_mean);
+    for ( std::size_t k {1}; k != sample_table_size; ++k ) {
+      probabilities[k] = probabilities[k - 1]
+                         * conf::new_ship_count_poisson_mean
+                         / static_cast<double>(k);
+    }
+
+    return ehanc::alias_table<sample_table_size> {
+        ehanc::quantize_weights(probabilities, sample_table_weight)};
+  }()}; // IILE
+
+  return table;
+}
+
 /* {{{ doc */
 /**
  * @brief Returns a valid count of broken parts. Normal distribution
@@ -26,24 +169,83 @@ inline auto random_engine() noexcept -> conf::random_engine&
 /* }}} */
 inline auto get_part_count() noexcept -> int
 {
-  static std::normal_distribution<double> broken_part_dist(
-      conf::broken_part_count_mean, conf::broken_part_count_stddev);
+  if constexpr ( part_count_table_covers ) {
+
+    return conf::broken_part_count_min
+           + static_cast<int>(part_count_table()(random_engine()));
+
+  } else {
+
+    static std::normal_distribution<double> broken_part_dist(
+        conf::broken_part_count_mean, conf::broken_part_count_stddev);
 
-  int generated {static_cast<int>(broken_part_dist(random_engine()))};
+    int generated {static_cast<int>(broken_part_dist(random_engine()))};
 
-  while ( generated < conf::broken_part_count_min ) {
-    generated = static_cast<int>(broken_part_dist(random_engine()));
+    while ( generated < conf::broken_part_count_min ) {
+      generated = static_cast<int>(broken_part_dist(random_engine()));
+    }
+
+    return generated;
   }
+}
 
-  return generated;
+/* {{{ doc */
+/**
+ * @brief Fills [begin, end) with valid counts of broken parts, as
+ * `get_part_count()` would return them.
+ *
+ * @tparam Itr Forward iterator to an integral type.
+ */
+/* }}} */
+template <typename Itr>
+inline void get_part_counts(Itr begin, const Itr end) noexcept
+{
+  if constexpr ( part_count_table_covers ) {
+
+    part_count_table()(random_engine(), begin, end);
+
+    using value_t = typename std::iterator_traits<Itr>::value_type;
+    for ( ; begin != end; ++begin ) {
+      *begin += static_cast<value_t>(conf::broken_part_count_min);
+    }
+
+  } else {
+
+    std::generate(begin, end, &get_part_count);
+  }
 }
 
 inline auto get_new_ship_count() noexcept -> int
 {
-  static std::poisson_distribution<int> new_ship_dist(
-      conf::new_ship_count_poisson_mean);
+  if constexpr ( new_ship_count_table_covers ) {
 
-  return new_ship_dist(random_engine());
+    return static_cast<int>(new_ship_count_table()(random_engine()));
+
+  } else {
+
+    static std::poisson_distribution<int> new_ship_dist(
+        conf::new_ship_count_poisson_mean);
+
+    return new_ship_dist(random_engine());
+  }
+}
+
+/* {{{ doc */
+/**
+ * @brief Fills [begin, end) with new ship counts for consecutive time
+ * steps, as `get_new_ship_count()` would return them.
+ *
+ * @tparam Itr Forward iterator to an integral type.
+ */
+/* }}} */
+template <typename Itr>
+inline void get_new_ship_counts(Itr begin, const Itr end) noexcept
+{
+  if constexpr ( new_ship_count_table_covers ) {
+    new_ship_count_table()(random_engine(), begin, end);
+  } else {
+    std::generate(begin, end, &get_new_ship_count);
+  }
 }
 
 /* {{{ doc */
@@ -68,57 +270,59 @@ inline auto random_select(Itr begin, const Itr end) noexcept -> Itr
   // g++-11 and g++-12 in std=c++17) that type is long
   using itrdiff_t = typename std::iterator_traits<Itr>::difference_type;
 
-  itrdiff_t size {std::distance(begin, end)};
-
-  // using (size - 1) to avoid indexing out-of-bounds
-  std::uniform_int_distribution<itrdiff_t> selection_dist(0, size - 1);
+  const itrdiff_t size {std::distance(begin, end)};
 
-  std::advance(begin, selection_dist(random_engine()));
+  std::advance(begin,
+               static_cast<itrdiff_t>(ehanc::bounded_rand(
+                   random_engine(), static_cast<std::uint64_t>(size))));
 
   return begin;
 }
 
 /* {{{ doc */
 /**
- * @brief Returns a random faction weighted accordingly to
- * `conf::*_ship_chance` constants in constants.h
+ * @brief Alias table over factions, weighted according to the
+ * `conf::*_ship_chance` constants in constants.h. Built at compile time.
+ * Category indices follow the declaration order of `ship::faction`.
  */
 /* }}} */
-inline auto get_random_faction() -> ship::faction
-{
-  std::uniform_int_distribution fact_dist(1, 100);
-
-  int random {fact_dist(random_engine())};
-
-  if ( random < conf::human_ship_chance ) {
-
-    // 50% chance
-    return ship::faction::human;
+constexpr inline ehanc::alias_table<5> faction_table {std::array {
+    conf::human_ship_chance, conf::ferengi_ship_chance,
+    conf::klingon_ship_chance, conf::romulan_ship_chance,
+    conf::other_ship_chance}};
 
-  } else if ( random
-              < conf::human_ship_chance + conf::ferengi_ship_chance ) {
+static_assert(static_cast<std::size_t>(ship::faction::other) + 1
+                  == faction_table.size(),
+              "faction_table out of sync with ship::faction");
 
-    // 65 - 50 = 50% chance
-    return ship::faction::ferengi;
+static_assert(faction_table.outcomes(static_cast<std::size_t>(
+                  ship::faction::human))
+                  == conf::human_ship_chance * faction_table.size(),
+              "faction_table does not reproduce conf::human_ship_chance");
 
-  } else if ( random < conf::human_ship_chance + conf::ferengi_ship_chance
-                           + conf::klingon_ship_chance ) {
-
-    // 75 - 65 = 10% chance
-    return ship::faction::klingon;
-
-  } else if ( random < conf::human_ship_chance + conf::ferengi_ship_chance
-                           + conf::klingon_ship_chance
-                           + conf::romulan_ship_chance ) {
-
-    // 80 - 75 = 5% chance
-    return ship::faction::romulan;
-
-  } else {
+/* {{{ doc */
+/**
+ * @brief Returns a random faction weighted accordingly to
+ * `conf::*_ship_chance` constants in constants.h
+ */
+/* }}} */
+inline auto get_random_faction() noexcept -> ship::faction
+{
+  return static_cast<ship::faction>(faction_table(random_engine()));
+}
 
-    // 100 - 80 = 20% chance
-    return ship::faction::other;
-  }
+/* {{{ doc */
+/**
+ * @brief Fills [begin, end) with random factions weighted accordingly to
+ * `conf::*_ship_chance` constants in constants.h
+ *
+ * @tparam Itr Forward iterator to `ship::faction`.
+ */
+/* }}} */
+template <typename Itr>
+inline void get_random_factions(Itr begin, const Itr end) noexcept
+{
+  faction_table(random_engine(), begin, end);
 }
 
 #endif
@@ -1,23 +1,141 @@
 #ifndef REPAIR_BAY_H
 #define REPAIR_BAY_H
 
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <iterator>
 #include <optional>
+#include <string_view>
+#include <vector>
+
+#include "utils/memory.hpp"
 
 #include "constants.h"
 #include "ship.h"
 
+/* {{{ doc */
+/**
+ * @brief What a repair bay is capable of.
+ */
+/* }}} */
+struct bay_spec {
+  // Repairs take 1 / speed as long as normal, rounded up
+  double speed {1.0};
+  // Factions whose ships the bay can repair
+  ship::faction_mask factions {ship::every_faction};
+  // Repair parts one by one, tracking each part's progress, rather than
+  // only the ship as a whole
+  bool track_parts {false};
+
+  /* {{{ doc */
+  /**
+   * @brief Parses a spec of the form `speed[:faction+faction...]`, such
+   * as `2`, or `0.5:klingon+romulan`. Faction names are lowercase.
+   *
+   * @return The spec, or nothing if `text` is not a valid spec.
+   */
+  /* }}} */
+  static auto parse(std::string_view text) noexcept
+      -> std::optional<bay_spec>;
+
+  [[nodiscard]] inline auto accepts(const ship::faction fact) const
+      noexcept -> bool
+  {
+    return (factions & ship::faction_bit(fact)) != 0;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Hours this bay takes to repair a ship which takes
+   * `base_time` hours in a normal bay. Never less than one hour.
+   */
+  /* }}} */
+  [[nodiscard]] auto repair_time(int base_time) const noexcept -> int;
+};
+
+/* {{{ doc */
+/**
+ * @brief Repairs one ship at a time.
+ *
+ * A ship takes a fixed number of hours, set by its damage and the bay's
+ * speed. If the bay tracks parts, the ship's damage is also worked off
+ * over those hours at an even rate, one part at a time in order of ID,
+ * so parts are finished one by one, and the last one exactly when the
+ * ship leaves. Part progress is kept in one packed array per bay, which
+ * is reused from ship to ship.
+ */
+/* }}} */
 class repair_bay
 {
+public:
+
+  /* {{{ doc */
+  /**
+   * @brief Damage left on one part of the docked ship.
+   */
+  /* }}} */
+  struct part_progress {
+    std::uint16_t id;
+    std::uint16_t remaining;
+  };
+
+  static_assert(conf::part_id_limit <= 0x10000,
+                "Part IDs must fit in part_progress::id");
+
+  /* {{{ doc */
+  /**
+   * @brief Parts finished in one time step.
+   */
+  /* }}} */
+  struct part_range {
+    std::vector<part_progress>::const_iterator first;
+    std::vector<part_progress>::const_iterator last;
+
+    [[nodiscard]] inline auto begin() const noexcept
+        -> std::vector<part_progress>::const_iterator
+    {
+      return first;
+    }
+
+    [[nodiscard]] inline auto end() const noexcept
+        -> std::vector<part_progress>::const_iterator
+    {
+      return last;
+    }
+
+    [[nodiscard]] inline auto size() const noexcept -> std::size_t
+    {
+      return static_cast<std::size_t>(last - first);
+    }
+  };
+
 private:
 
+  bay_spec m_spec {};
   std::optional<ship> m_docked_ship {};
   int m_remaining_repair_time {};
 
+  // Only used when tracking parts. Parts before m_cursor are finished,
+  // and those from m_step_first_done were finished in the last step.
+  std::vector<part_progress> m_parts {};
+  std::size_t m_cursor {0};
+  std::size_t m_step_first_done {0};
+  int m_repair_time {0};
+  int m_total_damage {0};
+  int m_damage_repaired {0};
+  ship::id_type m_ship_id {0};
+
+  void repair_parts() noexcept;
+
 public:
 
   repair_bay() noexcept = default;
 
+  explicit repair_bay(const bay_spec& spec) noexcept
+      : m_spec {spec}
+  {}
+
   /* {{{ doc */
   /**
    * @brief Must not be copied
@@ -88,6 +206,63 @@ public:
     return not this->has_ship();
   }
 
+  /* {{{ doc */
+  /**
+   * @brief Ship being repaired, if any.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto docked_ship() const noexcept
+      -> const std::optional<ship>&
+  {
+    return m_docked_ship;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Parts finished in the last time step, if tracking parts.
+   * Valid until the next `dock()`.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto last_finished_parts() const noexcept
+      -> part_range
+  {
+    return part_range {
+        std::next(m_parts.cbegin(),
+                  static_cast<long>(m_step_first_done)),
+        std::next(m_parts.cbegin(), static_cast<long>(m_cursor))};
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief ID of the ship the tracked parts belong to, which may have
+   * just left.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto tracked_ship_id() const noexcept
+      -> ship::id_type
+  {
+    return m_ship_id;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Bytes the bay has allocated, beyond its own size, including
+   * what the docked ship has allocated.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto memory_footprint() const noexcept
+      -> std::size_t
+  {
+    return ehanc::heap_bytes(m_parts)
+           + (m_docked_ship.has_value() ? m_docked_ship->memory_footprint()
+                                        : 0);
+  }
+
+  [[nodiscard]] inline auto spec() const noexcept -> const bay_spec&
+  {
+    return m_spec;
+  }
+
   /* {{{ doc */
   /**
    * @brief Get remaining repair time
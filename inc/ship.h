@@ -2,11 +2,16 @@
 #define SHIP_H
 
 #include <cstddef>
+#include <cstdint>
 #include <iostream>
-#include <list>
 #include <string>
+#include <string_view>
+#include <utility>
 
 #include "constants.h"
+#include "part_set.h"
+#include "part_table.h"
+#include "ship_id_allocator.h"
 
 class ship
 {
@@ -14,24 +19,102 @@ public:
 
   enum class faction { human, ferengi, klingon, romulan, other };
 
-  struct part {
-    int id;
-    int damage;
+  static constexpr std::size_t faction_count {
+      static_cast<std::size_t>(faction::other) + 1};
 
-    // NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
-    part(int id_arg, int damage_arg) // It must be this way
-        : id(id_arg)
-        , damage(damage_arg)
-    {}
-  };
+  /* {{{ doc */
+  /**
+   * @brief Set of factions, one bit per faction.
+   */
+  /* }}} */
+  using faction_mask = std::uint8_t;
+
+  static constexpr faction_mask every_faction {
+      static_cast<faction_mask>((1U << faction_count) - 1)};
+
+  static constexpr auto faction_bit(faction fact) noexcept
+      -> faction_mask
+  {
+    return static_cast<faction_mask>(1U << static_cast<unsigned>(fact));
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Name of a faction, capitalized, as in reports.
+   */
+  /* }}} */
+  static auto faction_name(faction fact) noexcept -> std::string_view;
+
+  using part = part_set::part;
+
+  using id_type = ship_id_allocator::id_type;
+
+  /* {{{ doc */
+  /**
+   * @brief Valid part IDs of each faction, from the `conf::*_part_list`
+   * arrays.
+   */
+  /* }}} */
+  using human_parts   = part_table<conf::human_part_list>;
+  using ferengi_parts = part_table<conf::ferengi_part_list>;
+  using klingon_parts = part_table<conf::klingon_part_list>;
+  using romulan_parts = part_table<conf::romulan_part_list>;
+  using other_parts   = part_table<conf::other_part_list>;
+
+  /* {{{ doc */
+  /**
+   * @brief Returns a mask of the valid part IDs for a faction,
+   * built at compile time from the `conf::*_part_list` arrays.
+   */
+  /* }}} */
+  static constexpr auto valid_parts(faction fact) noexcept
+      -> const part_set::mask&
+  {
+    switch ( fact ) {
+    case faction::human:
+      return human_parts::mask;
+    case faction::ferengi:
+      return ferengi_parts::mask;
+    case faction::klingon:
+      return klingon_parts::mask;
+    case faction::romulan:
+      return romulan_parts::mask;
+    case faction::other:
+      return other_parts::mask;
+    }
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Determines if a part ID is valid for a faction. Any value may
+   * be tested.
+   */
+  /* }}} */
+  static constexpr auto is_valid_part(faction fact, int id) noexcept
+      -> bool
+  {
+    switch ( fact ) {
+    case faction::human:
+      return human_parts::contains(id);
+    case faction::ferengi:
+      return ferengi_parts::contains(id);
+    case faction::klingon:
+      return klingon_parts::contains(id);
+    case faction::romulan:
+      return romulan_parts::contains(id);
+    case faction::other:
+      return other_parts::contains(id);
+    }
+    return false;
+  }
 
 private:
 
-  int m_id;
+  id_type m_id;
 
   faction m_faction;
 
-  std::list<part> m_damaged_parts;
+  part_set m_damaged_parts;
 
 public:
 
@@ -43,7 +126,22 @@ public:
    */
   /* }}} */
   static auto create_damaged_part_list(faction fact) noexcept
-      -> std::list<part>;
+      -> part_set;
+
+  /* {{{ doc */
+  /**
+   * @brief Creates a valid damaged part list for a faction, with a
+   * predetermined number of damaged parts.
+   *
+   * @param fact Faction for which to create a list of valid damaged parts
+   *
+   * @param part_count Number of damaged parts. Must not be 0, and must
+   * not exceed the number of valid parts for the faction.
+   */
+  /* }}} */
+  static auto create_damaged_part_list(faction fact,
+                                       std::size_t part_count) noexcept
+      -> part_set;
 
   ship() = delete;
 
@@ -59,14 +157,44 @@ public:
    */
   /* }}} */
   ship(faction fact) noexcept
-      : m_id {}
+      : ship(fact, create_damaged_part_list(fact))
+  {}
+
+  /* {{{ doc */
+  /**
+   * @brief Constructs a ship with the next ID number from an
+   * already-generated damaged part list.
+   *
+   * @param fact Faction of the ship to construct.
+   *
+   * @param damaged_parts Damaged part list, as from
+   * ship::create_damaged_part_list. Must not be empty.
+   */
+  /* }}} */
+  ship(faction fact, part_set&& damaged_parts) noexcept
+      : ship(ship_id_allocator::global().next(), fact,
+             std::move(damaged_parts))
+  {}
+
+  /* {{{ doc */
+  /**
+   * @brief Constructs a ship with an ID from a `ship_id_allocator`, and
+   * an already-generated damaged part list.
+   *
+   * @param id ID of the ship, which no other ship from the same
+   * allocator may share.
+   *
+   * @param fact Faction of the ship to construct.
+   *
+   * @param damaged_parts Damaged part list, as from
+   * ship::create_damaged_part_list. Must not be empty.
+   */
+  /* }}} */
+  ship(id_type id, faction fact, part_set&& damaged_parts) noexcept
+      : m_id {id}
       , m_faction {fact}
-      , m_damaged_parts {create_damaged_part_list(fact)}
-  {
-    static int next_id {conf::starting_ship_id};
-    m_id = next_id;
-    ++next_id;
-  }
+      , m_damaged_parts {std::move(damaged_parts)}
+  {}
 
   ship(const ship& src) noexcept = delete;
 
@@ -80,8 +208,29 @@ public:
 
   static auto construct_random_ship() noexcept -> ship;
 
+  /* {{{ doc */
+  /**
+   * @brief Constructs an identical ship, with the same ID. Ships are
+   * not copyable, so that no two ships in one station share an ID;
+   * clones are only for handing the same arrivals to several stations.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto clone() const noexcept -> ship
+  {
+    return ship(m_id, m_faction, part_set {m_damaged_parts});
+  }
+
   void display(std::ostream& out) const noexcept;
 
+  /* {{{ doc */
+  /**
+   * @brief Writes the same report as `display()`, for a ship which is
+   * only known by these values.
+   */
+  /* }}} */
+  static void display(std::ostream& out, id_type id, faction fact,
+                      std::size_t part_count, int hours) noexcept;
+
   /* {{{ doc */
   /**
    * @brief Get sum of all damage values of all parts.
@@ -89,6 +238,16 @@ public:
   /* }}} */
   [[nodiscard]] auto get_total_damage() const noexcept -> int;
 
+  /* {{{ doc */
+  /**
+   * @brief Hours a repair bay takes to repair this ship.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto repair_time() const noexcept -> int
+  {
+    return conf::severity_to_time(this->get_total_damage());
+  }
+
   /* {{{ doc */
   /**
    * @brief Determines if ship is damaged.
@@ -120,13 +279,24 @@ public:
     return m_damaged_parts.size();
   }
 
-  [[nodiscard]] inline auto get_id() const noexcept -> int
+  [[nodiscard]] inline auto get_id() const noexcept -> id_type
   {
     return m_id;
   }
 
+  /* {{{ doc */
+  /**
+   * @brief Bytes the ship has allocated, beyond its own size.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto memory_footprint() const noexcept
+      -> std::size_t
+  {
+    return m_damaged_parts.memory_footprint();
+  }
+
   [[nodiscard]] inline auto get_damaged_parts_list() const noexcept
-      -> const std::list<part>&
+      -> const part_set&
   {
     return m_damaged_parts;
   }
@@ -0,0 +1,171 @@
+#ifndef SHIP_ID_ALLOCATOR_H
+#define SHIP_ID_ALLOCATOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "constants.h"
+
+/* {{{ doc */
+/**
+ * @brief Hands out ship IDs, which are unique and dense among the ships
+ * built from one allocator.
+ *
+ * IDs are handed out in blocks: whoever builds a batch of ships reserves
+ * one block of IDs for the whole batch, with a single atomic add, and
+ * then takes IDs from the block without touching the allocator again.
+ * So any number of threads may share an allocator with no contention per
+ * ship, and since each station or run owns its own allocator, its IDs
+ * depend only on the order it builds its own ships in.
+ */
+/* }}} */
+class ship_id_allocator
+{
+public:
+
+  using id_type = std::uint64_t;
+
+  /* {{{ doc */
+  /**
+   * @brief IDs reserved for one caller, in the range [next, last).
+   */
+  /* }}} */
+  class block
+  {
+  private:
+
+    id_type m_next;
+    id_type m_last;
+
+  public:
+
+    block() noexcept
+        : block(0, 0)
+    {}
+
+    block(const id_type first, const id_type last) noexcept
+        : m_next {first}
+        , m_last {last}
+    {}
+
+    /* {{{ doc */
+    /**
+     * @brief Takes the next ID. The block must not be empty.
+     */
+    /* }}} */
+    inline auto take() noexcept -> id_type
+    {
+      return m_next++;
+    }
+
+    [[nodiscard]] inline auto size() const noexcept -> std::size_t
+    {
+      return static_cast<std::size_t>(m_last - m_next);
+    }
+
+    [[nodiscard]] inline auto empty() const noexcept -> bool
+    {
+      return m_next == m_last;
+    }
+  };
+
+private:
+
+  std::atomic<id_type> m_next;
+
+public:
+
+  /* {{{ doc */
+  /**
+   * @param first First ID handed out.
+   */
+  /* }}} */
+  explicit ship_id_allocator(
+      const id_type first = conf::starting_ship_id) noexcept
+      : m_next {first}
+  {}
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be copied
+   */
+  /* }}} */
+  ship_id_allocator(const ship_id_allocator&) = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be copied
+   */
+  /* }}} */
+  auto operator=(const ship_id_allocator&) -> ship_id_allocator& = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be moved
+   */
+  /* }}} */
+  ship_id_allocator(ship_id_allocator&&) = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be moved
+   */
+  /* }}} */
+  auto operator=(ship_id_allocator&&) -> ship_id_allocator& = delete;
+
+  ~ship_id_allocator() = default;
+
+  /* {{{ doc */
+  /**
+   * @brief Reserves the next `count` IDs. Safe to call from any thread.
+   */
+  /* }}} */
+  inline auto reserve(const std::size_t count) noexcept -> block
+  {
+    const id_type first {
+        m_next.fetch_add(count, std::memory_order_relaxed)};
+    return block {first, first + count};
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Takes a single ID. Safe to call from any thread.
+   */
+  /* }}} */
+  inline auto next() noexcept -> id_type
+  {
+    return m_next.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief ID the next reservation starts at.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto peek() const noexcept -> id_type
+  {
+    return m_next.load(std::memory_order_relaxed);
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Hands out IDs from `next` on, as when restoring a run. Must
+   * not be called while other threads are taking IDs.
+   */
+  /* }}} */
+  inline void reset(const id_type next) noexcept
+  {
+    m_next.store(next, std::memory_order_relaxed);
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Allocator shared by ships built without one of their own,
+   * such as by `ship::construct_random_ship()`.
+   */
+  /* }}} */
+  static auto global() noexcept -> ship_id_allocator&;
+};
+
+#endif
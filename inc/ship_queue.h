@@ -0,0 +1,442 @@
+#ifndef SHIP_QUEUE_H
+#define SHIP_QUEUE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "utils/fenwick_tree.hpp"
+#include "utils/indexed_heap.hpp"
+
+#include "constants.h"
+#include "part_set.h"
+#include "ship.h"
+#include "ship_store.h"
+
+/* {{{ doc */
+/**
+ * @brief Queue of ships waiting for a repair bay, which hands them out
+ * in an order chosen by a scheduling policy.
+ *
+ * If split by faction, each faction waits in its own lane, so a bay
+ * which only repairs some factions finds the best ship it can take by
+ * comparing the front of each lane it accepts, without ever scanning the
+ * queue. Otherwise every ship waits in one lane. First come,
+ * first served lanes are plain deques. Under every other policy a lane
+ * keeps ships in recycled slots, ordered by an indexed heap on a key
+ * computed once when the ship arrives, so every operation is O(log n)
+ * at any queue depth. A second heap per lane tracks the most recent
+ * arrival still waiting, for `back()`. Ties always go to the earlier
+ * arrival, so across lanes ships come out in exactly the order a single
+ * queue would give.
+ *
+ * Ships wait as 16 byte records from a `ship_store`, which keeps their
+ * damaged part lists out of the way until they dock, so ordering ships
+ * only ever touches their records. First come, first served lanes keep
+ * each record with its order of arrival, which picks between the fronts
+ * of several lanes, so their ships take 24 bytes each. Other lanes keep
+ * the bare record in a slot, along with its entries in both heaps.
+ *
+ * Totals over every waiting ship, such as the repair hours waiting, are
+ * kept up to date as ships come and go, so reading them is O(1). Under
+ * the policies which order ships by repair time, Fenwick trees indexed
+ * by repair time also keep the ships and hours waiting at or below
+ * every repair time, so the work queued ahead of a ship is O(log n) to
+ * find.
+ */
+/* }}} */
+class ship_queue
+{
+public:
+
+  /* {{{ doc */
+  /**
+   * @brief Order in which waiting ships are docked.
+   */
+  /* }}} */
+  enum class policy {
+    // First come, first served
+    fifo,
+    // Shortest repair time first
+    shortest_first,
+    // Longest repair time first
+    longest_first,
+    // By conf::faction_priority, then first come, first served
+    faction_priority,
+    // Shortest repair time first, less conf::queue_aging_rate for every
+    // hour waited
+    aging
+  };
+
+  /* {{{ doc */
+  /**
+   * @brief Name of a policy, as accepted by `parse_policy()`.
+   */
+  /* }}} */
+  static auto policy_name(policy order) noexcept -> std::string_view;
+
+  /* {{{ doc */
+  /**
+   * @brief Policy with the name `name`, or nothing if there is none.
+   */
+  /* }}} */
+  static auto parse_policy(std::string_view name) noexcept
+      -> std::optional<policy>;
+
+  /* {{{ doc */
+  /**
+   * @brief Ships, and their repair hours at a bay of speed 1.
+   */
+  /* }}} */
+  struct work {
+    std::size_t ships {0};
+    std::uint64_t hours {0};
+  };
+
+  /* {{{ doc */
+  /**
+   * @brief Where a ship waits in the queue: its place in order of
+   * arrival, and the key it is ordered by, which is always 0 under
+   * `policy::fifo`.
+   */
+  /* }}} */
+  struct placement {
+    std::uint64_t order;
+    std::int64_t key;
+  };
+
+private:
+
+  // Ordered by the key, then by order of arrival
+  using key = std::pair<std::int64_t, std::uint64_t>;
+
+  struct arrival {
+    std::uint64_t order;
+    ship_store::record waiting;
+  };
+
+  static_assert(sizeof(arrival) == 24);
+
+  // Ships of one faction
+  struct lane {
+    // Only used by policy::fifo
+    std::deque<arrival> fifo {};
+
+    // Only used by the other policies
+    std::vector<ship_store::record> slots {};
+    std::vector<std::size_t> free_slots {};
+    ehanc::indexed_heap<key> order {};
+    ehanc::indexed_heap<std::uint64_t, std::greater<>> newest {};
+  };
+
+  policy m_policy;
+  bool m_split;
+  std::array<lane, ship::faction_count> m_lanes {};
+  ship_store m_store {};
+  std::size_t m_size {0};
+  std::uint64_t m_arrivals {0};
+
+  // Totals over every waiting ship
+  std::uint64_t m_repair_hours {0};
+  std::uint64_t m_part_count {0};
+  std::array<std::size_t, ship::faction_count> m_faction_sizes {};
+  std::array<std::uint64_t, ship::faction_count> m_faction_hours {};
+
+  // Ships and hours waiting at each repair time, only kept by the
+  // policies which order ships by repair time
+  ehanc::fenwick_tree<std::int64_t> m_time_ships {};
+  ehanc::fenwick_tree<std::int64_t> m_time_hours {};
+
+  // Only kept while tracking changes. Ships pushed since the last
+  // clear_changes(), in order, from arrival m_first_pushed on, and which
+  // of them have been popped since, and the orders of the earlier
+  // arrivals popped since.
+  struct pushed_ship {
+    placement where;
+    ship_store::record waiting;
+    bool popped;
+  };
+
+  bool m_track_changes {false};
+  std::uint64_t m_first_pushed {0};
+  std::vector<pushed_ship> m_pushed {};
+  std::vector<std::uint64_t> m_popped {};
+
+  void add_totals(const ship_store::record& waiting, bool arriving);
+
+  // Files a stored ship into its lane, without counting it as an arrival
+  void insert(const ship_store::record& waiting, placement where);
+
+  void note_pop(std::uint64_t order);
+
+  [[nodiscard]] auto key_of(const ship_store::record& waiting,
+                            std::uint64_t arrival_step) const noexcept
+      -> std::int64_t;
+
+  [[nodiscard]] auto lane_empty(const lane& ships) const noexcept -> bool;
+
+  // Lane with the ship next to dock, among those in `accepted`
+  [[nodiscard]] auto best_lane(ship::faction_mask accepted) const noexcept
+      -> std::optional<std::size_t>;
+
+  [[nodiscard]] auto lane_front(const lane& ships) const noexcept
+      -> const ship_store::record&;
+
+public:
+
+  /* {{{ doc */
+  /**
+   * @brief Constructs an empty queue.
+   *
+   * @param order Policy ships are handed out in.
+   *
+   * @param split_by_faction Whether ships may be asked for by faction,
+   * with `pop(accepted)`. Without it, `accepted` is ignored.
+   */
+  /* }}} */
+  explicit ship_queue(policy order = policy::fifo,
+                      bool split_by_faction = false) noexcept
+      : m_policy {order}
+      , m_split {split_by_faction}
+  {}
+
+  /* {{{ doc */
+  /**
+   * @brief Adds ships to the queue, moving them out of [first, last).
+   *
+   * @param arrival_step Time step the ships arrived in, for policies
+   * which take waiting time into account.
+   */
+  /* }}} */
+  void push(std::vector<ship>::iterator first,
+            std::vector<ship>::iterator last, std::uint64_t arrival_step);
+
+  /* {{{ doc */
+  /**
+   * @brief Removes and returns the ship which is next to dock. The queue
+   * must not be empty.
+   */
+  /* }}} */
+  auto pop() noexcept -> ship;
+
+  /* {{{ doc */
+  /**
+   * @brief Removes and returns the ship which is next to dock, among the
+   * ships of the factions in `accepted`, if the queue is split by
+   * faction.
+   *
+   * @return The ship, or nothing if no ship of those factions waits.
+   */
+  /* }}} */
+  auto pop(ship::faction_mask accepted) noexcept -> std::optional<ship>;
+
+  /* {{{ doc */
+  /**
+   * @brief Record of the ship which is next to dock. The queue must not
+   * be empty.
+   */
+  /* }}} */
+  [[nodiscard]] auto front() const noexcept -> const ship_store::record&;
+
+  /* {{{ doc */
+  /**
+   * @brief Record of the most recent arrival still waiting. The queue
+   * must not be empty.
+   */
+  /* }}} */
+  [[nodiscard]] auto back() const noexcept -> const ship_store::record&;
+
+  [[nodiscard]] inline auto size() const noexcept -> std::size_t
+  {
+    return m_size;
+  }
+
+  [[nodiscard]] inline auto empty() const noexcept -> bool
+  {
+    return this->size() == 0;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Number of waiting ships of one faction.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto size(const ship::faction fact) const noexcept
+      -> std::size_t
+  {
+    return m_faction_sizes[static_cast<std::size_t>(fact)];
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Sum of the repair times of every waiting ship, in hours at
+   * a bay of speed 1.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto repair_hours() const noexcept -> std::uint64_t
+  {
+    return m_repair_hours;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Ships which would be handed out before `arriving`, if it
+   * joined the queue now and no more ships followed it, in O(log n).
+   *
+   * Exact under every policy but aging, under which every waiting ship
+   * is counted, and if split by faction, which ships each bay accepts
+   * is not taken into account.
+   */
+  /* }}} */
+  [[nodiscard]] auto work_ahead(const ship& arriving) const noexcept
+      -> work;
+
+  /* {{{ doc */
+  /**
+   * @brief Number of damaged parts over every waiting ship.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto part_count() const noexcept -> std::uint64_t
+  {
+    return m_part_count;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Bytes the queue has allocated, beyond its own size, including
+   * the pages waiting ships' part lists are kept in. O(1) in the queue
+   * size.
+   */
+  /* }}} */
+  [[nodiscard]] auto memory_footprint() const noexcept -> std::size_t;
+
+  /* {{{ doc */
+  /**
+   * @brief Number of ships ever pushed, which numbers the next arrival.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto arrival_count() const noexcept
+      -> std::uint64_t
+  {
+    return m_arrivals;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Calls `func(placement, record)` for every waiting ship, in no
+   * particular order. O(n) in the queue size.
+   */
+  /* }}} */
+  template <typename F>
+  void for_each_waiting(F&& func) const
+  {
+    for ( const lane& ships : m_lanes ) {
+      if ( m_policy == policy::fifo ) {
+        for ( const arrival& waiting : ships.fifo ) {
+          func(placement {waiting.order, 0}, waiting.waiting);
+        }
+      } else {
+        for ( std::size_t slot {0}; slot != ships.slots.size(); ++slot ) {
+          if ( ships.order.contains(slot) ) {
+            const key& where {ships.order.key(slot)};
+            func(placement {where.second, where.first}, ships.slots[slot]);
+          }
+        }
+      }
+    }
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Damaged parts of a waiting ship.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto parts(const ship_store::record& waiting) const
+      -> part_set
+  {
+    return m_store.parts(waiting);
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Whether to keep track of the ships pushed and popped since
+   * the last `clear_changes()`, at O(1) cost per ship. Turning tracking
+   * on starts with no changes.
+   */
+  /* }}} */
+  void track_changes(bool track) noexcept;
+
+  /* {{{ doc */
+  /**
+   * @brief Forgets every change tracked so far.
+   */
+  /* }}} */
+  void clear_changes() noexcept;
+
+  /* {{{ doc */
+  /**
+   * @brief Calls `func(placement, record)` for every ship pushed since
+   * the last `clear_changes()` which still waits, in order of arrival.
+   */
+  /* }}} */
+  template <typename F>
+  void for_each_pushed(F&& func) const
+  {
+    for ( const pushed_ship& pushed : m_pushed ) {
+      if ( not pushed.popped ) {
+        func(pushed.where, pushed.waiting);
+      }
+    }
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Orders of the ships popped since the last `clear_changes()`
+   * which were pushed before it, in the order they were popped.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto popped() const noexcept
+      -> const std::vector<std::uint64_t>&
+  {
+    return m_popped;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Puts back a ship which waited in a queue with the same
+   * policy and split, where it was. Ships must be restored in order of
+   * arrival, into a queue which nothing has been pushed into, and
+   * finished with `restore_arrival_count()`.
+   */
+  /* }}} */
+  void restore(placement where, ship&& waiting);
+
+  /* {{{ doc */
+  /**
+   * @brief Sets the number of ships ever pushed, which must be more than
+   * the order of any ship restored.
+   */
+  /* }}} */
+  inline void restore_arrival_count(const std::uint64_t count) noexcept
+  {
+    m_arrivals = count;
+  }
+
+  [[nodiscard]] inline auto split_by_faction() const noexcept -> bool
+  {
+    return m_split;
+  }
+
+  [[nodiscard]] inline auto get_policy() const noexcept -> policy
+  {
+    return m_policy;
+  }
+};
+
+#endif
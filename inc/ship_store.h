@@ -0,0 +1,200 @@
+#ifndef SHIP_STORE_H
+#define SHIP_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "constants.h"
+#include "part_set.h"
+#include "ship.h"
+
+/* {{{ doc */
+/**
+ * @brief Holds ships split in two: a 16 byte record of what scheduling
+ * looks at, and the damaged part list, which is only read again once the
+ * ship leaves the store.
+ *
+ * Records are handed back to the caller, to keep in whatever order it
+ * likes, so that ordering ships never touches their part lists. Part
+ * lists are packed, 4 bytes per part, into pages of
+ * `conf::ship_store_page_size` bytes, and found by a 32 bit handle kept
+ * in the record. Pages are filled in order, and each keeps a count of
+ * the ships with parts in it, so once every one of them has been taken
+ * out, the page is recycled for new ships. Ships mostly leave in about
+ * the order they came, so pages rarely stay pinned for long. Handles
+ * reach up to 16 GiB of part lists at the default page size.
+ */
+/* }}} */
+class ship_store
+{
+public:
+
+  /* {{{ doc */
+  /**
+   * @brief Position of a ship's part list: the page in the high bits, and
+   * the offset in the page in the low bits.
+   */
+  /* }}} */
+  using handle = std::uint32_t;
+
+  /* {{{ doc */
+  /**
+   * @brief What scheduling needs to know about a stored ship, and the
+   * handle of its part list. Has the same accessors as `ship`.
+   */
+  /* }}} */
+  class record
+  {
+  private:
+
+    static constexpr unsigned count_bits {13};
+
+    ship::id_type m_id;
+    handle m_parts;
+    std::uint16_t m_hours;
+    // Faction in the high bits, part count in the low bits
+    std::uint16_t m_faction_and_count;
+
+    // Every part count and repair time must fit
+    static_assert(conf::part_id_limit < (1 << count_bits));
+    static_assert(ship::faction_count <= (1U << (16 - count_bits)));
+    static_assert(conf::severity_to_time(conf::part_id_limit * 255)
+                  <= std::numeric_limits<std::uint16_t>::max());
+
+  public:
+
+    record() noexcept
+        : record(0, 0, ship::faction::human, 0, 0)
+    {}
+
+    record(const ship::id_type id, const handle parts,
+           const ship::faction fact, const std::size_t part_count,
+           const int hours) noexcept
+        : m_id {id}
+        , m_parts {parts}
+        , m_hours {static_cast<std::uint16_t>(hours)}
+        , m_faction_and_count {static_cast<std::uint16_t>(
+              (static_cast<unsigned>(fact) << count_bits) | part_count)}
+    {}
+
+    [[nodiscard]] inline auto get_id() const noexcept -> ship::id_type
+    {
+      return m_id;
+    }
+
+    [[nodiscard]] inline auto get_faction() const noexcept
+        -> ship::faction
+    {
+      return static_cast<ship::faction>(m_faction_and_count
+                                        >> count_bits);
+    }
+
+    [[nodiscard]] inline auto get_damaged_part_count() const noexcept
+        -> std::size_t
+    {
+      return m_faction_and_count & ((1U << count_bits) - 1);
+    }
+
+    [[nodiscard]] inline auto repair_time() const noexcept -> int
+    {
+      return m_hours;
+    }
+
+    [[nodiscard]] inline auto parts() const noexcept -> handle
+    {
+      return m_parts;
+    }
+
+    inline void display(std::ostream& out) const noexcept
+    {
+      ship::display(out, m_id, this->get_faction(),
+                    this->get_damaged_part_count(), this->repair_time());
+    }
+  };
+
+  static_assert(sizeof(record) == 16);
+
+private:
+
+  static constexpr std::size_t page_words {conf::ship_store_page_size
+                                           / sizeof(std::uint32_t)};
+
+  static constexpr unsigned offset_bits {[]() {
+    unsigned bits {0};
+    while ( (std::size_t {1} << bits) < page_words ) {
+      ++bits;
+    }
+    return bits;
+  }()};
+
+  static_assert(page_words
+                    >= static_cast<std::size_t>(conf::part_id_limit),
+                "A page must hold the longest part list");
+  static_assert(offset_bits < 32);
+
+  // One word per part: the ID above the damage byte
+  std::vector<std::vector<std::uint32_t>> m_pages {};
+  // Ships with parts in each page
+  std::vector<std::size_t> m_live {};
+  std::vector<std::size_t> m_free_pages {};
+  std::size_t m_page {0};
+  std::size_t m_fill {page_words};
+
+  // Moves on to an empty page
+  void next_page();
+
+public:
+
+  /* {{{ doc */
+  /**
+   * @brief Takes in a ship, keeping its part list.
+   *
+   * @return Record of the ship, which `take()` turns back into the ship.
+   */
+  /* }}} */
+  auto store(ship&& src) -> record;
+
+  /* {{{ doc */
+  /**
+   * @brief Rebuilds a stored ship, and frees its part list. Each record
+   * must only be taken once.
+   */
+  /* }}} */
+  auto take(const record& stored) -> ship;
+
+  /* {{{ doc */
+  /**
+   * @brief Part list of a stored ship, without taking it out.
+   */
+  /* }}} */
+  [[nodiscard]] auto parts(const record& stored) const -> part_set;
+
+  /* {{{ doc */
+  /**
+   * @brief Number of pages allocated, recycled or not.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto page_count() const noexcept -> std::size_t
+  {
+    return m_pages.size();
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Bytes the store has allocated, beyond its own size.
+   */
+  /* }}} */
+  [[nodiscard]] auto memory_footprint() const noexcept -> std::size_t;
+};
+
+inline auto operator<<(std::ostream& out, const ship_store::record& rhs)
+    noexcept -> std::ostream&
+{
+  rhs.display(out);
+  return out;
+}
+
+#endif
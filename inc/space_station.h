@@ -1,17 +1,26 @@
 #ifndef SPACE_STATION_H
 #define SPACE_STATION_H
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <iostream>
-#include <queue>
+#include <memory>
+#include <numeric>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 
+#include "utils/thread_pool.hpp"
+
+#include "arrival_generator.h"
 #include "constants.h"
 #include "repair_bay.h"
 #include "ship.h"
+#include "ship_queue.h"
 
 // NOLINTNEXTLINE(cppcoreguidelines-special-member-functions)
 class space_station
@@ -23,26 +32,207 @@ public:
     std::size_t leaving_ships;
   };
 
+  /* {{{ doc */
+  /**
+   * @brief One part finished by a bay which tracks parts.
+   */
+  /* }}} */
+  struct part_event {
+    std::size_t bay;
+    ship::id_type ship_id;
+    int part_id;
+  };
+
+  /* {{{ doc */
+  /**
+   * @brief Hours in which a ship is expected to dock, and to leave.
+   */
+  /* }}} */
+  struct prediction {
+    std::uint64_t dock_hour;
+    std::uint64_t departure_hour;
+  };
+
+  /* {{{ doc */
+  /**
+   * @brief How far predicted dock hours were from the actual ones, over
+   * every ship predicted and docked so far. Errors are actual minus
+   * predicted, in hours.
+   */
+  /* }}} */
+  struct prediction_stats {
+    std::uint64_t ships {0};
+    std::int64_t total_error {0};
+    std::uint64_t total_abs_error {0};
+    std::uint64_t max_abs_error {0};
+
+    [[nodiscard]] inline auto mean_error() const noexcept -> double
+    {
+      return ships == 0 ? 0.0
+                        : static_cast<double>(total_error)
+                              / static_cast<double>(ships);
+    }
+
+    [[nodiscard]] inline auto mean_abs_error() const noexcept -> double
+    {
+      return ships == 0 ? 0.0
+                        : static_cast<double>(total_abs_error)
+                              / static_cast<double>(ships);
+    }
+  };
+
+  /* {{{ doc */
+  /**
+   * @brief Everything about a station's history which is not in its
+   * bays, queue or arrivals, as needed to restore it.
+   */
+  /* }}} */
+  struct counters {
+    std::size_t step_count;
+    std::uint64_t queue_arrivals;
+    std::uint64_t docked_ships;
+    std::uint64_t docked_ship_hours;
+    std::uint64_t docked_bay_hours;
+    prediction_stats predictions;
+    step_summary last_step;
+  };
+
 private:
 
   std::vector<repair_bay> m_bays;
 
-  // Only using a deque instead of a queue so that I can
-  // print it to the output
-  std::queue<ship> m_repair_queue;
+  // Hour each bay last docked a ship in
+  std::vector<std::uint64_t> m_bay_dock_hours;
+
+  // Only kept while tracking changes, the bays which have docked a ship
+  // since the last clear_changes()
+  bool m_track_changes {false};
+  std::vector<std::size_t> m_changed_bays {};
+  std::vector<bool> m_bay_changed {};
+
+  // Only for stations large enough to step their bays in parallel
+  std::unique_ptr<ehanc::thread_pool> m_pool {};
+
+  // Per shard of bays, its index, the bays left empty by stepping, in
+  // order, and how many ships left
+  std::vector<std::size_t> m_shard_ids {};
+  std::vector<std::vector<std::size_t>> m_shard_empty_bays {};
+  std::vector<std::size_t> m_shard_leaving {};
+  std::vector<std::vector<part_event>> m_shard_part_events {};
+
+  // Whether any bay tracks parts, and the parts finished in the last
+  // step, in bay order
+  bool m_track_parts;
+  std::vector<part_event> m_part_events {};
+
+  // Min-heap of the hours in which busy bays free up, and their sum,
+  // kept for predict()
+  std::vector<std::uint64_t> m_bay_free_hours {};
+  std::uint64_t m_bay_free_hour_sum {0};
+
+  // Repair hours of every ship docked so far, at speed 1 and at the bay
+  // it docked in, which give how long bays really take, rounding and
+  // all. Until a ship docks, the mean bay speed stands in.
+  std::uint64_t m_docked_ships {0};
+  std::uint64_t m_docked_ship_hours {0};
+  std::uint64_t m_docked_bay_hours {0};
+  double m_mean_bay_speed {1.0};
+
+  // Hours a bay takes per repair hour at speed 1
+  [[nodiscard]] auto bay_hours_per_hour() const noexcept -> double;
+
+  // Predicted dock hour of every waiting ship, if checking predictions
+  bool m_check_predictions {false};
+  std::unordered_map<ship::id_type, std::uint64_t> m_predicted_docks {};
+  prediction_stats m_prediction_stats {};
+
+  ship_queue m_repair_queue;
+  arrival_generator m_arrivals;
   std::size_t m_step_count;
   step_summary m_last_step_summary;
   std::string m_name {"Zebra"};
 
+  void dock_next(repair_bay& bay) noexcept;
+
+  // Drops bays which have freed up by the end of the current step
+  void prune_bay_free_hours() noexcept;
+
+  // Smallest hour in the heap but `rank`, in O(rank log rank)
+  [[nodiscard]] auto nth_bay_free_hour(std::size_t rank) const
+      -> std::uint64_t;
+
+  static void add_part_events(std::size_t index, const repair_bay& bay,
+                              std::vector<part_event>& events) noexcept;
+
+  // Step every bay, docking ships into empty ones, and return how many
+  // ships left
+  auto step_bays() noexcept -> std::size_t;
+  auto step_bays_sharded() noexcept -> std::size_t;
+
 public:
 
-  space_station(std::string_view name,
-                std::size_t bay_count = conf::num_repair_bays) noexcept
-      : m_bays(bay_count)
-      , m_repair_queue {}
+  /* {{{ doc */
+  /**
+   * @brief Constructs a station with a bay for each spec in `bays`, in
+   * order.
+   *
+   * @param parallel_min_bays Least number of bays for which bays are
+   * stepped in parallel. Results are the same either way.
+   */
+  /* }}} */
+  space_station(
+      std::string_view name, const std::vector<bay_spec>& bays,
+      ship_queue::policy order = ship_queue::policy::fifo,
+      std::size_t parallel_min_bays = conf::parallel_bay_threshold)
+      noexcept
+      : m_bays(bays.cbegin(), bays.cend())
+      , m_bay_dock_hours(bays.size(), 0)
+      , m_track_parts {std::any_of(bays.cbegin(), bays.cend(),
+                                   [](const bay_spec& spec) {
+                                     return spec.track_parts;
+                                   })}
+      , m_repair_queue {order,
+                        std::any_of(bays.cbegin(), bays.cend(),
+                                    [](const bay_spec& spec) {
+                                      return spec.factions
+                                             != ship::every_faction;
+                                    })}
+      , m_arrivals {}
       , m_step_count {}
       , m_last_step_summary {}
       , m_name(name)
+  {
+    if ( m_bays.size() >= parallel_min_bays ) {
+      m_pool = std::make_unique<ehanc::thread_pool>();
+
+      const std::size_t shard_count {
+          (m_bays.size() + conf::bay_shard_size - 1)
+          / conf::bay_shard_size};
+      m_shard_ids.resize(shard_count);
+      std::iota(m_shard_ids.begin(), m_shard_ids.end(), std::size_t {0});
+      m_shard_empty_bays.resize(shard_count);
+      m_shard_leaving.resize(shard_count);
+      m_shard_part_events.resize(shard_count);
+    }
+
+    if ( not m_bays.empty() ) {
+      double speed_sum {0.0};
+      for ( const bay_spec& spec : bays ) {
+        speed_sum += spec.speed;
+      }
+      m_mean_bay_speed = speed_sum / static_cast<double>(m_bays.size());
+    }
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Constructs a station with `bay_count` ordinary bays.
+   */
+  /* }}} */
+  space_station(
+      std::string_view name, std::size_t bay_count = conf::num_repair_bays,
+      ship_queue::policy order = ship_queue::policy::fifo) noexcept
+      : space_station(name, std::vector<bay_spec>(bay_count), order)
   {}
 
   /* {{{ doc */
@@ -79,11 +269,37 @@ public:
   /**
    * @brief Simulate one time step. New ships are generated,
    * all occupied bays tick down, bays clear out if done, empty bays
-   * accept the next in line, in that order.
+   * accept the next in line, as chosen by the queue policy, in that
+   * order.
    */
   /* }}} */
   auto step() noexcept -> step_summary;
 
+  /* {{{ doc */
+  /**
+   * @brief Simulate one time step with externally supplied arrivals.
+   * Arrivals are moved out of [first, last) into the back of the queue
+   * in one bulk insertion; otherwise identical to `step()`.
+   *
+   * @param first Beginning of this time step's arrivals.
+   *
+   * @param last End of this time step's arrivals.
+   */
+  /* }}} */
+  auto step(std::vector<ship>::iterator first,
+            std::vector<ship>::iterator last) noexcept -> step_summary;
+
+  /* {{{ doc */
+  /**
+   * @brief Return the policy ships are docked in order of.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto queue_policy() const noexcept
+      -> ship_queue::policy
+  {
+    return m_repair_queue.get_policy();
+  }
+
   /* {{{ doc */
   /**
    * @brief Return size of internal queue.
@@ -94,6 +310,76 @@ public:
     return m_repair_queue.size();
   }
 
+  /* {{{ doc */
+  /**
+   * @brief Return number of queued ships of one faction.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto queue_size(const ship::faction fact) const
+      noexcept -> std::size_t
+  {
+    return m_repair_queue.size(fact);
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Return repair hours waiting in the queue, at a bay of speed
+   * 1.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto queue_repair_hours() const noexcept
+      -> std::uint64_t
+  {
+    return m_repair_queue.repair_hours();
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Return number of damaged parts on queued ships.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto queue_part_count() const noexcept
+      -> std::uint64_t
+  {
+    return m_repair_queue.part_count();
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Predicts when a ship arriving in the next step would dock and
+   * leave, from the work queued ahead of it and when each bay frees up,
+   * assuming no more ships arrive after it. O(log n) in the queue size.
+   *
+   * While fewer ships wait ahead of it than there are bays, each is
+   * assumed to take the next bay to free up, and the ship the one after.
+   * Otherwise the bays are assumed to share the work ahead of it evenly,
+   * and the ship to dock while the other bays are halfway through a
+   * repair. Repairs are assumed to take as long, relative to their
+   * repair time at speed 1, as those docked so far.
+   */
+  /* }}} */
+  [[nodiscard]] auto predict(const ship& arriving) const -> prediction;
+
+  /* {{{ doc */
+  /**
+   * @brief Whether to predict when every arriving ship docks, and
+   * compare it with when it actually does, in `prediction_accuracy()`.
+   */
+  /* }}} */
+  inline void check_predictions(const bool check) noexcept
+  {
+    m_check_predictions = check;
+    if ( not check ) {
+      m_predicted_docks.clear();
+    }
+  }
+
+  [[nodiscard]] inline auto prediction_accuracy() const noexcept
+      -> const prediction_stats&
+  {
+    return m_prediction_stats;
+  }
+
   /* {{{ doc */
   /**
    * @brief Returns number of time steps that have occured.
@@ -104,8 +390,133 @@ public:
     return m_step_count;
   }
 
+  /* {{{ doc */
+  /**
+   * @brief Returns every part finished in the most recent time step, in
+   * bay order. Always empty unless some bay tracks parts.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto last_part_events() const noexcept
+      -> const std::vector<part_event>&
+  {
+    return m_part_events;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Returns the summary of the most recent time step.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto last_step_summary() const noexcept
+      -> const step_summary&
+  {
+    return m_last_step_summary;
+  }
+
   void display(std::ostream& out) const noexcept;
 
+  [[nodiscard]] inline auto bays() const noexcept
+      -> const std::vector<repair_bay>&
+  {
+    return m_bays;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Hour in which bay `index` last docked a ship, or 0 if it never
+   * has.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto bay_dock_hour(const std::size_t index) const
+      noexcept -> std::uint64_t
+  {
+    return m_bay_dock_hours[index];
+  }
+
+  [[nodiscard]] inline auto queue() const noexcept -> const ship_queue&
+  {
+    return m_repair_queue;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Generator of the arrivals `step()` takes.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto arrivals() noexcept -> arrival_generator&
+  {
+    return m_arrivals;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Dock hour predicted for a waiting ship, if checking
+   * predictions and it was predicted.
+   */
+  /* }}} */
+  [[nodiscard]] auto predicted_dock(ship::id_type id) const noexcept
+      -> std::optional<std::uint64_t>;
+
+  [[nodiscard]] auto get_counters() const noexcept -> counters;
+
+  /* {{{ doc */
+  /**
+   * @brief Whether to keep track of the bays which dock ships, and the
+   * ships pushed into and popped from the queue, since the last
+   * `clear_changes()`, at O(1) cost per change. Turning tracking on
+   * starts with no changes.
+   */
+  /* }}} */
+  void track_changes(bool track) noexcept;
+
+  /* {{{ doc */
+  /**
+   * @brief Forgets every change tracked so far. O(number of changes).
+   */
+  /* }}} */
+  void clear_changes() noexcept;
+
+  /* {{{ doc */
+  /**
+   * @brief Bays which have docked a ship since the last
+   * `clear_changes()`, while tracking changes.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto changed_bays() const noexcept
+      -> const std::vector<std::size_t>&
+  {
+    return m_changed_bays;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Restores a station saved after `counters.step_count` steps
+   * into this one, which must be newly constructed with the same bays
+   * and policy. Counters are restored first, then the bays, then the
+   * waiting ships in order of arrival.
+   */
+  /* }}} */
+  void restore_counters(const counters& saved) noexcept;
+
+  /* {{{ doc */
+  /**
+   * @brief Redocks the ship which bay `index` docked in `dock_hour`, and
+   * repairs it up to the current step, as the bay did. The bay ends up
+   * empty if the ship has left since.
+   */
+  /* }}} */
+  void restore_bay(std::size_t index, ship&& docked,
+                   std::uint64_t dock_hour) noexcept;
+
+  /* {{{ doc */
+  /**
+   * @brief Puts a waiting ship back in the queue, along with the dock
+   * hour predicted for it, if any, if checking predictions.
+   */
+  /* }}} */
+  void restore_waiting(ship_queue::placement where, ship&& waiting,
+                       std::optional<std::uint64_t> predicted);
+
   /* {{{ doc */
   /**
    * @brief Return number of empty repair bays.
@@ -119,6 +530,22 @@ public:
    */
   /* }}} */
   [[nodiscard]] auto occupied_bay_count() const noexcept -> int;
+
+  /* {{{ doc */
+  /**
+   * @brief Return the sum of the repair time remaining in every bay.
+   */
+  /* }}} */
+  [[nodiscard]] auto total_bay_time_remaining() const noexcept -> long;
+
+  /* {{{ doc */
+  /**
+   * @brief Bytes the station has allocated, beyond its own size: its
+   * bays, queue and arrivals, and every ship in them. O(number of bays),
+   * but not dependent on the queue size.
+   */
+  /* }}} */
+  [[nodiscard]] auto memory_footprint() const noexcept -> std::size_t;
 };
 
 #endif
@@ -5,9 +5,14 @@
 #include <cstddef>
 #include <functional>
 #include <iterator>
+#include <limits>
 #include <type_traits>
 #include <utility>
 
+#include "utils/execution.hpp"
+#include "utils/metaprogramming.hpp"
+#include "utils/simd.hpp"
+
 namespace ehanc {
 
 /* {{{ doc */
@@ -100,6 +105,23 @@ constexpr auto max_size(const Container& cont,
   return std::max(::ehanc::max_size(cont), ::ehanc::max_size(conts...));
 }
 
+/* {{{ doc */
+/**
+ * @brief Determines if any element of [begin, end) equals `value`.
+ *
+ * Contiguous ranges of integers and floating point values are searched
+ * with `simd_contains()`, where the build enables vector instructions.
+ * Any other range is searched with `std::find`.
+ *
+ * @tparam Itr Input iterator.
+ *
+ * @param begin Iterator to the beginning of the range.
+ *
+ * @param end Iterator to the end of the range.
+ *
+ * @param value Value to search for.
+ */
+/* }}} */
 template <typename Itr>
 constexpr auto
 contains(const Itr begin, const Itr end,
@@ -107,7 +129,18 @@ contains(const Itr begin, const Itr end,
              value) noexcept(noexcept(std::find(begin, end, value)))
     -> bool
 {
-  return std::find(begin, end, value) != end;
+  using value_t = typename std::iterator_traits<Itr>::value_type;
+
+  if constexpr ( ::ehanc::is_contiguous_v<Itr>
+                 && ::ehanc::has_simd_contains_v<value_t> ) {
+    if ( begin == end ) {
+      return false;
+    }
+    const value_t* const first {&*begin};
+    return ::ehanc::simd_contains(first, first + (end - begin), value);
+  } else {
+    return std::find(begin, end, value) != end;
+  }
 }
 
 /* {{{ doc */
@@ -411,6 +444,292 @@ for_each_all_c(VarFunc&& func, const Containers&... containers) noexcept(
                           std::cbegin(containers)...);
 }
 
+/* {{{ doc */
+/**
+ * @brief Same as `for_each_adjacent` without a policy.
+ */
+/* }}} */
+template <typename Itr, typename BinaryFunc>
+constexpr void for_each_adjacent(
+    [[maybe_unused]] const execution::sequenced_policy policy,
+    const Itr begin, const Itr end,
+    BinaryFunc&& func) noexcept(noexcept(func(*begin, *begin)))
+{
+  ::ehanc::for_each_adjacent(begin, end, std::forward<BinaryFunc>(func));
+}
+
+/* {{{ doc */
+/**
+ * @brief Applies `func` to each adjacent pair of elements, as
+ * `for_each_adjacent` does, with pairs split into chunks across the
+ * policy's pool. Ranges which are not random access are run in order on
+ * the calling thread. Unlike the overload without a policy, an empty
+ * range is allowed.
+ */
+/* }}} */
+template <typename Itr, typename BinaryFunc>
+inline void for_each_adjacent(const execution::parallel_policy policy,
+                              const Itr begin, const Itr end,
+                              BinaryFunc&& func)
+{
+  if constexpr ( ::ehanc::is_random_access_v<Itr> ) {
+    if ( begin == end ) {
+      return;
+    }
+    const auto pairs {static_cast<std::size_t>(end - begin) - 1};
+    const auto run_chunk {[&](const std::size_t first,
+                               const std::size_t last) {
+      ::ehanc::for_each_adjacent_n(
+          std::next(begin, static_cast<long>(first)), end, last - first,
+          func);
+    }};
+    impl::run_chunked(policy, pairs, run_chunk);
+  } else {
+    ::ehanc::for_each_adjacent(begin, end, std::forward<BinaryFunc>(func));
+  }
+}
+
+/* {{{ doc */
+/**
+ * @brief Forwarding function alias for for_each_adjacent following rename.
+ *
+ * @deprecated Renamed to `for_each_adjacent`.
+ */
+/* }}} */
+template <typename Policy, typename Itr, typename BinaryFunc,
+          std::enable_if_t<execution::is_execution_policy_v<Policy>, int> =
+              0>
+[[deprecated("Use for_each_adjacent")]] inline void
+for_each_pair(Policy&& policy, Itr&& begin, Itr&& end, BinaryFunc&& func)
+{
+  ::ehanc::for_each_adjacent(
+      std::forward<Policy>(policy), std::forward<Itr>(begin),
+      std::forward<Itr>(end), std::forward<BinaryFunc>(func));
+}
+
+/* {{{ doc */
+/**
+ * @brief Same as `for_each_adjacent_n` without a policy.
+ */
+/* }}} */
+template <typename Itr, typename BinaryFunc>
+constexpr void for_each_adjacent_n(
+    [[maybe_unused]] const execution::sequenced_policy policy,
+    const Itr begin, const Itr end, const std::size_t n,
+    BinaryFunc&& func) noexcept(noexcept(func(*begin, *begin)))
+{
+  ::ehanc::for_each_adjacent_n(begin, end, n,
+                               std::forward<BinaryFunc>(func));
+}
+
+/* {{{ doc */
+/**
+ * @brief Applies `func` to at most `n` adjacent pairs, as
+ * `for_each_adjacent_n` does, split into chunks across the policy's pool.
+ */
+/* }}} */
+template <typename Itr, typename BinaryFunc>
+inline void for_each_adjacent_n(const execution::parallel_policy policy,
+                                const Itr begin, const Itr end,
+                                const std::size_t n, BinaryFunc&& func)
+{
+  if constexpr ( ::ehanc::is_random_access_v<Itr> ) {
+    if ( begin == end ) {
+      return;
+    }
+    const std::size_t pairs {
+        std::min(n, static_cast<std::size_t>(end - begin) - 1)};
+    ::ehanc::for_each_adjacent(
+        policy, begin, std::next(begin, static_cast<long>(pairs + 1)),
+        std::forward<BinaryFunc>(func));
+  } else {
+    ::ehanc::for_each_adjacent_n(begin, end, n,
+                                 std::forward<BinaryFunc>(func));
+  }
+}
+
+/* {{{ doc */
+/**
+ * @brief Same as `for_each_both` without a policy.
+ */
+/* }}} */
+template <typename Itr1, typename Itr2, typename BinaryFunc>
+constexpr void
+for_each_both([[maybe_unused]] const execution::sequenced_policy policy,
+              const Itr1 begin1, const Itr1 end1, const Itr2 begin2,
+              const Itr2 end2,
+              BinaryFunc&& func) noexcept(noexcept(func(*begin1, *begin2)))
+{
+  ::ehanc::for_each_both(begin1, end1, begin2, end2,
+                         std::forward<BinaryFunc>(func));
+}
+
+/* {{{ doc */
+/**
+ * @brief Same as `for_each_both_n` without a policy.
+ */
+/* }}} */
+template <typename Itr1, typename Itr2, typename BinaryFunc>
+constexpr void for_each_both_n(
+    [[maybe_unused]] const execution::sequenced_policy policy,
+    const Itr1 begin1, const Itr1 end1, const Itr2 begin2,
+    const Itr2 end2, const std::size_t n,
+    BinaryFunc&& func) noexcept(noexcept(func(*begin1, *begin2)))
+{
+  ::ehanc::for_each_both_n(begin1, end1, begin2, end2, n,
+                           std::forward<BinaryFunc>(func));
+}
+
+/* {{{ doc */
+/**
+ * @brief Applies `func` to at most `n` corresponding pairs, as
+ * `for_each_both_n` does, split into chunks across the policy's pool.
+ * Unless both ranges are random access, they are run in order on the
+ * calling thread.
+ */
+/* }}} */
+template <typename Itr1, typename Itr2, typename BinaryFunc>
+inline void for_each_both_n(const execution::parallel_policy policy,
+                            const Itr1 begin1, const Itr1 end1,
+                            const Itr2 begin2, const Itr2 end2,
+                            const std::size_t n, BinaryFunc&& func)
+{
+  if constexpr ( ::ehanc::is_random_access_v<Itr1>
+                 && ::ehanc::is_random_access_v<Itr2> ) {
+    const std::size_t count {
+        std::min({n, static_cast<std::size_t>(end1 - begin1),
+                  static_cast<std::size_t>(end2 - begin2)})};
+    const auto run_chunk {[&](const std::size_t first,
+                               const std::size_t last) {
+      const auto offset {static_cast<long>(first)};
+      ::ehanc::for_each_both_n(std::next(begin1, offset), end1,
+                               std::next(begin2, offset), end2,
+                               last - first, func);
+    }};
+    impl::run_chunked(policy, count, run_chunk);
+  } else {
+    ::ehanc::for_each_both_n(begin1, end1, begin2, end2, n,
+                             std::forward<BinaryFunc>(func));
+  }
+}
+
+/* {{{ doc */
+/**
+ * @brief Applies `func` to each corresponding pair, as `for_each_both`
+ * does, split into chunks across the policy's pool.
+ */
+/* }}} */
+template <typename Itr1, typename Itr2, typename BinaryFunc>
+inline void for_each_both(const execution::parallel_policy policy,
+                          const Itr1 begin1, const Itr1 end1,
+                          const Itr2 begin2, const Itr2 end2,
+                          BinaryFunc&& func)
+{
+  ::ehanc::for_each_both_n(policy, begin1, end1, begin2, end2,
+                           std::numeric_limits<std::size_t>::max(),
+                           std::forward<BinaryFunc>(func));
+}
+
+/* {{{ doc */
+/**
+ * @brief Same as `for_each_all_n` without a policy.
+ */
+/* }}} */
+template <typename VarFunc, typename... Begins>
+constexpr void
+for_each_all_n([[maybe_unused]] const execution::sequenced_policy policy,
+               VarFunc&& func, const std::size_t n,
+               Begins... begins) noexcept(noexcept(func(*begins...)))
+{
+  ::ehanc::for_each_all_n(std::forward<VarFunc>(func), n, begins...);
+}
+
+/* {{{ doc */
+/**
+ * @brief Applies `func` to members of all containers in parameter order,
+ * as `for_each_all_n` does, split into chunks across the policy's pool.
+ * Unless every iterator is random access, the containers are run in
+ * order on the calling thread.
+ */
+/* }}} */
+template <typename VarFunc, typename... Begins>
+inline void for_each_all_n(const execution::parallel_policy policy,
+                           VarFunc&& func, const std::size_t n,
+                           Begins... begins)
+{
+  if constexpr ( (::ehanc::is_random_access_v<Begins> && ...) ) {
+    const auto run_chunk {[&](const std::size_t first,
+                               const std::size_t last) {
+      const auto offset {static_cast<long>(first)};
+      ::ehanc::for_each_all_n(func, last - first,
+                              std::next(begins, offset)...);
+    }};
+    impl::run_chunked(policy, n, run_chunk);
+  } else {
+    ::ehanc::for_each_all_n(std::forward<VarFunc>(func), n, begins...);
+  }
+}
+
+/* {{{ doc */
+/**
+ * @brief Same as `for_each_all` without a policy.
+ */
+/* }}} */
+template <typename VarFunc, typename... Containers>
+constexpr void
+for_each_all([[maybe_unused]] const execution::sequenced_policy policy,
+             VarFunc&& func, Containers&... containers) noexcept(
+    noexcept(func(*std::begin(containers)...)))
+{
+  ::ehanc::for_each_all(std::forward<VarFunc>(func), containers...);
+}
+
+/* {{{ doc */
+/**
+ * @brief Applies `func` to members of all containers in parameter order,
+ * as `for_each_all` does, split into chunks across the policy's pool.
+ */
+/* }}} */
+template <typename VarFunc, typename... Containers>
+inline void for_each_all(const execution::parallel_policy policy,
+                         VarFunc&& func, Containers&... containers)
+{
+  ::ehanc::for_each_all_n(policy, std::forward<VarFunc>(func),
+                          ::ehanc::min_size(containers...),
+                          std::begin(containers)...);
+}
+
+/* {{{ doc */
+/**
+ * @brief Same as `for_each_all_c` without a policy.
+ */
+/* }}} */
+template <typename VarFunc, typename... Containers>
+constexpr void
+for_each_all_c([[maybe_unused]] const execution::sequenced_policy policy,
+               VarFunc&& func, const Containers&... containers) noexcept(
+    noexcept(func(*std::cbegin(containers)...)))
+{
+  ::ehanc::for_each_all_c(std::forward<VarFunc>(func), containers...);
+}
+
+/* {{{ doc */
+/**
+ * @brief Applies `func` to members of all containers in parameter order,
+ * as `for_each_all_c` does, split into chunks across the policy's pool.
+ * Ensures the containers are not modified.
+ */
+/* }}} */
+template <typename VarFunc, typename... Containers>
+inline void for_each_all_c(const execution::parallel_policy policy,
+                           VarFunc&& func,
+                           const Containers&... containers)
+{
+  ::ehanc::for_each_all_n(policy, std::forward<VarFunc>(func),
+                          ::ehanc::min_size(containers...),
+                          std::cbegin(containers)...);
+}
+
 namespace impl {
 
 /* {{{ doc */
@@ -493,6 +812,46 @@ generate(Itr begin, const Itr end,
   }
 }
 
+/* {{{ doc */
+/**
+ * @brief Same as `generate` without a policy.
+ */
+/* }}} */
+template <typename Itr, typename Gen>
+constexpr void
+generate([[maybe_unused]] const execution::sequenced_policy policy,
+         const Itr begin, const Itr end,
+         Gen&& gen) noexcept(noexcept(gen()) && noexcept(*begin))
+{
+  ::ehanc::generate(begin, end, std::forward<Gen>(gen));
+}
+
+/* {{{ doc */
+/**
+ * @brief Assigns the result of `gen()` to every element, as `generate`
+ * does, split into chunks across the policy's pool. Elements are
+ * generated in no particular order, so `gen` must not depend on it.
+ * Ranges which are not random access are run in order on the calling
+ * thread.
+ */
+/* }}} */
+template <typename Itr, typename Gen>
+inline void generate(const execution::parallel_policy policy,
+                     const Itr begin, const Itr end, Gen&& gen)
+{
+  if constexpr ( ::ehanc::is_random_access_v<Itr> ) {
+    const auto run_chunk {[&](const std::size_t first,
+                               const std::size_t last) {
+      ::ehanc::generate(std::next(begin, static_cast<long>(first)),
+                        std::next(begin, static_cast<long>(last)), gen);
+    }};
+    impl::run_chunked(policy, static_cast<std::size_t>(end - begin),
+                      run_chunk);
+  } else {
+    ::ehanc::generate(begin, end, std::forward<Gen>(gen));
+  }
+}
+
 } // namespace bkprt
 
 } // namespace ehanc
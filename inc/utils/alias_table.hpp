@@ -0,0 +1,324 @@
+#ifndef EHANC_UTILS_ALIAS_TABLE_HPP
+#define EHANC_UTILS_ALIAS_TABLE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <type_traits>
+
+#include "utils/bounded_int.hpp"
+
+namespace ehanc {
+
+/* {{{ doc */
+/**
+ * @brief Weighted categorical sampler built with Vose's alias method.
+ *
+ * Each of the `N` categories owns one column of capacity equal to the
+ * sum of all weights. A column is filled first by its own category
+ * and topped up by a single "alias" category, so a draw takes one
+ * uniform integer in `[0, N * total)`: the quotient picks the column,
+ * and the remainder picks between the column's owner and its alias.
+ * All arithmetic is integral, so sampled probabilities are exactly
+ * `weight / total`.
+ *
+ * The constructor is `constexpr`, so tables for compiled-in weights are
+ * built at compile time, while tables for run-time weights are built
+ * with the very same code.
+ *
+ * @tparam N Number of categories.
+ */
+/* }}} */
+template <std::size_t N>
+class alias_table
+{
+private:
+
+  static_assert(N != 0, "alias_table requires at least one category");
+
+  // Draws less than m_threshold[column] select the column itself
+  std::array<std::uint64_t, N> m_threshold {};
+  std::array<std::size_t, N> m_alias {};
+  std::uint64_t m_total {};
+
+  // log2(m_total) if m_total is a power of two, letting draws be split
+  // by shifting and masking instead of dividing. Otherwise 0.
+  unsigned m_total_shift {};
+
+public:
+
+  /* {{{ doc */
+  /**
+   * @brief Builds the table from a set of integral weights.
+   *
+   * @tparam Weight Integral weight type.
+   *
+   * @param weights Non-negative weight of each category.
+   * The sum of weights must be nonzero.
+   */
+  /* }}} */
+  template <typename Weight>
+  constexpr explicit alias_table(
+      const std::array<Weight, N>& weights) noexcept
+  {
+    static_assert(std::is_integral_v<Weight>,
+                  "alias_table weights must be integral");
+
+    for ( const Weight weight : weights ) {
+      m_total += static_cast<std::uint64_t>(weight);
+    }
+
+    // Each category's weight scaled so that a full column is m_total
+    std::array<std::uint64_t, N> scaled {};
+    std::array<std::size_t, N> small {};
+    std::array<std::size_t, N> large {};
+    std::size_t small_count {0};
+    std::size_t large_count {0};
+
+    for ( std::size_t i {0}; i != N; ++i ) {
+      scaled[i] = static_cast<std::uint64_t>(weights[i]) * N;
+      if ( scaled[i] < m_total ) {
+        small[small_count++] = i;
+      } else {
+        large[large_count++] = i;
+      }
+    }
+
+    while ( small_count != 0 && large_count != 0 ) {
+      const std::size_t lesser {small[--small_count]};
+      const std::size_t greater {large[--large_count]};
+
+      m_threshold[lesser] = scaled[lesser];
+      m_alias[lesser]     = greater;
+
+      // greater donated (m_total - scaled[lesser]) to lesser's column
+      scaled[greater] = (scaled[greater] + scaled[lesser]) - m_total;
+
+      if ( scaled[greater] < m_total ) {
+        small[small_count++] = greater;
+      } else {
+        large[large_count++] = greater;
+      }
+    }
+
+    if ( m_total > 1 && (m_total & (m_total - 1)) == 0 ) {
+      while ( (std::uint64_t {1} << m_total_shift) != m_total ) {
+        ++m_total_shift;
+      }
+    }
+
+    // Whatever remains fills its own column completely
+    while ( large_count != 0 ) {
+      const std::size_t index {large[--large_count]};
+      m_threshold[index] = m_total;
+      m_alias[index]     = index;
+    }
+    while ( small_count != 0 ) {
+      const std::size_t index {small[--small_count]};
+      m_threshold[index] = m_total;
+      m_alias[index]     = index;
+    }
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Number of categories.
+   */
+  /* }}} */
+  [[nodiscard]] static constexpr auto size() noexcept -> std::size_t
+  {
+    return N;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Sum of all weights the table was built from.
+   */
+  /* }}} */
+  [[nodiscard]] constexpr auto total_weight() const noexcept
+      -> std::uint64_t
+  {
+    return m_total;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Number of draws, out of `N * total_weight()`, which resolve
+   * to category `index`. Mostly useful for verifying a table.
+   */
+  /* }}} */
+  [[nodiscard]] constexpr auto outcomes(const std::size_t index) const
+      noexcept -> std::uint64_t
+  {
+    std::uint64_t count {0};
+    for ( std::size_t column {0}; column != N; ++column ) {
+      if ( column == index ) {
+        count += m_threshold[column];
+      }
+      if ( m_alias[column] == index ) {
+        count += m_total - m_threshold[column];
+      }
+    }
+    return count;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Maps a raw draw from `[0, N * total_weight())` to a category.
+   */
+  /* }}} */
+  [[nodiscard]] constexpr auto resolve(const std::uint64_t draw) const
+      noexcept -> std::size_t
+  {
+    const auto column {static_cast<std::size_t>(
+        m_total_shift != 0 ? draw >> m_total_shift : draw / m_total)};
+    const std::uint64_t remainder {
+        m_total_shift != 0 ? draw & (m_total - 1) : draw % m_total};
+
+    return remainder < m_threshold[column] ? column : m_alias[column];
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Determines if raw output of `Engine` covers exactly
+   * `[0, N * total_weight())`, in which case engine output is used
+   * as a draw directly, skipping the uniform distribution.
+   */
+  /* }}} */
+  template <typename Engine>
+  [[nodiscard]] constexpr auto spans_engine() const noexcept -> bool
+  {
+    return static_cast<std::uint64_t>(Engine::max() - Engine::min())
+           == (m_total * N) - 1;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Draws a single category index in O(1).
+   *
+   * @param gen Uniform random bit generator.
+   */
+  /* }}} */
+  template <typename Engine>
+  [[nodiscard]] auto operator()(Engine& gen) const noexcept -> std::size_t
+  {
+    if ( this->spans_engine<Engine>() ) {
+      return this->resolve(gen() - Engine::min());
+    }
+
+    return this->resolve(ehanc::bounded_rand(gen, m_total * N));
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Fills [begin, end) with category indices.
+   *
+   * Raw draws are generated into a local block first, and then resolved
+   * in a separate tight loop, keeping random number generation and
+   * table lookups out of each other's way.
+   *
+   * @tparam Itr Forward iterator whose value type can be constructed
+   * from a `std::size_t` category index.
+   *
+   * @param gen Uniform random bit generator.
+   *
+   * @param begin Beginning of output range.
+   *
+   * @param end End of output range.
+   */
+  /* }}} */
+  template <typename Engine, typename Itr>
+  void operator()(Engine& gen, Itr begin, const Itr end) const noexcept
+  {
+    using value_t = typename std::iterator_traits<Itr>::value_type;
+
+    constexpr std::size_t block_size {64};
+    std::array<std::uint64_t, block_size> draws {};
+
+    // Draws which fit in 32 bits are drawn a block at a time too
+    const bool bounded {m_total * N
+                        <= std::numeric_limits<std::uint32_t>::max()};
+    const ehanc::bounded_dist draw_dist(
+        bounded ? static_cast<std::uint32_t>(m_total * N) : 1);
+
+    auto remaining {static_cast<std::size_t>(std::distance(begin, end))};
+
+    while ( remaining != 0 ) {
+      const std::size_t count {std::min(remaining, block_size)};
+
+      if ( this->spans_engine<Engine>() ) {
+        for ( std::size_t i {0}; i != count; ++i ) {
+          draws[i] = gen() - Engine::min();
+        }
+      } else if ( bounded ) {
+        draw_dist(gen, draws.begin(),
+                  std::next(draws.begin(), static_cast<long>(count)));
+      } else {
+        for ( std::size_t i {0}; i != count; ++i ) {
+          draws[i] = ehanc::bounded_rand(gen, m_total * N);
+        }
+      }
+      for ( std::size_t i {0}; i != count; ++i, ++begin ) {
+        *begin = static_cast<value_t>(this->resolve(draws[i]));
+      }
+
+      remaining -= count;
+    }
+  }
+};
+
+/* {{{ doc */
+/**
+ * @brief Converts floating-point weights to integral weights which sum
+ * to exactly `total`, for building an `alias_table`. Rounding is done
+ * by the largest remainder method.
+ *
+ * @param weights Non-negative weights, not all zero.
+ *
+ * @param total Desired sum of the returned weights.
+ *
+ * @return Integral weights proportional to `weights`.
+ */
+/* }}} */
+template <std::size_t N>
+auto quantize_weights(const std::array<double, N>& weights,
+                      const std::uint64_t total) noexcept
+    -> std::array<std::uint64_t, N>
+{
+  double weight_sum {0.0};
+  for ( const double weight : weights ) {
+    weight_sum += weight;
+  }
+
+  std::array<std::uint64_t, N> retval {};
+  std::array<double, N> remainders {};
+  std::uint64_t assigned {0};
+
+  for ( std::size_t i {0}; i != N; ++i ) {
+    const double exact {(weights[i] / weight_sum)
+                        * static_cast<double>(total)};
+    retval[i]     = static_cast<std::uint64_t>(exact);
+    remainders[i] = exact - static_cast<double>(retval[i]);
+    assigned += retval[i];
+  }
+
+  // hand leftover units to whichever weights were rounded down the most
+  while ( assigned < total ) {
+    const auto largest {static_cast<std::size_t>(
+        std::max_element(remainders.cbegin(), remainders.cend())
+        - remainders.cbegin())};
+    ++retval[largest];
+    remainders[largest] -= 1.0;
+    ++assigned;
+  }
+
+  return retval;
+}
+
+} // namespace ehanc
+
+#endif
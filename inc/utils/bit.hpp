@@ -0,0 +1,55 @@
+#ifndef EHANC_UTILS_BIT_HPP
+#define EHANC_UTILS_BIT_HPP
+
+#include <cstdint>
+
+namespace ehanc {
+
+/* {{{ doc */
+/**
+ * @brief Counts the number of set bits. Stand-in for C++20's
+ * `std::popcount`, using the compiler builtin where available.
+ *
+ * @param value Value whose set bits to count.
+ */
+/* }}} */
+constexpr auto popcount(std::uint64_t value) noexcept -> int
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_popcountll(value);
+#else
+  int count {0};
+  for ( ; value != 0; value &= value - 1 ) {
+    ++count;
+  }
+  return count;
+#endif
+}
+
+/* {{{ doc */
+/**
+ * @brief Counts the number of consecutive zero bits, starting from the
+ * least significant bit. Stand-in for C++20's `std::countr_zero`.
+ *
+ * @param value Value to inspect. Returns 64 if `value` is 0.
+ */
+/* }}} */
+constexpr auto countr_zero(std::uint64_t value) noexcept -> int
+{
+  if ( value == 0 ) {
+    return 64;
+  }
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll(value);
+#else
+  int count {0};
+  for ( ; (value & 1U) == 0; value >>= 1U ) {
+    ++count;
+  }
+  return count;
+#endif
+}
+
+} // namespace ehanc
+
+#endif
@@ -0,0 +1,187 @@
+#ifndef EHANC_UTILS_BOUNDED_INT_HPP
+#define EHANC_UTILS_BOUNDED_INT_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <random>
+
+namespace ehanc {
+
+/* {{{ doc */
+/**
+ * @brief Determines if `Engine` outputs exactly 32 random bits, which
+ * bounded draws scale with a single multiplication.
+ */
+/* }}} */
+template <typename Engine>
+constexpr inline bool is_32_bit_engine {
+    Engine::min() == 0
+    && Engine::max() == std::numeric_limits<std::uint32_t>::max()};
+
+/* {{{ doc */
+/**
+ * @brief Draws a uniform integer in `[0, range)` with Lemire's nearly
+ * divisionless method: the draw times `range` is split into its high
+ * half, the result, and its low half, which only needs checking against
+ * the rejection threshold, and the threshold only needs a division to
+ * compute, when it is below `range`. That happens with probability
+ * `range / 2^32`.
+ *
+ * Engines which do not output exactly 32 bits, and ranges which do not
+ * fit in 32 bits, fall back to `std::uniform_int_distribution`.
+ *
+ * @param gen Uniform random bit generator.
+ *
+ * @param range Number of possible results. Must not be 0.
+ */
+/* }}} */
+template <typename Engine>
+inline auto bounded_rand(Engine& gen, const std::uint64_t range) noexcept
+    -> std::uint64_t
+{
+  if constexpr ( is_32_bit_engine<Engine> ) {
+    if ( range <= std::numeric_limits<std::uint32_t>::max() ) {
+      const auto range32 {static_cast<std::uint32_t>(range)};
+
+      std::uint64_t product {static_cast<std::uint64_t>(gen()) * range};
+      auto low {static_cast<std::uint32_t>(product)};
+      if ( low < range32 ) {
+        // 2^32 % range, the number of low halves which would bias the
+        // result
+        const std::uint32_t threshold {(0U - range32) % range32};
+        while ( low < threshold ) {
+          product = static_cast<std::uint64_t>(gen()) * range;
+          low = static_cast<std::uint32_t>(product);
+        }
+      }
+      return product >> 32U;
+    }
+  }
+
+  std::uniform_int_distribution<std::uint64_t> dist(0, range - 1);
+  return dist(gen);
+}
+
+/* {{{ doc */
+/**
+ * @brief Uniform distribution over `[0, range)`, drawn as by
+ * `bounded_rand()`, for ranges which are drawn from many times. The
+ * rejection threshold is computed once, when the distribution is built,
+ * so no draw ever divides, and for ranges known at compile time, it is
+ * computed at compile time.
+ */
+/* }}} */
+class bounded_dist
+{
+private:
+
+  std::uint32_t m_range;
+  std::uint32_t m_threshold;
+
+  // Scales one 32 bit draw, or returns false if it must be redrawn
+  [[nodiscard]] constexpr auto scale(const std::uint32_t draw,
+                                     std::uint32_t& result) const noexcept
+      -> bool
+  {
+    const std::uint64_t product {static_cast<std::uint64_t>(draw)
+                                 * m_range};
+    result = static_cast<std::uint32_t>(product >> 32U);
+    return static_cast<std::uint32_t>(product) >= m_threshold;
+  }
+
+public:
+
+  /* {{{ doc */
+  /**
+   * @param range Number of possible results. Must not be 0.
+   */
+  /* }}} */
+  constexpr explicit bounded_dist(const std::uint32_t range) noexcept
+      : m_range {range}
+      , m_threshold {(0U - range) % range}
+  {}
+
+  [[nodiscard]] constexpr auto range() const noexcept -> std::uint32_t
+  {
+    return m_range;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Draws a single integer in `[0, range)`.
+   *
+   * @param gen Uniform random bit generator.
+   */
+  /* }}} */
+  template <typename Engine>
+  [[nodiscard]] inline auto operator()(Engine& gen) const noexcept
+      -> std::uint32_t
+  {
+    if constexpr ( is_32_bit_engine<Engine> ) {
+      std::uint32_t result {};
+      while ( not this->scale(static_cast<std::uint32_t>(gen()),
+                              result) ) {
+      }
+      return result;
+    } else {
+      return static_cast<std::uint32_t>(bounded_rand(gen, m_range));
+    }
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Fills [begin, end) with integers in `[0, range)`.
+   *
+   * Raw draws are generated into a local block first, and then scaled in
+   * a separate tight loop, as in `alias_table`. The rare rejected draw is
+   * redrawn on its own.
+   *
+   * @tparam Itr Forward iterator whose value type can be constructed
+   * from a `std::uint32_t`.
+   *
+   * @param gen Uniform random bit generator.
+   */
+  /* }}} */
+  template <typename Engine, typename Itr>
+  inline void operator()(Engine& gen, Itr begin, const Itr end) const
+      noexcept
+  {
+    using value_t = typename std::iterator_traits<Itr>::value_type;
+
+    if constexpr ( is_32_bit_engine<Engine> ) {
+      constexpr std::size_t block_size {64};
+      std::array<std::uint32_t, block_size> draws {};
+
+      auto remaining {static_cast<std::size_t>(std::distance(begin, end))};
+
+      while ( remaining != 0 ) {
+        const std::size_t count {std::min(remaining, block_size)};
+
+        for ( std::size_t i {0}; i != count; ++i ) {
+          draws[i] = static_cast<std::uint32_t>(gen());
+        }
+        for ( std::size_t i {0}; i != count; ++i, ++begin ) {
+          std::uint32_t result {};
+          if ( not this->scale(draws[i], result) ) {
+            result = (*this)(gen);
+          }
+          *begin = static_cast<value_t>(result);
+        }
+
+        remaining -= count;
+      }
+    } else {
+      for ( ; begin != end; ++begin ) {
+        *begin = static_cast<value_t>((*this)(gen));
+      }
+    }
+  }
+};
+
+} // namespace ehanc
+
+#endif
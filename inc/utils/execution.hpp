@@ -0,0 +1,129 @@
+#ifndef EHANC_UTILS_EXECUTION_HPP
+#define EHANC_UTILS_EXECUTION_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
+#include "utils/metaprogramming.hpp"
+#include "utils/thread_pool.hpp"
+
+namespace ehanc {
+
+/* {{{ doc */
+/**
+ * @brief Execution policies for the algorithms in `utils/algorithm.hpp`,
+ * after the `std::execution` ones, which are not available everywhere
+ * this builds, and cannot be told which threads to use.
+ */
+/* }}} */
+namespace execution {
+
+/* {{{ doc */
+/**
+ * @brief Runs an algorithm on the calling thread, in order, exactly as
+ * the overload without a policy does.
+ */
+/* }}} */
+class sequenced_policy
+{};
+
+/* {{{ doc */
+/**
+ * @brief Splits an algorithm's range into chunks, and runs them across a
+ * thread pool, in no particular order.
+ *
+ * Functions passed along with this policy must not throw, and must be
+ * safe to call from several threads at once. Nothing run on a pool may
+ * itself run on the same pool.
+ */
+/* }}} */
+class parallel_policy
+{
+private:
+
+  thread_pool* m_pool {nullptr};
+
+public:
+
+  /* {{{ doc */
+  /**
+   * @brief Chunks handed out per thread of the pool, so that a slow chunk
+   * does not leave the other threads idle for long.
+   */
+  /* }}} */
+  static constexpr std::size_t chunks_per_thread {4};
+
+  constexpr parallel_policy() noexcept = default;
+
+  constexpr explicit parallel_policy(thread_pool& pool) noexcept
+      : m_pool {&pool}
+  {}
+
+  /* {{{ doc */
+  /**
+   * @brief Same policy, run on `pool` instead.
+   */
+  /* }}} */
+  [[nodiscard]] constexpr auto on(thread_pool& pool) const noexcept
+      -> parallel_policy
+  {
+    return parallel_policy {pool};
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Pool to run on: the one given, or else
+   * `thread_pool::shared()`.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto pool() const -> thread_pool&
+  {
+    return m_pool == nullptr ? thread_pool::shared() : *m_pool;
+  }
+};
+
+constexpr inline sequenced_policy seq {};
+
+constexpr inline parallel_policy par {};
+
+template <typename T>
+constexpr inline bool is_execution_policy_v {
+    std::is_same_v<std::decay_t<T>, sequenced_policy>
+    || std::is_same_v<std::decay_t<T>, parallel_policy>};
+
+} // namespace execution
+
+namespace impl {
+
+/* {{{ doc */
+/**
+ * @brief Splits [0, n) into contiguous chunks, and calls
+ * `chunk_func(first, last)` for each of them, across the policy's pool.
+ * Not intended to be called outside `utils/algorithm.hpp`.
+ */
+/* }}} */
+template <typename ChunkFunc>
+inline void run_chunked(const execution::parallel_policy& policy,
+                        const std::size_t n, const ChunkFunc& chunk_func)
+{
+  if ( n <= 1 ) {
+    chunk_func(std::size_t {0}, n);
+    return;
+  }
+
+  thread_pool& pool {policy.pool()};
+  const std::size_t chunk_count {std::min(
+      n, pool.size() * execution::parallel_policy::chunks_per_thread)};
+
+  pool.run(chunk_count, [&](const std::size_t chunk) {
+    chunk_func((chunk * n) / chunk_count,
+               ((chunk + 1) * n) / chunk_count);
+  });
+}
+
+} // namespace impl
+
+} // namespace ehanc
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef EHANC_UTILS_FENWICK_TREE_HPP
+#define EHANC_UTILS_FENWICK_TREE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "utils/memory.hpp"
+
+namespace ehanc {
+
+/* {{{ doc */
+/**
+ * @brief Array of values which supports adding to one value and summing
+ * any prefix of the array, both in O(log n).
+ *
+ * The array starts out empty and grows as values past its end are added
+ * to, every value starting at zero.
+ *
+ * @tparam T Type of the values, which must form a group under `+` and
+ * `-`, with `T {}` as zero.
+ */
+/* }}} */
+template <typename T>
+class fenwick_tree
+{
+private:
+
+  // m_tree[i - 1] holds the sum of the values in (i - lowbit(i), i]
+  std::vector<T> m_tree {};
+  T m_total {};
+
+  static constexpr auto lowbit(const std::size_t i) noexcept
+      -> std::size_t
+  {
+    return i & (~i + 1);
+  }
+
+  // Sum of the first `count` values, for any `count` up to the size
+  [[nodiscard]] inline auto sum_first(std::size_t count) const noexcept
+      -> T
+  {
+    T sum {};
+    for ( ; count != 0; count -= lowbit(count) ) {
+      sum += m_tree[count - 1];
+    }
+    return sum;
+  }
+
+  // Grows the array to hold at least `size` values
+  inline void grow(const std::size_t size)
+  {
+    const std::size_t old_size {m_tree.size()};
+    std::size_t new_size {std::max(old_size, std::size_t {1})};
+    while ( new_size < size ) {
+      new_size *= 2;
+    }
+
+    // A new node's range may reach back into the old values, so it
+    // starts out as their sum over that range
+    m_tree.resize(new_size);
+    for ( std::size_t i {old_size + 1}; i <= new_size; ++i ) {
+      const std::size_t first {i - lowbit(i)};
+      if ( first < old_size ) {
+        m_tree[i - 1] = m_total - this->sum_first(first);
+      }
+    }
+  }
+
+public:
+
+  /* {{{ doc */
+  /**
+   * @brief Adds `delta` to the value at `index`.
+   */
+  /* }}} */
+  inline void add(const std::size_t index, const T& delta)
+  {
+    if ( index >= m_tree.size() ) {
+      this->grow(index + 1);
+    }
+
+    for ( std::size_t i {index + 1}; i <= m_tree.size(); i += lowbit(i) ) {
+      m_tree[i - 1] += delta;
+    }
+    m_total += delta;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Sum of the values at indices [0, end).
+   */
+  /* }}} */
+  [[nodiscard]] inline auto prefix_sum(const std::size_t end) const
+      noexcept -> T
+  {
+    return end >= m_tree.size() ? m_total : this->sum_first(end);
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Sum of every value.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto total() const noexcept -> const T&
+  {
+    return m_total;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Number of values the array holds before it has to grow.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto size() const noexcept -> std::size_t
+  {
+    return m_tree.size();
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Bytes the tree has allocated, beyond its own size.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto memory_footprint() const noexcept
+      -> std::size_t
+  {
+    return ehanc::heap_bytes(m_tree);
+  }
+};
+
+} // namespace ehanc
+
+#endif
@@ -0,0 +1,226 @@
+#ifndef EHANC_UTILS_INDEXED_HEAP_HPP
+#define EHANC_UTILS_INDEXED_HEAP_HPP
+
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "utils/memory.hpp"
+
+namespace ehanc {
+
+/* {{{ doc */
+/**
+ * @brief Binary heap of small integer IDs, each with a key, which also
+ * tracks where every ID sits in the heap. That allows removing any ID,
+ * not just the top one, in O(log n).
+ *
+ * IDs are meant to be indices into storage owned by the caller, so they
+ * should be dense: the heap keeps one position for every ID up to the
+ * largest ever pushed.
+ *
+ * @tparam Key Type of the keys.
+ *
+ * @tparam Compare Ordering of keys; the top of the heap is the ID whose
+ * key is ordered first, so `std::less` makes a min-heap.
+ */
+/* }}} */
+template <typename Key, typename Compare = std::less<Key>>
+class indexed_heap
+{
+private:
+
+  struct entry {
+    Key key;
+    std::size_t id;
+  };
+
+  static constexpr std::size_t npos {
+      std::numeric_limits<std::size_t>::max()};
+
+  std::vector<entry> m_heap {};
+
+  // Position of each ID in m_heap, or npos
+  std::vector<std::size_t> m_pos {};
+
+  Compare m_compare {};
+
+  // Moves `item` into position `index`, and records where it went
+  inline void place(const std::size_t index, entry&& item) noexcept
+  {
+    m_pos[item.id] = index;
+    m_heap[index] = std::move(item);
+  }
+
+  // Moves the entry at `index` towards the top until it is in order
+  inline void sift_up(std::size_t index) noexcept
+  {
+    entry item {std::move(m_heap[index])};
+
+    while ( index != 0 ) {
+      const std::size_t parent {(index - 1) / 2};
+      if ( not m_compare(item.key, m_heap[parent].key) ) {
+        break;
+      }
+      this->place(index, std::move(m_heap[parent]));
+      index = parent;
+    }
+
+    this->place(index, std::move(item));
+  }
+
+  // Moves the entry at `index` away from the top until it is in order
+  inline void sift_down(std::size_t index) noexcept
+  {
+    entry item {std::move(m_heap[index])};
+    const std::size_t size {m_heap.size()};
+
+    while ( true ) {
+      std::size_t child {(2 * index) + 1};
+      if ( child >= size ) {
+        break;
+      }
+      if ( child + 1 < size
+           && m_compare(m_heap[child + 1].key, m_heap[child].key) ) {
+        ++child;
+      }
+      if ( not m_compare(m_heap[child].key, item.key) ) {
+        break;
+      }
+      this->place(index, std::move(m_heap[child]));
+      index = child;
+    }
+
+    this->place(index, std::move(item));
+  }
+
+public:
+
+  /* {{{ doc */
+  /**
+   * @brief Adds an ID which is not already in the heap.
+   */
+  /* }}} */
+  inline void push(const std::size_t id, Key key)
+  {
+    if ( id >= m_pos.size() ) {
+      m_pos.resize(id + 1, npos);
+    }
+
+    m_heap.push_back(entry {std::move(key), id});
+    m_pos[id] = m_heap.size() - 1;
+    this->sift_up(m_heap.size() - 1);
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief ID whose key is ordered first. The heap must not be empty.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto top() const noexcept -> std::size_t
+  {
+    return m_heap.front().id;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Key of the top ID. The heap must not be empty.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto top_key() const noexcept -> const Key&
+  {
+    return m_heap.front().key;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Removes and returns the top ID. The heap must not be empty.
+   */
+  /* }}} */
+  inline auto pop() noexcept -> std::size_t
+  {
+    const std::size_t id {m_heap.front().id};
+    this->erase(id);
+    return id;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Removes an ID, wherever it is in the heap.
+   *
+   * @return False if the ID was not in the heap.
+   */
+  /* }}} */
+  inline auto erase(const std::size_t id) noexcept -> bool
+  {
+    if ( not this->contains(id) ) {
+      return false;
+    }
+
+    const std::size_t index {m_pos[id]};
+    m_pos[id] = npos;
+
+    // Fill the hole with the last entry, which may belong either above
+    // or below it
+    if ( index != m_heap.size() - 1 ) {
+      this->place(index, std::move(m_heap.back()));
+      m_heap.pop_back();
+
+      if ( index != 0
+           && m_compare(m_heap[index].key,
+                        m_heap[(index - 1) / 2].key) ) {
+        this->sift_up(index);
+      } else {
+        this->sift_down(index);
+      }
+    } else {
+      m_heap.pop_back();
+    }
+
+    return true;
+  }
+
+  [[nodiscard]] inline auto contains(const std::size_t id) const noexcept
+      -> bool
+  {
+    return id < m_pos.size() && m_pos[id] != npos;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Key of an ID, which must be in the heap.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto key(const std::size_t id) const noexcept
+      -> const Key&
+  {
+    return m_heap[m_pos[id]].key;
+  }
+
+  [[nodiscard]] inline auto size() const noexcept -> std::size_t
+  {
+    return m_heap.size();
+  }
+
+  [[nodiscard]] inline auto empty() const noexcept -> bool
+  {
+    return m_heap.empty();
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Bytes the heap has allocated, beyond its own size.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto memory_footprint() const noexcept
+      -> std::size_t
+  {
+    return ehanc::heap_bytes(m_heap) + ehanc::heap_bytes(m_pos);
+  }
+};
+
+} // namespace ehanc
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef EHANC_UTILS_MEMORY_HPP
+#define EHANC_UTILS_MEMORY_HPP
+
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ehanc {
+
+/* {{{ doc */
+/**
+ * @brief Bytes allocated by a vector for its elements. Does not count
+ * anything the elements themselves allocate.
+ */
+/* }}} */
+template <typename T>
+constexpr auto heap_bytes(const std::vector<T>& vec) noexcept
+    -> std::size_t
+{
+  return vec.capacity() * sizeof(T);
+}
+
+/* {{{ doc */
+/**
+ * @brief Bytes allocated by a deque for its elements, and for the map
+ * of its blocks, as laid out by libstdc++: blocks of 512 bytes, or of
+ * one element if it is larger. Does not count anything the elements
+ * themselves allocate.
+ */
+/* }}} */
+template <typename T>
+constexpr auto heap_bytes(const std::deque<T>& deq) noexcept
+    -> std::size_t
+{
+  constexpr std::size_t per_block {sizeof(T) < 512 ? 512 / sizeof(T)
+                                                   : 1};
+  // One block past the last element is always allocated, and the map
+  // keeps a spare pointer at either end
+  const std::size_t blocks {(deq.size() / per_block) + 1};
+  return (blocks * per_block * sizeof(T)) + ((blocks + 2) * sizeof(T*));
+}
+
+/* {{{ doc */
+/**
+ * @brief Bytes allocated by an unordered map for its nodes and buckets,
+ * as laid out by libstdc++: each node holds a next pointer and the
+ * element, and the hash when it is not cheap to recompute. Does not
+ * count anything the elements themselves allocate.
+ */
+/* }}} */
+template <typename Key, typename T, typename Hash, typename Equal,
+          typename Alloc>
+auto heap_bytes(const std::unordered_map<Key, T, Hash, Equal, Alloc>& map)
+    noexcept -> std::size_t
+{
+  struct node {
+    void* next;
+    typename std::unordered_map<Key, T, Hash, Equal, Alloc>::value_type
+        value;
+  };
+
+  return (map.size() * sizeof(node))
+         + (map.bucket_count() * sizeof(void*));
+}
+
+/* {{{ doc */
+/**
+ * @brief Parses a number of bytes, with an optional binary suffix: K, M,
+ * G or T, in either case, optionally followed by B or iB, as in `512M`,
+ * `2GiB` or `64kb`.
+ *
+ * @return The number of bytes, or nothing if `text` is not a valid size
+ * or is too large.
+ */
+/* }}} */
+inline auto parse_byte_size(std::string_view text) noexcept
+    -> std::optional<std::uint64_t>
+{
+  std::uint64_t value {0};
+  std::size_t pos {0};
+
+  constexpr std::uint64_t max {std::numeric_limits<std::uint64_t>::max()};
+
+  for ( ; pos != text.size()
+          && std::isdigit(static_cast<unsigned char>(text[pos])) != 0;
+        ++pos ) {
+    const auto digit {static_cast<std::uint64_t>(text[pos] - '0')};
+    if ( value > (max - digit) / 10 ) {
+      return std::nullopt;
+    }
+    value = (value * 10) + digit;
+  }
+
+  if ( pos == 0 ) {
+    return std::nullopt;
+  }
+
+  std::string_view suffix {text.substr(pos)};
+  unsigned shift {0};
+
+  if ( not suffix.empty() ) {
+    switch ( std::toupper(static_cast<unsigned char>(suffix.front())) ) {
+    case 'K':
+      shift = 10;
+      break;
+    case 'M':
+      shift = 20;
+      break;
+    case 'G':
+      shift = 30;
+      break;
+    case 'T':
+      shift = 40;
+      break;
+    default:
+      break;
+    }
+    if ( shift != 0 ) {
+      suffix.remove_prefix(1);
+      if ( not suffix.empty()
+           && (suffix.front() == 'i' || suffix.front() == 'I') ) {
+        suffix.remove_prefix(1);
+      }
+    }
+    if ( suffix == "B" || suffix == "b" ) {
+      suffix.remove_prefix(1);
+    }
+  }
+
+  if ( not suffix.empty()
+       || value > (max >> shift) ) {
+    return std::nullopt;
+  }
+
+  return value << shift;
+}
+
+} // namespace ehanc
+
+#endif
@@ -5,6 +5,7 @@
 #include <tuple>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace ehanc {
 
@@ -289,6 +290,46 @@ template <typename T>
 constexpr inline bool is_random_access_v =
     ::ehanc::is_random_access<T>::value;
 
+/* {{{ doc */
+/**
+ * @brief Metafunction to determine if an iterator points into contiguous
+ * storage, so that a pointer to its element can stand in for it. C++17
+ * offers no way to ask, so only pointers and the iterators of
+ * `std::vector`, other than `std::vector<bool>`, are recognized.
+ */
+/* }}} */
+template <typename T, typename = void>
+struct is_contiguous : std::is_pointer<T> {};
+
+/* {{{ doc */
+/**
+ * @brief Metafunction to determine if an iterator points into contiguous
+ * storage. Specialization for random access class iterators.
+ */
+/* }}} */
+template <typename T>
+struct is_contiguous<
+    T, std::enable_if_t<::ehanc::is_random_access_v<T>
+                        && not std::is_pointer_v<T>>>
+    : std::bool_constant<
+          not std::is_same_v<typename std::iterator_traits<T>::value_type,
+                             bool>
+          && ::ehanc::is_type_in_pack_v<
+              T,
+              typename std::vector<typename std::iterator_traits<
+                  T>::value_type>::iterator,
+              typename std::vector<typename std::iterator_traits<
+                  T>::value_type>::const_iterator>> {};
+
+/* {{{ doc */
+/**
+ * @brief Helper variable template to make using the `is_contiguous`
+ * metafunction less verbose and cumbersome.
+ */
+/* }}} */
+template <typename T>
+constexpr inline bool is_contiguous_v = ::ehanc::is_contiguous<T>::value;
+
 namespace impl {
 /* {{{ doc */
 /**
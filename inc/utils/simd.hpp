@@ -0,0 +1,200 @@
+#ifndef EHANC_UTILS_SIMD_HPP
+#define EHANC_UTILS_SIMD_HPP
+
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace ehanc {
+
+/* {{{ doc */
+/**
+ * @brief Bytes compared at once by the vector kernels: 32 when built for
+ * AVX2, 16 when built for SSE2, and 0 when neither is available, in which
+ * case no kernel is provided.
+ */
+/* }}} */
+#if defined(__AVX2__)
+constexpr inline std::size_t simd_width {32};
+#elif defined(__SSE2__)
+constexpr inline std::size_t simd_width {16};
+#else
+constexpr inline std::size_t simd_width {0};
+#endif
+
+/* {{{ doc */
+/**
+ * @brief Determines if `simd_contains()` is provided for ranges of `T`:
+ * integers of 1, 2, 4 or 8 bytes, other than `bool`, and `float` and
+ * `double`.
+ */
+/* }}} */
+template <typename T>
+constexpr inline bool has_simd_contains_v {
+    simd_width != 0
+    && ((std::is_integral_v<T> && not std::is_same_v<T, bool>
+         && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4
+             || sizeof(T) == 8))
+        || std::is_same_v<T, float> || std::is_same_v<T, double>)};
+
+namespace impl {
+
+#if defined(__AVX2__)
+
+/* {{{ doc */
+/**
+ * @brief Compares every integer lane of `lanes` to `value`, setting the
+ * lanes which match. Not intended to be called outside `simd_contains`.
+ */
+/* }}} */
+template <typename T>
+inline auto equal_lanes(const __m256i lanes, const T value) noexcept
+    -> __m256i
+{
+  if constexpr ( sizeof(T) == 1 ) {
+    return _mm256_cmpeq_epi8(lanes,
+                             _mm256_set1_epi8(static_cast<char>(value)));
+  } else if constexpr ( sizeof(T) == 2 ) {
+    return _mm256_cmpeq_epi16(
+        lanes, _mm256_set1_epi16(static_cast<short>(value)));
+  } else if constexpr ( sizeof(T) == 4 ) {
+    return _mm256_cmpeq_epi32(lanes,
+                              _mm256_set1_epi32(static_cast<int>(value)));
+  } else {
+    return _mm256_cmpeq_epi64(
+        lanes, _mm256_set1_epi64x(static_cast<long long>(value)));
+  }
+}
+
+/* {{{ doc */
+/**
+ * @brief Compares the `simd_width / sizeof(T)` elements at `block` to
+ * `value`, returning a mask which is not 0 if any of them match. Not
+ * intended to be called outside `simd_contains`.
+ */
+/* }}} */
+template <typename T>
+inline auto block_mask(const T* const block, const T value) noexcept
+    -> int
+{
+  if constexpr ( std::is_same_v<T, float> ) {
+    return _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(block),
+                                            _mm256_set1_ps(value),
+                                            _CMP_EQ_OQ));
+  } else if constexpr ( std::is_same_v<T, double> ) {
+    return _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(block),
+                                            _mm256_set1_pd(value),
+                                            _CMP_EQ_OQ));
+  } else {
+    const __m256i lanes {
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block))};
+    return _mm256_movemask_epi8(::ehanc::impl::equal_lanes(lanes, value));
+  }
+}
+
+#elif defined(__SSE2__)
+
+/* {{{ doc */
+/**
+ * @brief Compares every integer lane of `lanes` to `value`, setting the
+ * lanes which match. Not intended to be called outside `simd_contains`.
+ */
+/* }}} */
+template <typename T>
+inline auto equal_lanes(const __m128i lanes, const T value) noexcept
+    -> __m128i
+{
+  if constexpr ( sizeof(T) == 1 ) {
+    return _mm_cmpeq_epi8(lanes, _mm_set1_epi8(static_cast<char>(value)));
+  } else if constexpr ( sizeof(T) == 2 ) {
+    return _mm_cmpeq_epi16(lanes,
+                           _mm_set1_epi16(static_cast<short>(value)));
+  } else if constexpr ( sizeof(T) == 4 ) {
+    return _mm_cmpeq_epi32(lanes, _mm_set1_epi32(static_cast<int>(value)));
+  } else {
+    // SSE2 has no 64 bit compare, so both 32 bit halves must match
+    const __m128i halves {_mm_cmpeq_epi32(
+        lanes, _mm_set1_epi64x(static_cast<long long>(value)))};
+    return _mm_and_si128(
+        halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+  }
+}
+
+/* {{{ doc */
+/**
+ * @brief Compares the `simd_width / sizeof(T)` elements at `block` to
+ * `value`, returning a mask which is not 0 if any of them match. Not
+ * intended to be called outside `simd_contains`.
+ */
+/* }}} */
+template <typename T>
+inline auto block_mask(const T* const block, const T value) noexcept
+    -> int
+{
+  if constexpr ( std::is_same_v<T, float> ) {
+    return _mm_movemask_ps(
+        _mm_cmpeq_ps(_mm_loadu_ps(block), _mm_set1_ps(value)));
+  } else if constexpr ( std::is_same_v<T, double> ) {
+    return _mm_movemask_pd(
+        _mm_cmpeq_pd(_mm_loadu_pd(block), _mm_set1_pd(value)));
+  } else {
+    const __m128i lanes {
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(block))};
+    return _mm_movemask_epi8(::ehanc::impl::equal_lanes(lanes, value));
+  }
+}
+
+#endif
+
+} // namespace impl
+
+/* {{{ doc */
+/**
+ * @brief Determines if any element of [begin, end) equals `value`, as
+ * `std::find` would, comparing `simd_width` bytes at a time and the
+ * remainder one element at a time. Only provided for the types which
+ * `has_simd_contains_v` accepts.
+ *
+ * Floating point elements compare as they do with `==`, so `0.0` matches
+ * `-0.0`, and NaN matches nothing.
+ */
+/* }}} */
+template <typename T, typename = std::enable_if_t<has_simd_contains_v<T>>>
+inline auto simd_contains(const T* begin, const T* const end,
+                          const T value) noexcept -> bool
+{
+  constexpr std::ptrdiff_t lanes {
+      static_cast<std::ptrdiff_t>(simd_width / sizeof(T))};
+
+  // Four blocks are compared before each check, so that the compares
+  // do not wait on a branch each
+  for ( ; end - begin >= 4 * lanes; begin += 4 * lanes ) {
+    if ( (::ehanc::impl::block_mask(begin, value)
+          | ::ehanc::impl::block_mask(begin + lanes, value)
+          | ::ehanc::impl::block_mask(begin + (2 * lanes), value)
+          | ::ehanc::impl::block_mask(begin + (3 * lanes), value))
+         != 0 ) {
+      return true;
+    }
+  }
+  for ( ; end - begin >= lanes; begin += lanes ) {
+    if ( ::ehanc::impl::block_mask(begin, value) != 0 ) {
+      return true;
+    }
+  }
+
+  for ( ; begin != end; ++begin ) {
+    if ( std::equal_to<T> {}(*begin, value) ) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace ehanc
+
+#endif
@@ -0,0 +1,227 @@
+#ifndef EHANC_UTILS_THREAD_POOL_HPP
+#define EHANC_UTILS_THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ehanc {
+
+/* {{{ doc */
+/**
+ * @brief Fixed set of threads for fork-join parallelism.
+ *
+ * `run()` hands out the indices of a task to the pool's threads and the
+ * calling thread alike, and returns once every index has been handled.
+ * Threads are started once and sleep between calls, so a pool is cheap
+ * to use for many short rounds of work. Rounds run one at a time, so
+ * threads sharing a pool wait for each other's.
+ */
+/* }}} */
+class thread_pool
+{
+private:
+
+  std::vector<std::thread> m_workers {};
+
+  // Held by run() for a whole round, so rounds from several callers
+  // take turns
+  std::mutex m_run_mutex {};
+
+  std::mutex m_mutex {};
+  std::condition_variable m_work_ready {};
+  std::condition_variable m_work_done {};
+
+  // Task of the current round, published under m_mutex
+  const std::function<void(std::size_t)>* m_task {nullptr};
+  std::size_t m_task_count {0};
+  std::uint64_t m_round {0};
+  std::size_t m_busy_workers {0};
+  bool m_stopping {false};
+
+  std::atomic<std::size_t> m_next_index {0};
+
+  inline void run_indices(const std::function<void(std::size_t)>& task,
+                          const std::size_t count)
+  {
+    for ( std::size_t i {m_next_index++}; i < count;
+          i = m_next_index++ ) {
+      task(i);
+    }
+  }
+
+  inline void work()
+  {
+    std::uint64_t seen_round {0};
+
+    while ( true ) {
+      const std::function<void(std::size_t)>* task {nullptr};
+      std::size_t count {0};
+
+      {
+        std::unique_lock lock(m_mutex);
+        m_work_ready.wait(lock, [this, seen_round]() {
+          return m_stopping || m_round != seen_round;
+        });
+
+        if ( m_stopping ) {
+          return;
+        }
+
+        seen_round = m_round;
+        task = m_task;
+        count = m_task_count;
+      }
+
+      this->run_indices(*task, count);
+
+      {
+        const std::lock_guard lock(m_mutex);
+        if ( --m_busy_workers == 0 ) {
+          m_work_done.notify_one();
+        }
+      }
+    }
+  }
+
+public:
+
+  /* {{{ doc */
+  /**
+   * @brief Starts the pool.
+   *
+   * @param threads Number of threads working on each task, counting the
+   * thread which calls `run()`. Zero picks one per hardware thread.
+   */
+  /* }}} */
+  explicit thread_pool(std::size_t threads = 0)
+  {
+    if ( threads == 0 ) {
+      threads = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+
+    m_workers.reserve(threads - 1);
+    for ( std::size_t i {1}; i < threads; ++i ) {
+      m_workers.emplace_back([this]() { this->work(); });
+    }
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be copied
+   */
+  /* }}} */
+  thread_pool(const thread_pool&) = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be copied
+   */
+  /* }}} */
+  auto operator=(const thread_pool&) -> thread_pool& = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be moved
+   */
+  /* }}} */
+  thread_pool(thread_pool&&) = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Must not be moved
+   */
+  /* }}} */
+  auto operator=(thread_pool&&) -> thread_pool& = delete;
+
+  /* {{{ doc */
+  /**
+   * @brief Stops and joins every thread.
+   */
+  /* }}} */
+  ~thread_pool() noexcept
+  {
+    {
+      const std::lock_guard lock(m_mutex);
+      m_stopping = true;
+    }
+    m_work_ready.notify_all();
+
+    for ( std::thread& worker : m_workers ) {
+      worker.join();
+    }
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Calls `task(i)` for every `i` in [0, count), spread across
+   * the pool, and waits for all of them to finish. Indices are handed
+   * out in no particular order, so each must be independent of the
+   * others. `task` must not throw, and must not itself call `run()` on
+   * the same pool.
+   *
+   * Safe to call from several threads at once: each call waits for the
+   * round before it to finish.
+   */
+  /* }}} */
+  inline void run(const std::size_t count,
+                  const std::function<void(std::size_t)>& task)
+  {
+    const std::lock_guard round_lock(m_run_mutex);
+
+    m_next_index = 0;
+
+    // Not worth waking anyone for
+    if ( m_workers.empty() || count <= 1 ) {
+      this->run_indices(task, count);
+      return;
+    }
+
+    {
+      const std::lock_guard lock(m_mutex);
+      m_task = &task;
+      m_task_count = count;
+      m_busy_workers = m_workers.size();
+      ++m_round;
+    }
+    m_work_ready.notify_all();
+
+    this->run_indices(task, count);
+
+    std::unique_lock lock(m_mutex);
+    m_work_done.wait(lock, [this]() { return m_busy_workers == 0; });
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Number of threads working on each task, counting the
+   * calling thread.
+   */
+  /* }}} */
+  [[nodiscard]] inline auto size() const noexcept -> std::size_t
+  {
+    return m_workers.size() + 1;
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Pool of one thread per hardware thread, shared by everything
+   * which does not bring its own, and started on first use.
+   */
+  /* }}} */
+  [[nodiscard]] static inline auto shared() -> thread_pool&
+  {
+    static thread_pool pool;
+    return pool;
+  }
+};
+
+} // namespace ehanc
+
+#endif
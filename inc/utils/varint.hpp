@@ -0,0 +1,83 @@
+#ifndef EHANC_UTILS_VARINT_HPP
+#define EHANC_UTILS_VARINT_HPP
+
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <vector>
+
+namespace ehanc {
+
+/* {{{ doc */
+/**
+ * @brief Appends `value` to `out` as an LEB128 varint: seven bits per
+ * byte, least significant first, with the high bit set on every byte
+ * but the last.
+ */
+/* }}} */
+inline void append_varint(std::vector<char>& out, std::uint64_t value)
+{
+  while ( value >= 0x80U ) {
+    out.push_back(static_cast<char>((value & 0x7FU) | 0x80U));
+    value >>= 7U;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+/* {{{ doc */
+/**
+ * @brief Reads an LEB128 varint from [pos, end), advancing `pos` past
+ * it.
+ *
+ * @return The value, or nothing if [pos, end) ends before the varint
+ * does, or it is too long.
+ */
+/* }}} */
+inline auto read_varint(const char*& pos, const char* const end) noexcept
+    -> std::optional<std::uint64_t>
+{
+  std::uint64_t value {0};
+
+  for ( unsigned shift {0}; shift < 64 && pos != end; shift += 7 ) {
+    const auto byte {static_cast<unsigned char>(*pos++)};
+    value |= static_cast<std::uint64_t>(byte & 0x7FU) << shift;
+
+    if ( (byte & 0x80U) == 0 ) {
+      return value;
+    }
+  }
+
+  return std::nullopt;
+}
+
+/* {{{ doc */
+/**
+ * @brief Reads an LEB128 varint from a stream.
+ *
+ * @return The value, or nothing if the stream ends before the varint
+ * does, or it is too long.
+ */
+/* }}} */
+inline auto read_varint(std::istream& in) -> std::optional<std::uint64_t>
+{
+  std::uint64_t value {0};
+
+  for ( unsigned shift {0}; shift < 64; shift += 7 ) {
+    const auto byte {in.get()};
+    if ( byte == std::istream::traits_type::eof() ) {
+      return std::nullopt;
+    }
+
+    value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+
+    if ( (byte & 0x80) == 0 ) {
+      return value;
+    }
+  }
+
+  return std::nullopt;
+}
+
+} // namespace ehanc
+
+#endif
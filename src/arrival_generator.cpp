@@ -0,0 +1,105 @@
+#include <cstddef>
+#include <iterator>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "utils/memory.hpp"
+
+#include "arrival_generator.h"
+#include "random.hpp"
+
+void arrival_generator::generate(std::size_t steps) noexcept
+{
+  // Drop what has already been handed out before growing the buffer
+  if ( m_next_step != 0 ) {
+    m_step_counts.erase(m_step_counts.begin(),
+                        std::next(m_step_counts.begin(),
+                                  static_cast<long>(m_next_step)));
+    m_ships.erase(m_ships.begin(),
+                  std::next(m_ships.begin(),
+                            static_cast<long>(m_next_ship)));
+    m_next_step = 0;
+    m_next_ship = 0;
+  }
+
+  const std::size_t old_step_count {m_step_counts.size()};
+  m_step_counts.resize(old_step_count + steps);
+
+  const auto new_counts_begin {std::next(
+      m_step_counts.begin(), static_cast<long>(old_step_count))};
+  get_new_ship_counts(new_counts_begin, m_step_counts.end());
+
+  const std::size_t new_ship_count {std::accumulate(
+      new_counts_begin, m_step_counts.end(), std::size_t {0})};
+
+  m_factions.resize(new_ship_count);
+  get_random_factions(m_factions.begin(), m_factions.end());
+
+  m_part_counts.resize(new_ship_count);
+  get_part_counts(m_part_counts.begin(), m_part_counts.end());
+
+  ship_id_allocator::block ids {m_ids.reserve(new_ship_count)};
+
+  m_ships.reserve(m_ships.size() + new_ship_count);
+  for ( std::size_t i {0}; i != new_ship_count; ++i ) {
+    m_ships.emplace_back(ids.take(), m_factions[i],
+                         ship::create_damaged_part_list(
+                             m_factions[i], m_part_counts[i]));
+    m_ship_bytes += m_ships.back().memory_footprint();
+  }
+}
+
+auto arrival_generator::next_step() noexcept -> arrivals
+{
+  if ( this->buffered_steps() == 0 ) {
+    this->generate(m_lookahead);
+  }
+
+  const auto first {
+      std::next(m_ships.begin(), static_cast<long>(m_next_ship))};
+
+  m_next_ship += m_step_counts[m_next_step];
+  ++m_next_step;
+
+  const auto last {
+      std::next(m_ships.begin(), static_cast<long>(m_next_ship))};
+
+  // Whoever takes the ships takes what they have allocated
+  for ( auto handed_out {first}; handed_out != last; ++handed_out ) {
+    m_ship_bytes -= handed_out->memory_footprint();
+  }
+
+  return {first, last};
+}
+
+auto arrival_generator::pending_step_counts() const
+    -> std::vector<std::size_t>
+{
+  return std::vector<std::size_t>(
+      std::next(m_step_counts.cbegin(), static_cast<long>(m_next_step)),
+      m_step_counts.cend());
+}
+
+void arrival_generator::restore(std::vector<std::size_t>&& step_counts,
+                                std::vector<ship>&& ships,
+                                const ship::id_type next_id) noexcept
+{
+  m_step_counts = std::move(step_counts);
+  m_ships = std::move(ships);
+  m_next_step = 0;
+  m_next_ship = 0;
+  m_ids.reset(next_id);
+
+  m_ship_bytes = 0;
+  for ( const ship& pending : m_ships ) {
+    m_ship_bytes += pending.memory_footprint();
+  }
+}
+
+auto arrival_generator::memory_footprint() const noexcept -> std::size_t
+{
+  return ehanc::heap_bytes(m_step_counts) + ehanc::heap_bytes(m_ships)
+         + ehanc::heap_bytes(m_factions)
+         + ehanc::heap_bytes(m_part_counts) + m_ship_bytes;
+}
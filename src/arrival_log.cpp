@@ -0,0 +1,321 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <future>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "utils/memory.hpp"
+#include "utils/varint.hpp"
+
+#include "arrival_log.h"
+
+namespace arrival_log {
+
+writer::writer(const std::string& path)
+{
+  m_file = std::fopen(path.c_str(), "wb");
+
+  if ( m_file != nullptr
+       && std::fwrite(magic.data(), 1, magic.size(), m_file)
+              != magic.size() ) {
+    std::fclose(m_file);
+    m_file = nullptr;
+  }
+}
+
+writer::~writer() noexcept
+{
+  this->close();
+}
+
+auto writer::write_record(const std::uint64_t hour,
+                          std::vector<ship>::const_iterator first,
+                          const std::vector<ship>::const_iterator last)
+    noexcept -> bool
+{
+  try {
+    m_encoded.clear();
+    ehanc::append_varint(m_encoded, hour - m_last_record_hour);
+    ehanc::append_varint(m_encoded,
+                         static_cast<std::uint64_t>(last - first));
+
+    for ( ; first != last; ++first ) {
+      const part_set& parts {first->get_damaged_parts_list()};
+
+      ehanc::append_varint(
+          m_encoded, static_cast<std::uint64_t>(first->get_faction()));
+      ehanc::append_varint(m_encoded, parts.size());
+
+      for ( const part_set::part part : parts ) {
+        ehanc::append_varint(m_encoded,
+                             static_cast<std::uint64_t>(part.id));
+        ehanc::append_varint(m_encoded,
+                             static_cast<std::uint64_t>(part.damage));
+      }
+    }
+  } catch ( ... ) {
+    return false;
+  }
+
+  m_last_record_hour = hour;
+
+  return std::fwrite(m_encoded.data(), 1, m_encoded.size(), m_file)
+         == m_encoded.size();
+}
+
+auto writer::record(const std::uint64_t hour,
+                    const arrival_generator::arrivals& ships) noexcept
+    -> bool
+{
+  if ( not this->is_open() ) {
+    return false;
+  }
+
+  m_last_hour = hour;
+
+  // Hours without arrivals take no space
+  if ( ships.size() == 0 ) {
+    return true;
+  }
+
+  return this->write_record(hour, ships.begin(), ships.end());
+}
+
+auto writer::close() noexcept -> bool
+{
+  if ( not this->is_open() ) {
+    return false;
+  }
+
+  bool ended {true};
+  if ( m_last_hour != m_last_record_hour ) {
+    const std::vector<ship> none;
+    ended = this->write_record(m_last_hour, none.cbegin(), none.cend());
+  }
+
+  const bool closed {std::fclose(m_file) == 0};
+  m_file = nullptr;
+
+  return ended && closed;
+}
+
+reader::reader(const std::string& path, std::size_t chunk_size)
+    : m_chunk_size {std::max(chunk_size, std::size_t {1})}
+{
+  m_file = std::fopen(path.c_str(), "rb");
+
+  if ( m_file == nullptr ) {
+    return;
+  }
+
+  std::array<char, magic.size()> header {};
+  if ( std::fread(header.data(), 1, header.size(), m_file) != header.size()
+       || header != magic ) {
+    std::fclose(m_file);
+    m_file = nullptr;
+    return;
+  }
+
+  this->start_read();
+}
+
+reader::~reader() noexcept
+{
+  if ( m_next_chunk.valid() ) {
+    m_next_chunk.wait();
+  }
+
+  if ( m_file != nullptr ) {
+    std::fclose(m_file);
+  }
+}
+
+void reader::start_read()
+{
+  m_next_chunk = std::async(
+      std::launch::async, [file {m_file}, size {m_chunk_size}]() {
+        std::vector<char> chunk(size);
+        chunk.resize(std::fread(chunk.data(), 1, size, file));
+        return chunk;
+      });
+}
+
+auto reader::refill() -> bool
+{
+  if ( m_file_done ) {
+    return false;
+  }
+
+  const std::vector<char> chunk {m_next_chunk.get()};
+
+  // A short read means the end of the file
+  if ( chunk.size() < m_chunk_size ) {
+    m_file_done = true;
+  } else {
+    this->start_read();
+  }
+
+  if ( chunk.empty() ) {
+    return false;
+  }
+
+  m_data.erase(m_data.begin(),
+               std::next(m_data.begin(), static_cast<long>(m_data_pos)));
+  m_data_pos = 0;
+  m_data.insert(m_data.end(), chunk.begin(), chunk.end());
+
+  return true;
+}
+
+// Outcome of decoding a record from the bytes read so far
+enum class decode_result { complete, incomplete, malformed };
+
+static auto decode(const char*& pos, const char* const end,
+                   std::uint64_t& hour_delta,
+                   std::vector<ship::faction>& factions,
+                   std::vector<part_set>& part_sets) -> decode_result
+{
+  // Running out of bytes is not an error here, more may be read
+  auto next {[&pos, end]() { return ehanc::read_varint(pos, end); }};
+  const auto missing {[&pos, end]() {
+    return pos == end ? decode_result::incomplete
+                      : decode_result::malformed;
+  }};
+
+  const std::optional<std::uint64_t> delta {next()};
+  const std::optional<std::uint64_t> count {
+      delta.has_value() ? next() : std::nullopt};
+  if ( not count.has_value() ) {
+    return missing();
+  }
+
+  hour_delta = *delta;
+  factions.clear();
+  part_sets.clear();
+
+  for ( std::uint64_t i {0}; i != *count; ++i ) {
+    const std::optional<std::uint64_t> fact {next()};
+    const std::optional<std::uint64_t> part_count {
+        fact.has_value() ? next() : std::nullopt};
+    if ( not part_count.has_value() ) {
+      return missing();
+    }
+
+    if ( *fact > static_cast<std::uint64_t>(ship::faction::other) ) {
+      return decode_result::malformed;
+    }
+
+    const auto faction {static_cast<ship::faction>(*fact)};
+    part_set& parts {part_sets.emplace_back()};
+    factions.push_back(faction);
+
+    for ( std::uint64_t j {0}; j != *part_count; ++j ) {
+      const std::optional<std::uint64_t> id {next()};
+      const std::optional<std::uint64_t> damage {
+          id.has_value() ? next() : std::nullopt};
+      if ( not damage.has_value() ) {
+        return missing();
+      }
+
+      if ( *id >= static_cast<std::uint64_t>(conf::part_id_limit)
+           || not ship::is_valid_part(faction, static_cast<int>(*id))
+           || *damage > 0xFFU
+           || not parts.insert(static_cast<int>(*id),
+                               static_cast<int>(*damage)) ) {
+        return decode_result::malformed;
+      }
+    }
+  }
+
+  return decode_result::complete;
+}
+
+auto reader::decode_record() -> bool
+{
+  while ( true ) {
+    const char* pos {std::next(m_data.data(),
+                               static_cast<long>(m_data_pos))};
+    const char* const end {std::next(m_data.data(),
+                                     static_cast<long>(m_data.size()))};
+
+    std::uint64_t hour_delta {0};
+    const decode_result result {
+        decode(pos, end, hour_delta, m_factions, m_part_sets)};
+
+    if ( result == decode_result::complete ) {
+      m_data_pos = static_cast<std::size_t>(pos - m_data.data());
+      m_record_hour += hour_delta;
+      m_have_record = true;
+      return true;
+    }
+
+    if ( result == decode_result::malformed ) {
+      m_failed = true;
+      return false;
+    }
+
+    // Out of bytes mid-record: read more, unless the log has ended, in
+    // which case the last record was cut off
+    if ( not this->refill() ) {
+      m_failed = m_data_pos != m_data.size();
+      return false;
+    }
+  }
+}
+
+auto reader::memory_footprint() const noexcept -> std::size_t
+{
+  std::size_t bytes {ehanc::heap_bytes(m_data)
+                     + ehanc::heap_bytes(m_factions)
+                     + ehanc::heap_bytes(m_part_sets)
+                     + ehanc::heap_bytes(m_ships)};
+
+  // A chunk being read ahead is counted once it arrives
+  for ( const part_set& parts : m_part_sets ) {
+    bytes += parts.memory_footprint();
+  }
+  for ( const ship& arriving : m_ships ) {
+    bytes += arriving.memory_footprint();
+  }
+
+  return bytes;
+}
+
+auto reader::arrivals_for(const std::uint64_t hour)
+    -> std::optional<arrival_generator::arrivals>
+{
+  m_ships.clear();
+
+  if ( not this->is_open() || m_failed ) {
+    return std::nullopt;
+  }
+
+  // Skip any hours which were never asked for
+  while ( not m_have_record || m_record_hour < hour ) {
+    m_have_record = false;
+    if ( not this->decode_record() ) {
+      return std::nullopt;
+    }
+  }
+
+  if ( m_record_hour == hour ) {
+    ship_id_allocator::block ids {m_ids.reserve(m_factions.size())};
+
+    m_ships.reserve(m_factions.size());
+    for ( std::size_t i {0}; i != m_factions.size(); ++i ) {
+      m_ships.emplace_back(ids.take(), m_factions[i],
+                           std::move(m_part_sets[i]));
+    }
+    m_have_record = false;
+  }
+
+  return arrival_generator::arrivals {m_ships.begin(), m_ships.end()};
+}
+
+} // namespace arrival_log
@@ -0,0 +1,666 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "utils/varint.hpp"
+
+#include "checkpoint.h"
+#include "part_set.h"
+#include "random.hpp"
+#include "ship.h"
+#include "ship_queue.h"
+
+namespace checkpoint {
+
+enum class record_kind : std::uint64_t { base, delta };
+
+// FNV-1a, which is enough to tell a cut off record from a whole one
+static auto checksum(const std::vector<char>& bytes) noexcept
+    -> std::uint64_t
+{
+  std::uint64_t hash {0xCBF29CE484222325U};
+  for ( const char byte : bytes ) {
+    hash ^= static_cast<unsigned char>(byte);
+    hash *= 0x100000001B3U;
+  }
+  return hash;
+}
+
+static auto zigzag(const std::int64_t value) noexcept -> std::uint64_t
+{
+  return (static_cast<std::uint64_t>(value) << 1U)
+         ^ static_cast<std::uint64_t>(value < 0 ? -1 : 0);
+}
+
+static auto unzigzag(const std::uint64_t value) noexcept -> std::int64_t
+{
+  return static_cast<std::int64_t>(value >> 1U)
+         ^ -static_cast<std::int64_t>(value & 1U);
+}
+
+static void append_ship(std::vector<char>& out, const ship::id_type id,
+                        const ship::faction fact, const part_set& parts)
+{
+  ehanc::append_varint(out, id);
+  ehanc::append_varint(out, static_cast<std::uint64_t>(fact));
+  ehanc::append_varint(out, parts.size());
+  for ( const part_set::part part : parts ) {
+    ehanc::append_varint(out, static_cast<std::uint64_t>(part.id));
+    ehanc::append_varint(out, static_cast<std::uint64_t>(part.damage));
+  }
+}
+
+static void append_ship(std::vector<char>& out, const ship& src)
+{
+  append_ship(out, src.get_id(), src.get_faction(),
+              src.get_damaged_parts_list());
+}
+
+// Ships which still wait, from the base or from incremental checkpoints
+static void append_waiting(std::vector<char>& out,
+                           const space_station& station,
+                           const ship_queue::placement where,
+                           const ship_store::record& waiting)
+{
+  const std::optional<std::uint64_t> predicted {
+      station.predicted_dock(waiting.get_id())};
+
+  ehanc::append_varint(out, where.order);
+  ehanc::append_varint(out, zigzag(where.key));
+  ehanc::append_varint(out, predicted.has_value() ? *predicted + 1 : 0);
+  append_ship(out, waiting.get_id(), waiting.get_faction(),
+              station.queue().parts(waiting));
+}
+
+// Bays are only recorded with a ship which docked while checkpointing
+static void append_bay(std::vector<char>& out,
+                       const space_station& station,
+                       const std::size_t index)
+{
+  const repair_bay& bay {station.bays()[index]};
+  if ( bay.empty() ) {
+    ehanc::append_varint(out, 0);
+    return;
+  }
+
+  ehanc::append_varint(out, station.bay_dock_hour(index) + 1);
+  // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+  append_ship(out, *bay.docked_ship());
+}
+
+// What both kinds of checkpoint begin with
+static void append_common(std::vector<char>& out, space_station& station)
+{
+  const space_station::counters saved {station.get_counters()};
+  for ( const std::uint64_t value :
+        {static_cast<std::uint64_t>(saved.step_count),
+         saved.queue_arrivals, saved.docked_ships, saved.docked_ship_hours,
+         saved.docked_bay_hours, saved.predictions.ships,
+         zigzag(saved.predictions.total_error),
+         saved.predictions.total_abs_error,
+         saved.predictions.max_abs_error,
+         static_cast<std::uint64_t>(saved.last_step.new_ships),
+         static_cast<std::uint64_t>(saved.last_step.leaving_ships)} ) {
+    ehanc::append_varint(out, value);
+  }
+
+  // Engines stream their state as integers, which are about half the
+  // size as varints as they are as text
+  std::stringstream engine;
+  engine << random_engine();
+  std::vector<std::uint64_t> state;
+  for ( std::uint64_t word {0}; engine >> word; ) {
+    state.push_back(word);
+  }
+  ehanc::append_varint(out, state.size());
+  for ( const std::uint64_t word : state ) {
+    ehanc::append_varint(out, word);
+  }
+
+  arrival_generator& arrivals {station.arrivals()};
+  const std::vector<std::size_t> counts {arrivals.pending_step_counts()};
+
+  ehanc::append_varint(out, arrivals.ids().peek());
+  ehanc::append_varint(out, counts.size());
+  std::size_t ship_count {0};
+  for ( const std::size_t count : counts ) {
+    ehanc::append_varint(out, count);
+    ship_count += count;
+  }
+  for ( std::size_t i {0}; i != ship_count; ++i ) {
+    append_ship(out, arrivals.pending_ship(i));
+  }
+}
+
+writer::writer(std::string path, const std::size_t deltas_per_base)
+    : m_path {std::move(path)}
+    , m_deltas_per_base {deltas_per_base}
+{}
+
+writer::~writer() noexcept
+{
+  this->close();
+}
+
+auto writer::append_record(std::FILE* const file) noexcept -> bool
+{
+  const std::uint64_t sum {checksum(m_payload)};
+
+  try {
+    ehanc::append_varint(m_record, m_payload.size());
+    m_record.insert(m_record.end(), m_payload.cbegin(), m_payload.cend());
+    for ( unsigned shift {0}; shift != 64; shift += 8 ) {
+      m_record.push_back(static_cast<char>((sum >> shift) & 0xFFU));
+    }
+  } catch ( ... ) {
+    return false;
+  }
+
+  // Flushed at once, so that at most the last record can be cut off
+  return std::fwrite(m_record.data(), 1, m_record.size(), file)
+             == m_record.size()
+         && std::fflush(file) == 0;
+}
+
+auto writer::write_base(space_station& station) noexcept -> bool
+{
+  try {
+    m_payload.clear();
+    append_common(m_payload, station);
+
+    ehanc::append_varint(
+        m_payload, static_cast<std::uint64_t>(station.queue_policy()));
+    ehanc::append_varint(m_payload, station.bays().size());
+    for ( std::size_t i {0}; i != station.bays().size(); ++i ) {
+      append_bay(m_payload, station, i);
+    }
+
+    ehanc::append_varint(m_payload, station.queue_size());
+    station.queue().for_each_waiting(
+        [this, &station](const ship_queue::placement where,
+                         const ship_store::record& waiting) {
+          append_waiting(m_payload, station, where, waiting);
+        });
+
+    m_record.assign(magic.cbegin(), magic.cend());
+    ehanc::append_varint(m_record,
+                         static_cast<std::uint64_t>(record_kind::base));
+  } catch ( ... ) {
+    return false;
+  }
+
+  // The old checkpoint stays whole until the new one is
+  const std::string temp_path {m_path + ".tmp"};
+  std::FILE* const temp {std::fopen(temp_path.c_str(), "wb")};
+  if ( temp == nullptr ) {
+    return false;
+  }
+  const bool written {this->append_record(temp)};
+  if ( std::fclose(temp) != 0 || not written ) {
+    return false;
+  }
+
+  this->close();
+  if ( std::rename(temp_path.c_str(), m_path.c_str()) != 0 ) {
+    return false;
+  }
+
+  m_file = std::fopen(m_path.c_str(), "ab");
+  return m_file != nullptr;
+}
+
+auto writer::write_delta(space_station& station) noexcept -> bool
+{
+  try {
+    m_payload.clear();
+    append_common(m_payload, station);
+
+    const std::vector<std::size_t>& bays {station.changed_bays()};
+    ehanc::append_varint(m_payload, bays.size());
+    for ( const std::size_t index : bays ) {
+      ehanc::append_varint(m_payload, index);
+      append_bay(m_payload, station, index);
+    }
+
+    const std::vector<std::uint64_t>& popped {station.queue().popped()};
+    ehanc::append_varint(m_payload, popped.size());
+    for ( const std::uint64_t order : popped ) {
+      ehanc::append_varint(m_payload, order);
+    }
+
+    // Counted first, as the count comes before the ships
+    std::size_t pushed {0};
+    station.queue().for_each_pushed(
+        [&pushed](const ship_queue::placement /*unused*/,
+                  const ship_store::record& /*unused*/) { ++pushed; });
+    ehanc::append_varint(m_payload, pushed);
+    station.queue().for_each_pushed(
+        [this, &station](const ship_queue::placement where,
+                         const ship_store::record& waiting) {
+          append_waiting(m_payload, station, where, waiting);
+        });
+
+    m_record.clear();
+    ehanc::append_varint(m_record,
+                         static_cast<std::uint64_t>(record_kind::delta));
+  } catch ( ... ) {
+    return false;
+  }
+
+  return this->append_record(m_file);
+}
+
+auto writer::save(space_station& station) noexcept -> bool
+{
+  if ( m_file != nullptr && m_deltas.has_value()
+       && *m_deltas < m_deltas_per_base ) {
+    if ( not this->write_delta(station) ) {
+      m_deltas.reset();
+      return false;
+    }
+    ++*m_deltas;
+    station.clear_changes();
+    return true;
+  }
+
+  if ( not this->write_base(station) ) {
+    m_deltas.reset();
+    return false;
+  }
+  m_deltas = 0;
+  station.track_changes(true);
+  return true;
+}
+
+auto writer::close() noexcept -> bool
+{
+  if ( m_file == nullptr ) {
+    return false;
+  }
+
+  const bool closed {std::fclose(m_file) == 0};
+  m_file = nullptr;
+
+  return closed;
+}
+
+// Station as the checkpoints read so far left it
+struct saved_ship {
+  ship::id_type id;
+  ship::faction fact;
+  part_set parts;
+};
+
+struct saved_bay {
+  std::uint64_t dock_hour;
+  saved_ship docked;
+};
+
+struct saved_waiting {
+  std::int64_t key;
+  std::optional<std::uint64_t> predicted;
+  saved_ship waiting;
+};
+
+struct image {
+  space_station::counters counters {};
+  conf::random_engine engine {};
+  ship::id_type next_id {0};
+  std::vector<std::size_t> pending_counts {};
+  std::vector<saved_ship> pending {};
+  std::size_t policy {0};
+  std::vector<std::optional<saved_bay>> bays {};
+  std::map<std::uint64_t, saved_waiting> waiting {};
+};
+
+// Reads varints from one payload, remembering if any were missing
+class payload_reader
+{
+private:
+
+  const char* m_pos;
+  const char* m_end;
+  bool m_failed {false};
+
+public:
+
+  payload_reader(const char* const pos, const char* const end) noexcept
+      : m_pos {pos}
+      , m_end {end}
+  {}
+
+  auto next() noexcept -> std::uint64_t
+  {
+    const std::optional<std::uint64_t> value {
+        ehanc::read_varint(m_pos, m_end)};
+    if ( not value.has_value() ) {
+      m_failed = true;
+      return 0;
+    }
+    return *value;
+  }
+
+  [[nodiscard]] auto failed() const noexcept -> bool
+  {
+    return m_failed;
+  }
+
+  [[nodiscard]] auto done() const noexcept -> bool
+  {
+    return m_pos == m_end;
+  }
+};
+
+static auto read_ship(payload_reader& in) -> std::optional<saved_ship>
+{
+  const ship::id_type id {in.next()};
+  const std::uint64_t fact {in.next()};
+  const std::uint64_t part_count {in.next()};
+  if ( in.failed()
+       || fact > static_cast<std::uint64_t>(ship::faction::other) ) {
+    return std::nullopt;
+  }
+
+  saved_ship retval {id, static_cast<ship::faction>(fact), part_set {}};
+  for ( std::uint64_t i {0}; i != part_count; ++i ) {
+    const std::uint64_t part_id {in.next()};
+    const std::uint64_t damage {in.next()};
+    if ( in.failed()
+         || part_id >= static_cast<std::uint64_t>(conf::part_id_limit)
+         || not ship::is_valid_part(retval.fact,
+                                    static_cast<int>(part_id))
+         || damage > 0xFFU
+         || not retval.parts.insert(static_cast<int>(part_id),
+                                    static_cast<int>(damage)) ) {
+      return std::nullopt;
+    }
+  }
+
+  return retval;
+}
+
+static auto read_common(payload_reader& in, image& saved) -> bool
+{
+  space_station::counters& counters {saved.counters};
+  counters.step_count = static_cast<std::size_t>(in.next());
+  counters.queue_arrivals = in.next();
+  counters.docked_ships = in.next();
+  counters.docked_ship_hours = in.next();
+  counters.docked_bay_hours = in.next();
+  counters.predictions.ships = in.next();
+  counters.predictions.total_error = unzigzag(in.next());
+  counters.predictions.total_abs_error = in.next();
+  counters.predictions.max_abs_error = in.next();
+  counters.last_step.new_ships = static_cast<std::size_t>(in.next());
+  counters.last_step.leaving_ships = static_cast<std::size_t>(in.next());
+
+  const std::uint64_t state_size {in.next()};
+  std::stringstream engine;
+  for ( std::uint64_t i {0}; i != state_size && not in.failed(); ++i ) {
+    engine << in.next() << ' ';
+  }
+  engine >> saved.engine;
+  if ( in.failed() || engine.fail() ) {
+    return false;
+  }
+
+  saved.next_id = in.next();
+  const std::uint64_t step_count {in.next()};
+  saved.pending_counts.clear();
+  std::uint64_t ship_count {0};
+  for ( std::uint64_t i {0}; i != step_count && not in.failed(); ++i ) {
+    saved.pending_counts.push_back(static_cast<std::size_t>(in.next()));
+    ship_count += saved.pending_counts.back();
+  }
+
+  saved.pending.clear();
+  for ( std::uint64_t i {0}; i != ship_count && not in.failed(); ++i ) {
+    std::optional<saved_ship> pending {read_ship(in)};
+    if ( not pending.has_value() ) {
+      return false;
+    }
+    saved.pending.push_back(std::move(*pending));
+  }
+
+  return not in.failed();
+}
+
+static auto read_bay(payload_reader& in, std::optional<saved_bay>& bay)
+    -> bool
+{
+  const std::uint64_t dock_hour {in.next()};
+  if ( in.failed() ) {
+    return false;
+  }
+  if ( dock_hour == 0 ) {
+    bay.reset();
+    return true;
+  }
+
+  std::optional<saved_ship> docked {read_ship(in)};
+  if ( not docked.has_value() ) {
+    return false;
+  }
+  bay = saved_bay {dock_hour - 1, std::move(*docked)};
+  return true;
+}
+
+static auto read_waiting(payload_reader& in, image& saved) -> bool
+{
+  const std::uint64_t order {in.next()};
+  const std::int64_t key {unzigzag(in.next())};
+  const std::uint64_t predicted {in.next()};
+
+  std::optional<saved_ship> waiting {read_ship(in)};
+  if ( not waiting.has_value() ) {
+    return false;
+  }
+
+  saved.waiting.insert_or_assign(
+      order, saved_waiting {key,
+                            predicted == 0
+                                ? std::nullopt
+                                : std::optional<std::uint64_t> {predicted
+                                                                - 1},
+                            std::move(*waiting)});
+  return true;
+}
+
+static auto read_base(payload_reader& in, image& saved) -> bool
+{
+  if ( not read_common(in, saved) ) {
+    return false;
+  }
+
+  saved.policy = static_cast<std::size_t>(in.next());
+  const std::uint64_t bay_count {in.next()};
+  saved.bays.clear();
+  for ( std::uint64_t i {0}; i != bay_count && not in.failed(); ++i ) {
+    if ( not read_bay(in, saved.bays.emplace_back()) ) {
+      return false;
+    }
+  }
+
+  const std::uint64_t waiting_count {in.next()};
+  saved.waiting.clear();
+  for ( std::uint64_t i {0}; i != waiting_count && not in.failed();
+        ++i ) {
+    if ( not read_waiting(in, saved) ) {
+      return false;
+    }
+  }
+
+  return not in.failed() && in.done();
+}
+
+static auto read_delta(payload_reader& in, image& saved) -> bool
+{
+  if ( not read_common(in, saved) ) {
+    return false;
+  }
+
+  const std::uint64_t bay_count {in.next()};
+  for ( std::uint64_t i {0}; i != bay_count && not in.failed(); ++i ) {
+    const std::uint64_t index {in.next()};
+    if ( index >= saved.bays.size()
+         || not read_bay(in, saved.bays[index]) ) {
+      return false;
+    }
+  }
+
+  const std::uint64_t popped_count {in.next()};
+  for ( std::uint64_t i {0}; i != popped_count && not in.failed(); ++i ) {
+    if ( saved.waiting.erase(in.next()) == 0 ) {
+      return false;
+    }
+  }
+
+  const std::uint64_t pushed_count {in.next()};
+  for ( std::uint64_t i {0}; i != pushed_count && not in.failed(); ++i ) {
+    if ( not read_waiting(in, saved) ) {
+      return false;
+    }
+  }
+
+  return not in.failed() && in.done();
+}
+
+static auto read_file(const std::string& path)
+    -> std::optional<std::vector<char>>
+{
+  std::FILE* const file {std::fopen(path.c_str(), "rb")};
+  if ( file == nullptr ) {
+    return std::nullopt;
+  }
+
+  std::vector<char> bytes;
+  std::array<char, 1U << 16U> chunk {};
+  std::size_t read {0};
+  while ( (read = std::fread(chunk.data(), 1, chunk.size(), file)) != 0 ) {
+    bytes.insert(bytes.end(), chunk.cbegin(),
+                 std::next(chunk.cbegin(), static_cast<long>(read)));
+  }
+
+  const bool failed {std::ferror(file) != 0};
+  std::fclose(file);
+  if ( failed ) {
+    return std::nullopt;
+  }
+  return bytes;
+}
+
+// Reads every whole record into `saved`, stopping at the first which is
+// cut off, and returns false if a whole record is malformed
+static auto read_records(const std::vector<char>& bytes, image& saved)
+    -> bool
+{
+  const char* pos {std::next(bytes.data(),
+                             static_cast<long>(magic.size()))};
+  const char* const end {std::next(bytes.data(),
+                                   static_cast<long>(bytes.size()))};
+  bool have_base {false};
+  std::vector<char> payload;
+
+  while ( pos != end ) {
+    const std::optional<std::uint64_t> kind {ehanc::read_varint(pos, end)};
+    const std::optional<std::uint64_t> size {
+        kind.has_value() ? ehanc::read_varint(pos, end) : std::nullopt};
+    if ( not size.has_value()
+         || *size + 8 > static_cast<std::uint64_t>(end - pos) ) {
+      break;
+    }
+
+    payload.assign(pos, pos + *size);
+    pos += *size;
+    std::uint64_t sum {0};
+    for ( unsigned shift {0}; shift != 64; shift += 8 ) {
+      sum |= static_cast<std::uint64_t>(static_cast<unsigned char>(*pos++))
+             << shift;
+    }
+    if ( sum != checksum(payload) ) {
+      break;
+    }
+
+    payload_reader in {payload.data(),
+                       std::next(payload.data(),
+                                 static_cast<long>(payload.size()))};
+    if ( *kind == static_cast<std::uint64_t>(record_kind::base)
+         && not have_base ) {
+      have_base = true;
+      if ( not read_base(in, saved) ) {
+        return false;
+      }
+    } else if ( *kind == static_cast<std::uint64_t>(record_kind::delta)
+                && have_base ) {
+      if ( not read_delta(in, saved) ) {
+        return false;
+      }
+    } else {
+      return false;
+    }
+  }
+
+  return have_base;
+}
+
+auto restore(const std::string& path, space_station& station)
+    -> std::optional<std::uint64_t>
+{
+  const std::optional<std::vector<char>> bytes {read_file(path)};
+  if ( not bytes.has_value() || bytes->size() < magic.size()
+       || not std::equal(magic.cbegin(), magic.cend(),
+                         bytes->cbegin()) ) {
+    return std::nullopt;
+  }
+
+  image saved;
+  if ( not read_records(*bytes, saved)
+       || saved.policy
+              != static_cast<std::size_t>(station.queue_policy())
+       || saved.bays.size() != station.bays().size() ) {
+    return std::nullopt;
+  }
+
+  station.restore_counters(saved.counters);
+  random_engine() = saved.engine;
+
+  std::vector<ship> pending;
+  pending.reserve(saved.pending.size());
+  for ( saved_ship& src : saved.pending ) {
+    pending.emplace_back(src.id, src.fact, std::move(src.parts));
+  }
+  station.arrivals().restore(std::move(saved.pending_counts),
+                             std::move(pending), saved.next_id);
+
+  for ( std::size_t i {0}; i != saved.bays.size(); ++i ) {
+    std::optional<saved_bay>& bay {saved.bays[i]};
+    if ( bay.has_value() ) {
+      station.restore_bay(i,
+                          ship(bay->docked.id, bay->docked.fact,
+                               std::move(bay->docked.parts)),
+                          bay->dock_hour);
+    }
+  }
+
+  // In order of arrival, as the queue needs
+  for ( auto& [order, waiting] : saved.waiting ) {
+    station.restore_waiting(
+        ship_queue::placement {order, waiting.key},
+        ship(waiting.waiting.id, waiting.waiting.fact,
+             std::move(waiting.waiting.parts)),
+        waiting.predicted);
+  }
+
+  return saved.counters.step_count;
+}
+
+} // namespace checkpoint
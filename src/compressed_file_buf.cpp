@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <ios>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "utils/memory.hpp"
+
+#include "compressed_file_buf.h"
+#include "lz4.h"
+
+compressed_file_buf::compressed_file_buf(const std::string& path,
+                                         std::size_t block_size,
+                                         std::size_t queue_depth)
+    : m_block_size {std::clamp(block_size, std::size_t {1},
+                               lz4::max_block_size)}
+    , m_queue_depth {std::max(queue_depth, std::size_t {1})}
+{
+  m_file = std::fopen(path.c_str(), "wb");
+
+  if ( m_file == nullptr ) {
+    return;
+  }
+
+  const auto header {lz4::frame_header()};
+  if ( std::fwrite(header.data(), 1, header.size(), m_file)
+       != header.size() ) {
+    std::fclose(m_file);
+    m_file = nullptr;
+    return;
+  }
+
+  m_block.resize(m_block_size);
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  this->setp(m_block.data(), m_block.data() + m_block.size());
+
+  m_compressor = std::thread(&compressed_file_buf::compress_pending, this);
+}
+
+compressed_file_buf::~compressed_file_buf() noexcept
+{
+  compressed_file_buf::close();
+}
+
+auto compressed_file_buf::hand_off() -> bool
+{
+  const auto used {static_cast<std::size_t>(this->pptr() - this->pbase())};
+
+  if ( used == 0 ) {
+    return true;
+  }
+
+  m_block.resize(used);
+
+  std::unique_lock lock(m_mutex);
+  m_space_ready.wait(lock, [this]() {
+    return m_pending.size() < m_queue_depth || m_failed;
+  });
+
+  const bool failed {m_failed};
+
+  m_pending.push_back(std::move(m_block));
+  m_handed_off += used;
+
+  // Reuse the storage of a block which has already been compressed
+  if ( m_spare.empty() ) {
+    m_block = std::vector<char> {};
+  } else {
+    m_block = std::move(m_spare.back());
+    m_spare.pop_back();
+  }
+
+  lock.unlock();
+  m_work_ready.notify_one();
+
+  m_block.resize(m_block_size);
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  this->setp(m_block.data(), m_block.data() + m_block.size());
+
+  return not failed;
+}
+
+void compressed_file_buf::compress_pending() noexcept
+{
+  lz4::block_compressor compressor;
+  std::vector<char> encoded;
+
+  // Where the next block goes, in the file and in the uncompressed log
+  block_position next {lz4::frame_header().size(), 0};
+
+  std::unique_lock lock(m_mutex);
+
+  while ( true ) {
+    m_work_ready.wait(lock, [this]() {
+      return not m_pending.empty() || m_finishing;
+    });
+
+    // Only stop once everything has been compressed
+    if ( m_pending.empty() ) {
+      return;
+    }
+
+    std::vector<char> block {std::move(m_pending.front())};
+    m_pending.pop_front();
+    const bool failed {m_failed};
+
+    lock.unlock();
+    m_space_ready.notify_one();
+
+    bool written {false};
+    if ( not failed ) {
+      try {
+        encoded.clear();
+        lz4::encode_block(compressor, block.data(), block.size(), encoded);
+        written = std::fwrite(encoded.data(), 1, encoded.size(), m_file)
+                  == encoded.size();
+      } catch ( ... ) {
+        written = false;
+      }
+    }
+
+    m_compressor_bytes.store(compressor.memory_footprint()
+                                 + ehanc::heap_bytes(encoded),
+                             std::memory_order_relaxed);
+
+    lock.lock();
+    m_failed = m_failed || not written;
+    if ( written ) {
+      m_written_blocks.push_back(next);
+      m_written_bytes += block.size();
+      next.file_offset += encoded.size();
+      next.start += block.size();
+    }
+    m_spare.push_back(std::move(block));
+  }
+}
+
+auto compressed_file_buf::overflow(int_type ch) -> int_type
+{
+  if ( not this->is_open() || not this->hand_off() ) {
+    return traits_type::eof();
+  }
+
+  if ( not traits_type::eq_int_type(ch, traits_type::eof()) ) {
+    *this->pptr() = traits_type::to_char_type(ch);
+    this->pbump(1);
+  }
+
+  return traits_type::not_eof(ch);
+}
+
+auto compressed_file_buf::sync() -> int
+{
+  return this->is_open() && this->hand_off() ? 0 : -1;
+}
+
+auto compressed_file_buf::seekoff(off_type off, std::ios_base::seekdir dir,
+                                  std::ios_base::openmode which)
+    -> pos_type
+{
+  // Only reporting the current position is supported, for tellp()
+  if ( off != 0 || dir != std::ios_base::cur
+       || (which & std::ios_base::out) == 0 || not this->is_open() ) {
+    return pos_type(off_type(-1));
+  }
+
+  return pos_type(static_cast<off_type>(this->size()));
+}
+
+auto compressed_file_buf::close() noexcept -> bool
+{
+  if ( not this->is_open() ) {
+    return false;
+  }
+
+  bool handed_off {false};
+  try {
+    handed_off = this->hand_off();
+  } catch ( ... ) {
+    handed_off = false;
+  }
+
+  {
+    const std::lock_guard lock(m_mutex);
+    m_finishing = true;
+  }
+  m_work_ready.notify_one();
+  m_compressor.join();
+
+  bool finished {handed_off && not m_failed
+                 && std::fwrite(lz4::frame_end.data(), 1,
+                                lz4::frame_end.size(), m_file)
+                        == lz4::frame_end.size()};
+
+  finished = (std::fclose(m_file) == 0) && finished;
+  m_file   = nullptr;
+  this->setp(nullptr, nullptr);
+
+  return finished;
+}
+
+auto compressed_file_buf::memory_footprint() const noexcept -> std::size_t
+{
+  std::size_t bytes {ehanc::heap_bytes(m_block)
+                     + m_compressor_bytes.load(std::memory_order_relaxed)};
+
+  const std::lock_guard lock(m_mutex);
+  bytes += ehanc::heap_bytes(m_pending) + ehanc::heap_bytes(m_spare)
+           + ehanc::heap_bytes(m_written_blocks);
+  for ( const std::vector<char>& block : m_pending ) {
+    bytes += ehanc::heap_bytes(block);
+  }
+  for ( const std::vector<char>& block : m_spare ) {
+    bytes += ehanc::heap_bytes(block);
+  }
+
+  return bytes;
+}
+
+auto compressed_file_buf::block_at(const std::uint64_t offset) const
+    -> std::optional<block_position>
+{
+  const std::lock_guard lock(m_mutex);
+
+  if ( offset >= m_written_bytes ) {
+    return std::nullopt;
+  }
+
+  // Last block starting at or before offset
+  const auto after {std::upper_bound(
+      m_written_blocks.cbegin(), m_written_blocks.cend(), offset,
+      [](const std::uint64_t value, const block_position& block) {
+        return value < block.start;
+      })};
+
+  return *std::prev(after);
+}
@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "utils/algorithm.hpp"
+#include "utils/execution.hpp"
+#include "utils/memory.hpp"
+
+#include "lockstep.h"
+
+lockstep::lockstep(std::vector<config> configs,
+                   const std::size_t batch_steps, std::size_t threads)
+    : m_configs {std::move(configs)}
+    , m_batch_steps {std::max(batch_steps, std::size_t {1})}
+    , m_pool {threads == 0 ? std::min<std::size_t>(
+                  std::max(std::thread::hardware_concurrency(), 1U),
+                  std::max(m_configs.size(), std::size_t {1}))
+                           : threads}
+{
+  m_stations.reserve(m_configs.size());
+  for ( const config& setup : m_configs ) {
+    m_stations.push_back(std::make_unique<space_station>(
+        "Zebra (" + std::to_string(setup.bays.size()) + " bays, "
+            + std::string {ship_queue::policy_name(setup.order)} + ")",
+        setup.bays, setup.order));
+  }
+
+  m_totals.resize(m_configs.size());
+  m_staging.resize(m_configs.size());
+}
+
+void lockstep::generate_batch(const std::size_t steps)
+{
+  m_batch.clear();
+  m_batch_counts.clear();
+
+  for ( std::size_t i {0}; i != steps; ++i ) {
+    const arrival_generator::arrivals arriving {m_arrivals.next_step()};
+    m_batch_counts.push_back(arriving.size());
+    m_batch.insert(m_batch.end(),
+                   std::make_move_iterator(arriving.begin()),
+                   std::make_move_iterator(arriving.end()));
+  }
+}
+
+void lockstep::run_batch(space_station& station, totals& sums,
+                         std::vector<ship>& staging) const noexcept
+{
+  // Every station reads the batch, none changes it
+  auto first {m_batch.cbegin()};
+
+  for ( const std::size_t count : m_batch_counts ) {
+    staging.clear();
+    std::transform(first, std::next(first, static_cast<long>(count)),
+                   std::back_inserter(staging),
+                   [](const ship& arriving) { return arriving.clone(); });
+    std::advance(first, static_cast<long>(count));
+
+    const space_station::step_summary summary {
+        station.step(staging.begin(), staging.end())};
+
+    sums.arrived += summary.new_ships;
+    sums.repaired += summary.leaving_ships;
+    sums.queue_hours += station.queue_size();
+    sums.occupied_bay_hours += static_cast<std::uint64_t>(
+        station.occupied_bay_count());
+    sums.max_queue_size = std::max(sums.max_queue_size,
+                                   station.queue_size());
+  }
+}
+
+void lockstep::run(std::size_t steps)
+{
+  const ehanc::execution::parallel_policy policy {
+      ehanc::execution::par.on(m_pool)};
+  const auto task {[this](const std::unique_ptr<space_station>& station,
+                          totals& sums, std::vector<ship>& staging) {
+    this->run_batch(*station, sums, staging);
+  }};
+
+  while ( steps != 0 ) {
+    const std::size_t batch {std::min(steps, m_batch_steps)};
+    this->generate_batch(batch);
+    ehanc::for_each_all(policy, task, m_stations, m_totals, m_staging);
+    steps -= batch;
+  }
+}
+
+auto lockstep::largest_queue_size() const noexcept -> std::size_t
+{
+  std::size_t largest {0};
+  for ( const auto& station : m_stations ) {
+    largest = std::max(largest, station->queue_size());
+  }
+  return largest;
+}
+
+auto lockstep::memory_footprint() const noexcept -> std::size_t
+{
+  std::size_t bytes {ehanc::heap_bytes(m_configs)
+                     + ehanc::heap_bytes(m_stations)
+                     + ehanc::heap_bytes(m_totals)
+                     + ehanc::heap_bytes(m_staging)
+                     + ehanc::heap_bytes(m_batch)
+                     + ehanc::heap_bytes(m_batch_counts)
+                     + m_arrivals.memory_footprint()};
+
+  for ( std::size_t i {0}; i != m_stations.size(); ++i ) {
+    bytes += sizeof(space_station) + m_stations[i]->memory_footprint()
+             + ehanc::heap_bytes(m_configs[i].bays)
+             + ehanc::heap_bytes(m_staging[i]);
+  }
+  for ( const ship& arriving : m_batch ) {
+    bytes += arriving.memory_footprint();
+  }
+
+  return bytes;
+}
+
+void lockstep::display_summary(std::ostream& out) const
+{
+  out << std::setw(6) << "Bays" << std::setw(10) << "Policy"
+      << std::setw(10) << "Arrived"
+      << std::setw(10) << "Repaired" << std::setw(12) << "Mean queue"
+      << std::setw(11) << "Max queue" << std::setw(13) << "Final queue"
+      << std::setw(9) << "Bay use" << '\n';
+
+  const std::ios_base::fmtflags flags {out.flags()};
+  const std::streamsize precision {out.precision()};
+  out << std::fixed << std::setprecision(1);
+
+  for ( std::size_t i {0}; i != m_stations.size(); ++i ) {
+    const totals& sums {m_totals[i]};
+    const auto hours {static_cast<double>(
+        std::max(m_stations[i]->step_count(), std::size_t {1}))};
+    const auto bays {static_cast<double>(
+        std::max(m_configs[i].bays.size(), std::size_t {1}))};
+
+    out << std::setw(6) << m_configs[i].bays.size() << std::setw(10)
+        << ship_queue::policy_name(m_configs[i].order) << std::setw(10)
+        << sums.arrived << std::setw(10) << sums.repaired << std::setw(12)
+        << static_cast<double>(sums.queue_hours) / hours << std::setw(11)
+        << sums.max_queue_size << std::setw(13)
+        << m_stations[i]->queue_size() << std::setw(8)
+        << 100.0 * static_cast<double>(sums.occupied_bay_hours)
+               / (hours * bays)
+        << '%' << '\n';
+  }
+
+  out.flags(flags);
+  out.precision(precision);
+}
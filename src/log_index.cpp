@@ -0,0 +1,325 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <ios>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "log_index.h"
+#include "lz4.h"
+
+namespace log_index {
+
+// First bytes of a log written with --compress-log
+constexpr static std::array<char, 4> compressed_magic {0x04, 0x22, 0x4D,
+                                                       0x18};
+
+static void append_le64(std::vector<char>& out, const std::uint64_t value)
+{
+  for ( unsigned shift {0}; shift != 64; shift += 8 ) {
+    out.push_back(static_cast<char>((value >> shift) & 0xFFU));
+  }
+}
+
+static auto load_le64(const char* const src) noexcept -> std::uint64_t
+{
+  std::uint64_t value {0};
+  for ( unsigned i {0}; i != 8; ++i ) {
+    value |= static_cast<std::uint64_t>(static_cast<unsigned char>(src[i]))
+             << (8 * i);
+  }
+  return value;
+}
+
+auto index_path(const std::string& log_path) -> std::string
+{
+  return log_path + ".idx";
+}
+
+writer::writer(const std::string& path, std::size_t flush_interval,
+               const log_buf* const log)
+    : m_flush_interval {std::max(flush_interval, std::size_t {1})}
+    , m_log {log}
+{
+  m_file = std::fopen(path.c_str(), "wb");
+
+  if ( m_file == nullptr ) {
+    return;
+  }
+
+  m_pending.reserve(m_flush_interval * record_size);
+
+  if ( std::fwrite(magic.data(), 1, magic.size(), m_file) != magic.size()
+       || std::fflush(m_file) != 0 ) {
+    std::fclose(m_file);
+    m_file = nullptr;
+  }
+}
+
+writer::~writer() noexcept
+{
+  this->close();
+}
+
+auto writer::add(const std::uint64_t step, const std::uint64_t offset)
+    -> bool
+{
+  if ( not this->is_open() ) {
+    return false;
+  }
+
+  m_unplaced.push_back(entry {step, offset, {offset, offset}});
+  this->place_records();
+
+  if ( m_pending.size() >= m_flush_interval * record_size ) {
+    return this->flush();
+  }
+
+  return true;
+}
+
+void writer::place_records()
+{
+  std::size_t placed {0};
+
+  for ( ; placed != m_unplaced.size(); ++placed ) {
+    entry& record {m_unplaced[placed]};
+
+    if ( m_log != nullptr ) {
+      const std::optional<log_buf::block_position> block {
+          m_log->block_at(record.offset)};
+      // Blocks reach the log in order, so neither have the ones after
+      if ( not block.has_value() ) {
+        break;
+      }
+      record.block = *block;
+    }
+
+    append_le64(m_pending, record.step);
+    append_le64(m_pending, record.offset);
+    append_le64(m_pending, record.block.file_offset);
+    append_le64(m_pending, record.block.start);
+  }
+
+  m_unplaced.erase(m_unplaced.begin(),
+                   std::next(m_unplaced.begin(),
+                             static_cast<std::ptrdiff_t>(placed)));
+}
+
+auto writer::flush() noexcept -> bool
+{
+  if ( not this->is_open() ) {
+    return false;
+  }
+
+  this->place_records();
+
+  // Records are only ever written whole, and pushed out of this
+  // process right away, so the file is usable however a run ends
+  const bool written {
+      std::fwrite(m_pending.data(), 1, m_pending.size(), m_file)
+          == m_pending.size()
+      && std::fflush(m_file) == 0};
+
+  m_pending.clear();
+
+  return written;
+}
+
+auto writer::close() noexcept -> bool
+{
+  if ( not this->is_open() ) {
+    return false;
+  }
+
+  const bool flushed {this->flush()};
+  const bool closed {std::fclose(m_file) == 0};
+  m_file = nullptr;
+  m_unplaced.clear();
+
+  return flushed && closed;
+}
+
+reader::reader(const std::string& path)
+    : m_file(path, std::ios::binary)
+{
+  std::array<char, magic.size()> header {};
+
+  if ( not m_file.read(header.data(), header.size()) || header != magic ) {
+    m_file.close();
+    return;
+  }
+
+  m_file.seekg(0, std::ios::end);
+  const auto file_size {static_cast<std::uint64_t>(m_file.tellg())};
+
+  m_size = (file_size - magic.size()) / record_size;
+}
+
+auto reader::read(const std::uint64_t index) const -> entry
+{
+  std::array<char, record_size> record {};
+
+  m_file.seekg(static_cast<std::streamoff>(magic.size()
+                                           + (index * record_size)));
+  m_file.read(record.data(), record.size());
+
+  return {load_le64(record.data()),
+          load_le64(&record[8]),
+          {load_le64(&record[16]), load_le64(&record[24])}};
+}
+
+auto reader::find(const std::uint64_t step) const -> std::optional<entry>
+{
+  if ( not this->is_open() ) {
+    return std::nullopt;
+  }
+
+  // Binary search for the first record of a step not before step
+  std::uint64_t first {0};
+  std::uint64_t count {m_size};
+
+  while ( count != 0 ) {
+    const std::uint64_t half {count / 2};
+
+    if ( this->read(first + half).step < step ) {
+      first += half + 1;
+      count -= half + 1;
+    } else {
+      count = half;
+    }
+  }
+
+  if ( first == m_size ) {
+    return std::nullopt;
+  }
+
+  return this->read(first);
+}
+
+// Forwards the bytes written to it in [begin, end) to another stream,
+// and fails once it is past the end, to stop whatever is writing
+class range_buf : public std::streambuf
+{
+private:
+
+  std::ostream& m_out;
+  std::uint64_t m_begin;
+  std::optional<std::uint64_t> m_end;
+  std::uint64_t m_pos {0};
+
+protected:
+
+  auto xsputn(const char* const data, const std::streamsize count)
+      -> std::streamsize override
+  {
+    if ( m_end.has_value() && m_pos >= *m_end ) {
+      return 0;
+    }
+
+    const std::uint64_t data_end {m_pos
+                                  + static_cast<std::uint64_t>(count)};
+    const std::uint64_t first {std::clamp(m_begin, m_pos, data_end)};
+    const std::uint64_t last {
+        m_end.has_value() ? std::clamp(*m_end, first, data_end)
+                          : data_end};
+
+    m_out.write(data + (first - m_pos),
+                static_cast<std::streamsize>(last - first));
+    m_pos = data_end;
+
+    return m_out ? count : 0;
+  }
+
+  auto overflow(const int_type ch) -> int_type override
+  {
+    if ( traits_type::eq_int_type(ch, traits_type::eof()) ) {
+      return traits_type::not_eof(ch);
+    }
+
+    const char data {traits_type::to_char_type(ch)};
+    return this->xsputn(&data, 1) == 1 ? ch : traits_type::eof();
+  }
+
+public:
+
+  range_buf(std::ostream& out, const std::uint64_t begin,
+            const std::optional<std::uint64_t> end)
+      : m_out {out}
+      , m_begin {begin}
+      , m_end {end}
+  {}
+
+  [[nodiscard]] auto done() const noexcept -> bool
+  {
+    return not m_end.has_value() || m_pos >= *m_end;
+  }
+};
+
+auto copy_steps(const std::string& log_path, const std::uint64_t first,
+                const std::uint64_t last, std::ostream& out) -> bool
+{
+  const reader index(index_path(log_path));
+  const std::optional<entry> begin {index.find(first)};
+
+  if ( not begin.has_value() || begin->step > last ) {
+    return false;
+  }
+
+  // The range ends where the step after it begins, or else at the end
+  // of the log
+  std::optional<std::uint64_t> end;
+  if ( const auto after {index.find(last + 1)}; after.has_value() ) {
+    end = after->offset;
+  }
+
+  std::ifstream log(log_path, std::ios::binary);
+  std::array<char, compressed_magic.size()> header {};
+
+  if ( not log.read(header.data(), header.size()) ) {
+    return false;
+  }
+
+  if ( header == compressed_magic ) {
+    // Blocks are independent, so decompression can start at the one the
+    // range begins in, with offsets counted from the start of that block
+    const std::uint64_t block_start {begin->block.start};
+    if ( end.has_value() ) {
+      *end -= block_start;
+    }
+
+    log.seekg(static_cast<std::streamoff>(begin->block.file_offset));
+
+    range_buf range(out, begin->offset - block_start, end);
+    std::ostream range_out(&range);
+
+    return lz4::decompress_frame_blocks(log, range_out) || range.done();
+  }
+
+  log.seekg(static_cast<std::streamoff>(begin->offset));
+
+  std::vector<char> buffer(std::size_t {1} << 16U);
+  std::uint64_t remaining {
+      end.value_or(std::numeric_limits<std::uint64_t>::max())
+      - begin->offset};
+
+  while ( remaining != 0 && log ) {
+    const std::uint64_t chunk {
+        std::min(remaining, std::uint64_t {buffer.size()})};
+    log.read(buffer.data(), static_cast<std::streamsize>(chunk));
+    out.write(buffer.data(), log.gcount());
+    remaining -= static_cast<std::uint64_t>(log.gcount());
+  }
+
+  return static_cast<bool>(out);
+}
+
+} // namespace log_index
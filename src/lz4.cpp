@@ -0,0 +1,471 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+#include "lz4.h"
+
+namespace lz4 {
+
+// Block format limits
+constexpr static std::size_t min_match {4};
+constexpr static std::size_t last_literals {5};
+constexpr static std::size_t match_limit {12};
+constexpr static std::size_t max_offset {65535};
+constexpr static unsigned hash_bits {16};
+
+// Frame format constants
+constexpr static std::uint32_t frame_magic {0x184D2204U};
+constexpr static std::uint32_t skippable_magic {0x184D2A50U};
+constexpr static std::uint32_t skippable_mask {0xFFFFFFF0U};
+constexpr static std::uint32_t uncompressed_flag {0x80000000U};
+// Version 1, independent blocks, no checksums, no content size
+constexpr static unsigned char frame_flags {0x60U};
+// 4 MiB blocks
+constexpr static unsigned char frame_block_descriptor {0x70U};
+
+static auto load_le32(const char* const src) noexcept -> std::uint32_t
+{
+  std::array<unsigned char, 4> bytes {};
+  std::memcpy(bytes.data(), src, bytes.size());
+
+  return static_cast<std::uint32_t>(bytes[0])
+         | (static_cast<std::uint32_t>(bytes[1]) << 8U)
+         | (static_cast<std::uint32_t>(bytes[2]) << 16U)
+         | (static_cast<std::uint32_t>(bytes[3]) << 24U);
+}
+
+static void store_le32(char* const dst, const std::uint32_t value) noexcept
+{
+  const std::array<unsigned char, 4> bytes {
+      static_cast<unsigned char>(value),
+      static_cast<unsigned char>(value >> 8U),
+      static_cast<unsigned char>(value >> 16U),
+      static_cast<unsigned char>(value >> 24U)};
+  std::memcpy(dst, bytes.data(), bytes.size());
+}
+
+static constexpr auto rotl32(const std::uint32_t value,
+                             const unsigned count) noexcept
+    -> std::uint32_t
+{
+  return (value << count) | (value >> (32U - count));
+}
+
+auto xxh32(const char* const data, const std::size_t size,
+           const std::uint32_t seed) noexcept -> std::uint32_t
+{
+  constexpr std::uint32_t prime1 {2654435761U};
+  constexpr std::uint32_t prime2 {2246822519U};
+  constexpr std::uint32_t prime3 {3266489917U};
+  constexpr std::uint32_t prime4 {668265263U};
+  constexpr std::uint32_t prime5 {374761393U};
+
+  std::size_t pos {0};
+  std::uint32_t hash {0};
+
+  if ( size >= 16 ) {
+    std::array<std::uint32_t, 4> lanes {seed + prime1 + prime2,
+                                        seed + prime2, seed,
+                                        seed - prime1};
+
+    for ( ; pos + 16 <= size; pos += 16 ) {
+      for ( std::size_t i {0}; i != lanes.size(); ++i ) {
+        const std::uint32_t input {load_le32(data + pos + (4 * i))};
+        lanes[i] = rotl32(lanes[i] + (input * prime2), 13) * prime1;
+      }
+    }
+
+    hash = rotl32(lanes[0], 1) + rotl32(lanes[1], 7)
+           + rotl32(lanes[2], 12) + rotl32(lanes[3], 18);
+  } else {
+    hash = seed + prime5;
+  }
+
+  hash += static_cast<std::uint32_t>(size);
+
+  for ( ; pos + 4 <= size; pos += 4 ) {
+    hash = rotl32(hash + load_le32(data + pos) * prime3, 17) * prime4;
+  }
+
+  for ( ; pos != size; ++pos ) {
+    hash = rotl32(hash
+                      + static_cast<std::uint32_t>(
+                            static_cast<unsigned char>(data[pos]))
+                            * prime5,
+                  11)
+           * prime1;
+  }
+
+  hash ^= hash >> 15U;
+  hash *= prime2;
+  hash ^= hash >> 13U;
+  hash *= prime3;
+  hash ^= hash >> 16U;
+
+  return hash;
+}
+
+block_compressor::block_compressor()
+    : m_table(std::size_t {1} << hash_bits, 0)
+{}
+
+// Writes the continuation bytes of a length which overflowed its
+// 4 bit token field
+static auto write_length(char* const dst, std::size_t pos,
+                         std::size_t length) noexcept -> std::size_t
+{
+  for ( ; length >= 255; length -= 255 ) {
+    dst[pos++] = static_cast<char>(0xFF);
+  }
+  dst[pos++] = static_cast<char>(length);
+
+  return pos;
+}
+
+// Writes a sequence of literals, followed by a match unless
+// `match_length` is zero
+static auto write_sequence(char* const dst, std::size_t pos,
+                           const char* const literals,
+                           const std::size_t literal_length,
+                           const std::size_t offset,
+                           const std::size_t match_length) noexcept
+    -> std::size_t
+{
+  const std::size_t match_code {
+      match_length == 0 ? 0 : match_length - min_match};
+
+  const std::size_t token_pos {pos++};
+  dst[token_pos] = static_cast<char>((std::min(literal_length,
+                                               std::size_t {15})
+                                      << 4U)
+                                     | std::min(match_code,
+                                                std::size_t {15}));
+
+  if ( literal_length >= 15 ) {
+    pos = write_length(dst, pos, literal_length - 15);
+  }
+
+  std::memcpy(dst + pos, literals, literal_length);
+  pos += literal_length;
+
+  if ( match_length != 0 ) {
+    dst[pos++] = static_cast<char>(offset & 0xFFU);
+    dst[pos++] = static_cast<char>(offset >> 8U);
+
+    if ( match_code >= 15 ) {
+      pos = write_length(dst, pos, match_code - 15);
+    }
+  }
+
+  return pos;
+}
+
+auto block_compressor::compress(const char* const src,
+                                const std::size_t size,
+                                char* const dst) noexcept -> std::size_t
+{
+  std::size_t out {0};
+  std::size_t anchor {0};
+
+  if ( size > match_limit ) {
+    // Matches may not start in the last match_limit bytes, nor extend
+    // into the last last_literals bytes
+    const std::size_t search_end {size - match_limit};
+    const std::size_t match_end {size - last_literals};
+
+    std::size_t pos {0};
+
+    while ( pos <= search_end ) {
+      const std::uint32_t sequence {load_le32(src + pos)};
+      const std::uint32_t hash {(sequence * 2654435761U)
+                                >> (32U - hash_bits)};
+
+      // Stale entries are harmless, every candidate is verified
+      std::size_t ref {m_table[hash]};
+      m_table[hash] = static_cast<std::uint32_t>(pos);
+
+      if ( ref >= pos || pos - ref > max_offset
+           || load_le32(src + ref) != sequence ) {
+        // Skip ahead faster through data which is not compressing
+        pos += 1 + ((pos - anchor) >> 6U);
+        continue;
+      }
+
+      while ( pos > anchor && ref > 0 && src[pos - 1] == src[ref - 1] ) {
+        --pos;
+        --ref;
+      }
+
+      std::size_t length {min_match};
+      while ( pos + length < match_end
+              && src[ref + length] == src[pos + length] ) {
+        ++length;
+      }
+
+      out = write_sequence(dst, out, src + anchor, pos - anchor,
+                           pos - ref, length);
+
+      pos += length;
+      anchor = pos;
+    }
+  }
+
+  return write_sequence(dst, out, src + anchor, size - anchor, 0, 0);
+}
+
+// Reads the continuation bytes of a length, if its token field
+// overflowed
+static auto read_length(const char* const src, const std::size_t size,
+                        std::size_t& pos, std::size_t& length) noexcept
+    -> bool
+{
+  if ( length != 15 ) {
+    return true;
+  }
+
+  unsigned char byte {0xFF};
+  while ( byte == 0xFF ) {
+    if ( pos == size ) {
+      return false;
+    }
+    byte = static_cast<unsigned char>(src[pos++]);
+    length += byte;
+  }
+
+  return true;
+}
+
+auto decompress_block(const char* const src, const std::size_t size,
+                      char* const dst, const std::size_t capacity) noexcept
+    -> std::optional<std::size_t>
+{
+  std::size_t in {0};
+  std::size_t out {0};
+
+  while ( in != size ) {
+    const auto token {static_cast<unsigned char>(src[in++])};
+
+    std::size_t literal_length {static_cast<std::size_t>(token >> 4U)};
+    if ( not read_length(src, size, in, literal_length)
+         || literal_length > size - in
+         || literal_length > capacity - out ) {
+      return std::nullopt;
+    }
+
+    std::memcpy(dst + out, src + in, literal_length);
+    in += literal_length;
+    out += literal_length;
+
+    // The last sequence has no match
+    if ( in == size ) {
+      return out;
+    }
+
+    if ( size - in < 2 ) {
+      return std::nullopt;
+    }
+
+    const auto offset_low {static_cast<unsigned char>(src[in])};
+    const auto offset_high {static_cast<unsigned char>(src[in + 1])};
+    const std::size_t offset {static_cast<std::size_t>(offset_low)
+                              | (static_cast<std::size_t>(offset_high)
+                                 << 8U)};
+    in += 2;
+
+    std::size_t match_length {static_cast<std::size_t>(token & 0x0FU)};
+    if ( offset == 0 || offset > out
+         || not read_length(src, size, in, match_length) ) {
+      return std::nullopt;
+    }
+    match_length += min_match;
+
+    if ( match_length > capacity - out ) {
+      return std::nullopt;
+    }
+
+    // Matches may overlap their own output
+    for ( std::size_t i {0}; i != match_length; ++i, ++out ) {
+      dst[out] = dst[out - offset];
+    }
+  }
+
+  return std::nullopt;
+}
+
+auto frame_header() noexcept -> std::array<char, 7>
+{
+  std::array<char, 7> header {};
+
+  store_le32(header.data(), frame_magic);
+  header[4] = static_cast<char>(frame_flags);
+  header[5] = static_cast<char>(frame_block_descriptor);
+  header[6] = static_cast<char>((xxh32(&header[4], 2) >> 8U) & 0xFFU);
+
+  return header;
+}
+
+void encode_block(block_compressor& compressor, const char* const src,
+                  const std::size_t size, std::vector<char>& out)
+{
+  const std::size_t start {out.size()};
+  out.resize(start + 4 + compress_bound(size));
+
+  char* const block_header {&out[start]};
+  char* const block_data {&out[start + 4]};
+
+  std::size_t block_size {compressor.compress(src, size, block_data)};
+
+  if ( block_size < size ) {
+    store_le32(block_header, static_cast<std::uint32_t>(block_size));
+  } else {
+    std::memcpy(block_data, src, size);
+    block_size = size;
+    store_le32(block_header,
+               static_cast<std::uint32_t>(size) | uncompressed_flag);
+  }
+
+  out.resize(start + 4 + block_size);
+}
+
+// Reads exactly `count` bytes, or fails
+static auto read_exactly(std::istream& in, char* const dst,
+                         const std::size_t count) -> bool
+{
+  in.read(dst, static_cast<std::streamsize>(count));
+  return static_cast<std::size_t>(in.gcount()) == count;
+}
+
+// Decompresses the blocks of a frame, up to and including its end mark
+static auto decompress_blocks(std::istream& in, std::ostream& out,
+                              const std::size_t block_max,
+                              const bool block_checksums) -> bool
+{
+  std::vector<char> block(block_max);
+  std::vector<char> data(block_max);
+  std::array<char, 4> word {};
+
+  while ( true ) {
+    if ( not read_exactly(in, word.data(), word.size()) ) {
+      return false;
+    }
+
+    const std::uint32_t block_header {load_le32(word.data())};
+    if ( block_header == 0 ) {
+      return true;
+    }
+
+    const std::size_t block_size {block_header & ~uncompressed_flag};
+    if ( block_size > block_max
+         || not read_exactly(in, block.data(), block_size)
+         || (block_checksums
+             && not read_exactly(in, word.data(), word.size())) ) {
+      return false;
+    }
+
+    if ( (block_header & uncompressed_flag) != 0 ) {
+      out.write(block.data(), static_cast<std::streamsize>(block_size));
+    } else {
+      const std::optional<std::size_t> data_size {decompress_block(
+          block.data(), block_size, data.data(), data.size())};
+      if ( not data_size.has_value() ) {
+        return false;
+      }
+
+      out.write(data.data(), static_cast<std::streamsize>(*data_size));
+    }
+
+    // Nothing more can be written, so there is no point reading on
+    if ( not out ) {
+      return false;
+    }
+  }
+}
+
+// Decompresses the rest of a frame, after its magic number
+static auto decompress_frame(std::istream& in, std::ostream& out) -> bool
+{
+  std::array<char, 15> descriptor {};
+  if ( not read_exactly(in, descriptor.data(), 2) ) {
+    return false;
+  }
+
+  const auto flags {static_cast<unsigned char>(descriptor[0])};
+  const auto block_descriptor {static_cast<unsigned char>(descriptor[1])};
+  const unsigned block_id {(block_descriptor >> 4U) & 0x07U};
+
+  const bool independent_blocks {(flags & 0x20U) != 0};
+  const bool block_checksums {(flags & 0x10U) != 0};
+  const bool content_size {(flags & 0x08U) != 0};
+  const bool content_checksum {(flags & 0x04U) != 0};
+  const bool dictionary {(flags & 0x01U) != 0};
+
+  // Linked blocks and dictionaries are never written here
+  if ( (flags >> 6U) != 1 || not independent_blocks || dictionary
+       || block_id < 4 ) {
+    return false;
+  }
+
+  const std::size_t descriptor_size {2 + (content_size ? 8U : 0U)};
+  if ( not read_exactly(in, &descriptor[2], descriptor_size - 2 + 1) ) {
+    return false;
+  }
+
+  const auto checksum {
+      static_cast<unsigned char>(descriptor[descriptor_size])};
+  if ( checksum
+       != ((xxh32(descriptor.data(), descriptor_size) >> 8U) & 0xFFU) ) {
+    return false;
+  }
+
+  const std::size_t block_max {std::size_t {1} << (8 + (2 * block_id))};
+  if ( not decompress_blocks(in, out, block_max, block_checksums) ) {
+    return false;
+  }
+
+  std::array<char, 4> word {};
+  return not content_checksum
+         || read_exactly(in, word.data(), word.size());
+}
+
+auto decompress_frame_blocks(std::istream& in, std::ostream& out) -> bool
+{
+  return decompress_blocks(in, out, max_block_size, false);
+}
+
+auto decompress_frames(std::istream& in, std::ostream& out) -> bool
+{
+  std::array<char, 4> word {};
+
+  while ( true ) {
+    in.read(word.data(), word.size());
+
+    if ( in.gcount() == 0 ) {
+      return true;
+    }
+    if ( static_cast<std::size_t>(in.gcount()) != word.size() ) {
+      return false;
+    }
+
+    const std::uint32_t magic {load_le32(word.data())};
+
+    if ( (magic & skippable_mask) == skippable_magic ) {
+      if ( not read_exactly(in, word.data(), word.size()) ) {
+        return false;
+      }
+      in.ignore(static_cast<std::streamsize>(load_le32(word.data())));
+      continue;
+    }
+
+    if ( magic != frame_magic || not decompress_frame(in, out) ) {
+      return false;
+    }
+  }
+}
+
+} // namespace lz4
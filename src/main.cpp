@@ -1,11 +1,30 @@
-#include <fstream>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "utils/etc.hpp"
+#include "utils/memory.hpp"
 
 #include "arg_parser.h"
+#include "arrival_generator.h"
+#include "arrival_log.h"
+#include "checkpoint.h"
+#include "compressed_file_buf.h"
 #include "constants.h"
+#include "lockstep.h"
+#include "log_index.h"
+#include "mapped_file_buf.h"
+#include "metrics.h"
+#include "repair_bay.h"
+#include "ship_queue.h"
 #include "space_station.h"
 
 // It's not that bad
@@ -23,7 +42,48 @@ auto main(const int argc, const char* const* const argv) -> int
         << "--disable-safety-cutoff :"
         << "Disable safety cutoff at a queue size of "
         << conf::cutoff_queue_size << '\n'
-        << "--logfile [path] : Choose path to log file" << '\n';
+        << "--max-memory [size] : Stop cleanly once the simulation's "
+        << "memory footprint exceeds size, in bytes or with a suffix "
+        << "such as 512M or 2GiB" << '\n'
+        << "--logfile [path] : Choose path to log file" << '\n'
+        << "--compress-log : Write the log file LZ4 compressed "
+        << "(default path: " << conf::default_compressed_log_file << ")"
+        << '\n'
+        << "--read-hour [hour] : Print the report of an hour from the "
+        << "log file, instead of running" << '\n'
+        << "--to-hour [hour] : With --read-hour, print all reports up to "
+        << "this hour" << '\n'
+        << "--metrics [path] : Record per-hour metrics to a compact "
+        << "columnar file" << '\n'
+        << "--metrics-csv [path] : Print a metrics file as CSV, instead "
+        << "of running" << '\n'
+        << "--record-arrivals [path] : Record every arrival to a file"
+        << '\n'
+        << "--replay-arrivals [path] : Replay arrivals recorded with "
+        << "--record-arrivals, until they run out" << '\n'
+        << "--checkpoint [path] : Checkpoint the station to a file as it "
+        << "runs, so the run can be resumed" << '\n'
+        << "--checkpoint-every [hours] : Hours between checkpoints "
+        << "(default: " << conf::checkpoint_interval << ")" << '\n'
+        << "--resume [path] : Resume the run checkpointed to a file, with "
+        << "the same --bays, --part-repair and --policy, for --steps more "
+        << "hours" << '\n'
+        << "--bays [specs] : Comma-separated repair bays, each "
+        << "speed[:faction+faction...], e.g. 1,1,2:klingon+romulan "
+        << "(default: " << conf::num_repair_bays << " bays of speed 1)"
+        << '\n'
+        << "--part-repair : Repair ships part by part, and report each "
+        << "part as it is finished" << '\n'
+        << "--predict-waits : Predict when each ship will dock as it "
+        << "arrives, and print how accurate the predictions were" << '\n'
+        << "--policy [name] : Order ships dock in: fifo, shortest, "
+        << "longest, faction or aging (default: fifo)" << '\n'
+        << "--compare-bays [counts] : Run one station per comma-separated "
+        << "bay count on the same arrivals, and print a summary of each, "
+        << "instead of reports" << '\n'
+        << "--compare-policies [names] : Like --compare-bays, with one "
+        << "station per policy, or per bay count and policy if both are "
+        << "given" << '\n';
 
     if constexpr ( conf::print_to_console_by_default ) {
       std::cout << "--quiet or -q : Do not print to stdout" << '\n';
@@ -43,11 +103,49 @@ auto main(const int argc, const char* const* const argv) -> int
   const bool disable_safety_cutoff {
       arg_parser.boolArg("disable-safety-cutoff")};
 
+  const std::string max_memory_text {arg_parser.strArg("max-memory", "")};
+
   const int steps_to_perform {
       arg_parser.intArg("steps", conf::default_time_steps)};
 
-  const std::string logfile {
-      arg_parser.strArg("logfile", conf::default_log_file)};
+  const bool compress_log {arg_parser.boolArg("compress-log")};
+
+  const std::string logfile {arg_parser.strArg(
+      "logfile", compress_log ? conf::default_compressed_log_file
+                              : conf::default_log_file)};
+
+  const int read_hour {arg_parser.intArg("read-hour", 0)};
+
+  const std::string metrics_file {arg_parser.strArg("metrics", "")};
+
+  const std::string metrics_csv_file {
+      arg_parser.strArg("metrics-csv", "")};
+
+  const std::string record_arrivals_file {
+      arg_parser.strArg("record-arrivals", "")};
+
+  const std::string replay_arrivals_file {
+      arg_parser.strArg("replay-arrivals", "")};
+
+  const std::string checkpoint_file {arg_parser.strArg("checkpoint", "")};
+
+  const int checkpoint_every {arg_parser.intArg(
+      "checkpoint-every", static_cast<int>(conf::checkpoint_interval))};
+
+  const std::string resume_file {arg_parser.strArg("resume", "")};
+
+  const std::string bay_specs {arg_parser.strArg("bays", "")};
+
+  const bool part_repair {arg_parser.boolArg("part-repair")};
+
+  const bool predict_waits {arg_parser.boolArg("predict-waits")};
+
+  const std::string policy_name {arg_parser.strArg("policy", "fifo")};
+
+  const std::string compare_bays {arg_parser.strArg("compare-bays", "")};
+
+  const std::string compare_policies {
+      arg_parser.strArg("compare-policies", "")};
 
   const bool print_to_console {[&]() {
     if constexpr ( conf::print_to_console_by_default ) {
@@ -67,28 +165,314 @@ auto main(const int argc, const char* const* const argv) -> int
 
   // Done parsing arguments
 
-  space_station zebra("Zebra");
-  std::ofstream fout;
+  if ( read_hour > 0 ) {
+    const int to_hour {arg_parser.intArg("to-hour", read_hour)};
+
+    if ( !log_index::copy_steps(logfile,
+                                static_cast<std::uint64_t>(read_hour),
+                                static_cast<std::uint64_t>(to_hour),
+                                std::cout) ) {
+      std::cout << "Could not read hour " << read_hour << " from "
+                << logfile << '\n';
+      return 1;
+    }
+
+    return 0;
+  }
+
+  if ( !metrics_csv_file.empty() ) {
+    if ( !metrics::write_csv(metrics_csv_file, std::cout) ) {
+      std::cout << "Could not read metrics from " << metrics_csv_file
+                << '\n';
+      return 1;
+    }
+
+    return 0;
+  }
+
+  std::optional<std::uint64_t> max_memory;
+  if ( !max_memory_text.empty() ) {
+    max_memory = ehanc::parse_byte_size(max_memory_text);
+    if ( !max_memory.has_value() ) {
+      std::cout << "Invalid memory size \"" << max_memory_text << "\""
+                << '\n';
+      return 1;
+    }
+  }
+
+  const std::optional<ship_queue::policy> policy {
+      ship_queue::parse_policy(policy_name)};
+  if ( !policy.has_value() ) {
+    std::cout << "Invalid policy \"" << policy_name << "\"" << '\n';
+    return 1;
+  }
+
+  std::vector<bay_spec> bays(
+      static_cast<std::size_t>(conf::num_repair_bays));
+  if ( !bay_specs.empty() ) {
+    bays.clear();
+
+    std::stringstream specs(bay_specs);
+    std::string spec;
+    while ( std::getline(specs, spec, ',') ) {
+      const std::optional<bay_spec> parsed {bay_spec::parse(spec)};
+      if ( !parsed.has_value() ) {
+        std::cout << "Invalid bay \"" << spec << "\"" << '\n';
+        return 1;
+      }
+      bays.push_back(*parsed);
+    }
+  }
+
+  if ( checkpoint_every <= 0 ) {
+    std::cout << "Invalid checkpoint interval \"" << checkpoint_every
+              << "\"" << '\n';
+    return 1;
+  }
+
+  // Checkpoints hold the station's own arrivals, and only a single
+  // station's
+  if ( (!checkpoint_file.empty() || !resume_file.empty())
+       && (!record_arrivals_file.empty() || !replay_arrivals_file.empty()
+           || !compare_bays.empty() || !compare_policies.empty()) ) {
+    std::cout << "--checkpoint and --resume cannot be combined with "
+              << "--record-arrivals, --replay-arrivals, --compare-bays "
+              << "or --compare-policies" << '\n';
+    return 1;
+  }
+
+  if ( part_repair ) {
+    for ( bay_spec& spec : bays ) {
+      spec.track_parts = true;
+    }
+  }
+
+  if ( !compare_bays.empty() || !compare_policies.empty() ) {
+    std::vector<std::vector<bay_spec>> layouts;
+    std::vector<ship_queue::policy> policies;
+
+    if ( compare_bays.empty() ) {
+      layouts.push_back(bays);
+    }
+
+    std::stringstream counts(compare_bays);
+    std::string count;
+    while ( std::getline(counts, count, ',') ) {
+      const int bay_count {std::atoi(count.c_str())};
+      if ( bay_count <= 0 ) {
+        std::cout << "Invalid bay count \"" << count << "\"" << '\n';
+        return 1;
+      }
+      bay_spec spec {};
+      spec.track_parts = part_repair;
+      layouts.emplace_back(static_cast<std::size_t>(bay_count), spec);
+    }
+
+    std::stringstream names(compare_policies.empty() ? policy_name
+                                                     : compare_policies);
+    std::string name;
+    while ( std::getline(names, name, ',') ) {
+      const std::optional<ship_queue::policy> order {
+          ship_queue::parse_policy(name)};
+      if ( !order.has_value() ) {
+        std::cout << "Invalid policy \"" << name << "\"" << '\n';
+        return 1;
+      }
+      policies.push_back(*order);
+    }
+
+    std::vector<lockstep::config> configs;
+    for ( const std::vector<bay_spec>& layout : layouts ) {
+      for ( const ship_queue::policy order : policies ) {
+        configs.push_back({layout, order});
+      }
+    }
+
+    lockstep stations(std::move(configs));
+
+    // Check the cutoff between batches
+    for ( int done {0}; done < steps_to_perform; ) {
+      const int batch {std::min(
+          steps_to_perform - done,
+          static_cast<int>(conf::lockstep_batch_steps))};
+      stations.run(static_cast<std::size_t>(batch));
+      done += batch;
+
+      if ( (!disable_safety_cutoff)
+           && (stations.largest_queue_size() > conf::cutoff_queue_size) ) {
+        std::cout << "Queue size has exceeded cutoff of "
+                  << conf::cutoff_queue_size << " ships" << '\n';
+        return 1;
+      }
+
+      if ( max_memory.has_value()
+           && stations.memory_footprint() > *max_memory ) {
+        std::cout << "Memory footprint of " << stations.memory_footprint()
+                  << " bytes has exceeded --max-memory of " << *max_memory
+                  << " bytes, stopping after hour " << done << '\n';
+        stations.display_summary(std::cout);
+        return 1;
+      }
+    }
+
+    stations.display_summary(std::cout);
+
+    return 0;
+  }
+
+  space_station zebra("Zebra", bays, *policy);
+  zebra.check_predictions(predict_waits);
+
+  if ( !resume_file.empty() ) {
+    const std::optional<std::uint64_t> resumed {
+        checkpoint::restore(resume_file, zebra)};
+    if ( !resumed.has_value() ) {
+      std::cout << "Could not resume from " << resume_file
+                << ", which must be a checkpoint of a station with the "
+                << "same bays and policy" << '\n';
+      return 1;
+    }
+    std::cout << "Resuming after hour " << *resumed << '\n';
+  }
+
+  std::optional<checkpoint::writer> checkpoints;
+  if ( !checkpoint_file.empty() ) {
+    checkpoints.emplace(checkpoint_file);
+  }
+
+  std::unique_ptr<log_buf> log_file;
 
   if ( print_to_logfile ) {
-    fout.open(logfile.c_str());
+    if ( compress_log ) {
+      log_file = std::make_unique<compressed_file_buf>(logfile);
+    } else {
+      log_file = std::make_unique<mapped_file_buf>(logfile);
+    }
 
-    if ( !fout.is_open() ) {
+    if ( !log_file->is_open() ) {
       std::cout << "Error opening logfile" << '\n';
 
       if ( !print_to_console ) {
         std::cout << "Not printing to console either, aborting" << '\n';
         return 1;
       }
+      log_file.reset();
+    }
+  }
+
+  // Maps each hour to the position of its report in the log file
+  std::optional<log_index::writer> index;
+
+  if ( log_file ) {
+    index.emplace(log_index::index_path(logfile),
+                  conf::log_index_flush_interval, log_file.get());
+
+    if ( !index->is_open() ) {
+      std::cout << "Error opening log index, hours cannot be looked up"
+                << '\n';
+      index.reset();
+    }
+  }
+
+  std::optional<metrics::writer> metrics_out;
+
+  if ( !metrics_file.empty() ) {
+    // A resumed run records from the hour after the checkpoint
+    metrics_out.emplace(metrics_file, zebra.step_count() + 1);
+
+    if ( !metrics_out->is_open() ) {
+      std::cout << "Error opening metrics file" << '\n';
+      return 1;
     }
   }
 
+  // Arrivals are either replayed from a file, or generated here so that
+  // they can be recorded on their way into the station
+  std::optional<arrival_log::reader> replay;
+  std::optional<arrival_log::writer> recording;
+  arrival_generator arrivals;
+
+  if ( !replay_arrivals_file.empty() ) {
+    replay.emplace(replay_arrivals_file);
+
+    if ( !replay->is_open() ) {
+      std::cout << "Error opening arrivals to replay" << '\n';
+      return 1;
+    }
+  } else if ( !record_arrivals_file.empty() ) {
+    recording.emplace(record_arrivals_file);
+
+    if ( !recording->is_open() ) {
+      std::cout << "Error opening file to record arrivals" << '\n';
+      return 1;
+    }
+  }
+
+  // Reports are rendered straight into the mapped log file, or into
+  // blocks compressed on another thread
+  std::ostream fout(log_file.get());
+
+  // Every byte the run has allocated, to hold it to --max-memory
+  const auto memory_footprint {[&]() {
+    return zebra.memory_footprint() + arrivals.memory_footprint()
+           + (log_file ? log_file->memory_footprint() : 0)
+           + (index.has_value() ? index->memory_footprint() : 0)
+           + (metrics_out.has_value() ? metrics_out->memory_footprint()
+                                      : 0)
+           + (replay.has_value() ? replay->memory_footprint() : 0)
+           + (recording.has_value() ? recording->memory_footprint() : 0)
+           + (checkpoints.has_value() ? checkpoints->memory_footprint()
+                                      : 0);
+  }};
+
+  // A run which cannot be checkpointed goes on without
+  const auto save_checkpoint {[&]() {
+    if ( checkpoints.has_value() && !checkpoints->save(zebra) ) {
+      std::cout << "Error writing checkpoint after hour "
+                << zebra.step_count() << ", no longer checkpointing"
+                << '\n';
+      checkpoints.reset();
+    }
+  }};
+
+  int exit_code {0};
+
   for ( int i {0}; i != steps_to_perform; ++i ) {
-    zebra.step();
+    const std::uint64_t hour {zebra.step_count() + 1};
+
+    if ( replay.has_value() ) {
+      const auto replayed {replay->arrivals_for(hour)};
+
+      if ( !replayed.has_value() ) {
+        if ( replay->failed() ) {
+          std::cout << "Error reading arrivals to replay" << '\n';
+          return 1;
+        }
+        std::cout << "Replayed arrivals end after hour " << hour - 1
+                  << '\n';
+        break;
+      }
+
+      zebra.step(replayed->begin(), replayed->end());
+    } else if ( recording.has_value() ) {
+      const arrival_generator::arrivals generated {arrivals.next_step()};
+      recording->record(hour, generated);
+      zebra.step(generated.begin(), generated.end());
+    } else {
+      zebra.step();
+    }
+
+    if ( metrics_out.has_value() ) {
+      metrics_out->record(metrics::sample(zebra));
+    }
     if ( print_to_console ) {
       zebra.display(std::cout);
     }
-    if ( print_to_logfile ) {
+    if ( log_file ) {
+      if ( index.has_value() ) {
+        index->add(zebra.step_count(),
+                   static_cast<std::uint64_t>(fout.tellp()));
+      }
       zebra.display(fout);
     }
     if ( (!disable_safety_cutoff)
@@ -97,12 +481,60 @@ auto main(const int argc, const char* const* const argv) -> int
                 << conf::cutoff_queue_size << " ships" << '\n';
       return 1;
     }
+
+    if ( zebra.step_count() % static_cast<std::size_t>(checkpoint_every)
+         == 0 ) {
+      save_checkpoint();
+    }
+
+    // Unlike the queue size cutoff, finish every file, so the run up to
+    // here can still be read back
+    if ( max_memory.has_value()
+         && zebra.step_count() % conf::memory_check_interval == 0 ) {
+      const std::size_t used {memory_footprint()};
+      if ( used > *max_memory ) {
+        std::cout << "Memory footprint of " << used
+                  << " bytes has exceeded --max-memory of " << *max_memory
+                  << " bytes, stopping after hour " << zebra.step_count()
+                  << '\n';
+        if ( !print_to_console ) {
+          zebra.display(std::cout);
+        }
+        // Checkpointed here too, so the run can be resumed with more
+        // memory
+        save_checkpoint();
+        exit_code = 1;
+        break;
+      }
+    }
   }
 
-  if ( fout.is_open() ) {
+  if ( log_file ) {
     fout << std::flush;
-    fout.close();
+    log_file->close();
+  }
+
+  if ( index.has_value() ) {
+    index->close();
+  }
+
+  if ( metrics_out.has_value() ) {
+    metrics_out->close();
+  }
+
+  if ( recording.has_value() ) {
+    recording->close();
+  }
+
+  if ( predict_waits ) {
+    const space_station::prediction_stats& accuracy {
+        zebra.prediction_accuracy()};
+    std::cout << "Predicted dock hours of " << accuracy.ships
+              << " ships: mean error " << accuracy.mean_abs_error()
+              << " hours, bias " << accuracy.mean_error()
+              << " hours, worst " << accuracy.max_abs_error << " hours"
+              << '\n';
   }
 
-  return 0;
+  return exit_code;
 }
@@ -0,0 +1,124 @@
+#include <cstddef>
+#include <ios>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "mapped_file_buf.h"
+
+mapped_file_buf::mapped_file_buf(const std::string& path,
+                                 std::size_t extent) noexcept
+    : m_extent {extent}
+{
+  const auto page_size {static_cast<std::size_t>(sysconf(_SC_PAGESIZE))};
+  m_extent = ((m_extent + page_size - 1) / page_size) * page_size;
+
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg)
+  m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+  if ( m_fd != -1 && not this->map_window(0) ) {
+    ::close(m_fd);
+    m_fd = -1;
+  }
+}
+
+mapped_file_buf::~mapped_file_buf() noexcept
+{
+  mapped_file_buf::close();
+}
+
+auto mapped_file_buf::map_window(std::size_t offset) noexcept -> bool
+{
+  // Allocate the extent's blocks first. A file only grown with ftruncate
+  // is sparse, so running out of disk would raise SIGBUS on a store into
+  // the mapping, rather than fail here.
+  if ( ::posix_fallocate(m_fd, static_cast<off_t>(offset),
+                         static_cast<off_t>(m_extent))
+       != 0 ) {
+    return false;
+  }
+
+  void* const window {::mmap(nullptr, m_extent, PROT_READ | PROT_WRITE,
+                             MAP_SHARED, m_fd, static_cast<off_t>(offset))};
+
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast)
+  if ( window == MAP_FAILED ) {
+    return false;
+  }
+
+  ::madvise(window, m_extent, MADV_SEQUENTIAL);
+
+  m_window_offset = offset;
+  m_window        = static_cast<char*>(window);
+
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  this->setp(m_window, m_window + m_extent);
+
+  return true;
+}
+
+void mapped_file_buf::unmap_window() noexcept
+{
+  if ( m_window != nullptr ) {
+    ::munmap(m_window, m_extent);
+    m_window = nullptr;
+    this->setp(nullptr, nullptr);
+  }
+}
+
+auto mapped_file_buf::overflow(int_type ch) -> int_type
+{
+  if ( not this->is_open() ) {
+    return traits_type::eof();
+  }
+
+  // Put area full, move on to the next extent. Everything before it has
+  // been written, even if it cannot be mapped.
+  this->unmap_window();
+  m_window_offset += m_extent;
+
+  if ( not this->map_window(m_window_offset) ) {
+    return traits_type::eof();
+  }
+
+  if ( not traits_type::eq_int_type(ch, traits_type::eof()) ) {
+    *this->pptr() = traits_type::to_char_type(ch);
+    this->pbump(1);
+  }
+
+  return traits_type::not_eof(ch);
+}
+
+auto mapped_file_buf::seekoff(off_type off, std::ios_base::seekdir dir,
+                              std::ios_base::openmode which) -> pos_type
+{
+  // Only reporting the current position is supported, for tellp()
+  if ( off != 0 || dir != std::ios_base::cur
+       || (which & std::ios_base::out) == 0 || not this->is_open() ) {
+    return pos_type(off_type(-1));
+  }
+
+  return pos_type(static_cast<off_type>(this->size()));
+}
+
+auto mapped_file_buf::close() noexcept -> bool
+{
+  if ( m_fd == -1 ) {
+    return false;
+  }
+
+  const std::size_t written {this->is_open() ? this->size()
+                                             : m_window_offset};
+
+  this->unmap_window();
+
+  const bool truncated {
+      ::ftruncate(m_fd, static_cast<off_t>(written)) == 0};
+
+  ::close(m_fd);
+  m_fd = -1;
+
+  return truncated;
+}
@@ -0,0 +1,277 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <ios>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "utils/memory.hpp"
+#include "utils/varint.hpp"
+
+#include "metrics.h"
+
+namespace metrics {
+
+// Maps small magnitudes of either sign to small unsigned values
+static constexpr auto zigzag(const std::int64_t value) noexcept
+    -> std::uint64_t
+{
+  return (static_cast<std::uint64_t>(value) << 1U)
+         ^ static_cast<std::uint64_t>(value >> 63U);
+}
+
+static constexpr auto unzigzag(const std::uint64_t value) noexcept
+    -> std::int64_t
+{
+  return static_cast<std::int64_t>(value >> 1U)
+         ^ -static_cast<std::int64_t>(value & 1U);
+}
+
+auto sample(const space_station& station) noexcept -> row
+{
+  const space_station::step_summary& summary {station.last_step_summary()};
+
+  return {static_cast<std::int64_t>(summary.new_ships),
+          static_cast<std::int64_t>(summary.leaving_ships),
+          static_cast<std::int64_t>(station.queue_size()),
+          static_cast<std::int64_t>(station.occupied_bay_count()),
+          static_cast<std::int64_t>(station.total_bay_time_remaining()),
+          static_cast<std::int64_t>(station.queue_repair_hours()),
+          static_cast<std::int64_t>(station.queue_part_count())};
+}
+
+writer::writer(const std::string& path, const std::uint64_t first_step,
+               std::size_t block_rows)
+    : m_block_rows {std::max(block_rows, std::size_t {1})}
+{
+  m_file = std::fopen(path.c_str(), "wb");
+
+  if ( m_file == nullptr ) {
+    return;
+  }
+
+  for ( auto& column : m_columns ) {
+    column.reserve(m_block_rows);
+  }
+
+  std::vector<char> header(magic.begin(), magic.end());
+  ehanc::append_varint(header, column_count);
+  for ( const auto name : column_names ) {
+    ehanc::append_varint(header, name.size());
+    header.insert(header.end(), name.begin(), name.end());
+  }
+  ehanc::append_varint(header, first_step);
+
+  if ( std::fwrite(header.data(), 1, header.size(), m_file)
+       != header.size() ) {
+    std::fclose(m_file);
+    m_file = nullptr;
+  }
+}
+
+writer::~writer() noexcept
+{
+  this->close();
+}
+
+auto writer::memory_footprint() const noexcept -> std::size_t
+{
+  std::size_t bytes {ehanc::heap_bytes(m_encoded)
+                     + ehanc::heap_bytes(m_encoded_column)};
+  for ( const auto& column : m_columns ) {
+    bytes += ehanc::heap_bytes(column);
+  }
+  return bytes;
+}
+
+auto writer::record(const row& values) -> bool
+{
+  if ( not this->is_open() ) {
+    return false;
+  }
+
+  for ( std::size_t i {0}; i != column_count; ++i ) {
+    m_columns[i].push_back(values[i]);
+  }
+
+  if ( m_columns[0].size() == m_block_rows ) {
+    return this->write_block();
+  }
+
+  return true;
+}
+
+auto writer::write_block() noexcept -> bool
+{
+  const std::size_t rows {m_columns[0].size()};
+
+  if ( rows == 0 ) {
+    return true;
+  }
+
+  bool written {false};
+
+  try {
+    m_encoded.clear();
+    ehanc::append_varint(m_encoded, rows);
+
+    for ( auto& column : m_columns ) {
+      m_encoded_column.clear();
+
+      std::int64_t previous {0};
+      for ( const std::int64_t value : column ) {
+        ehanc::append_varint(m_encoded_column,
+                             zigzag(value - previous));
+        previous = value;
+      }
+
+      ehanc::append_varint(m_encoded, m_encoded_column.size());
+      m_encoded.insert(m_encoded.end(), m_encoded_column.begin(),
+                       m_encoded_column.end());
+      column.clear();
+    }
+
+    written = std::fwrite(m_encoded.data(), 1, m_encoded.size(), m_file)
+                  == m_encoded.size()
+              && std::fflush(m_file) == 0;
+  } catch ( ... ) {
+    written = false;
+  }
+
+  return written;
+}
+
+auto writer::close() noexcept -> bool
+{
+  if ( not this->is_open() ) {
+    return false;
+  }
+
+  const bool written {this->write_block()};
+  const bool closed {std::fclose(m_file) == 0};
+  m_file = nullptr;
+
+  return written && closed;
+}
+
+reader::reader(const std::string& path)
+    : m_file(path, std::ios::binary)
+{
+  std::array<char, magic.size()> header {};
+
+  bool valid {m_file.read(header.data(), header.size()) && header == magic
+              && ehanc::read_varint(m_file) == column_count};
+
+  for ( std::size_t i {0}; valid && i != column_count; ++i ) {
+    const std::optional<std::uint64_t> length {
+        ehanc::read_varint(m_file)};
+    valid = length == column_names[i].size();
+
+    if ( valid ) {
+      std::string name(column_names[i].size(), '\0');
+      valid = m_file.read(name.data(), static_cast<std::streamsize>(
+                                           name.size()))
+              && name == column_names[i];
+    }
+  }
+
+  const std::optional<std::uint64_t> first_step {
+      valid ? ehanc::read_varint(m_file) : std::nullopt};
+  valid = first_step.has_value();
+
+  if ( valid ) {
+    m_first_step = *first_step;
+  } else {
+    m_file.close();
+  }
+}
+
+auto reader::next_block() -> bool
+{
+  for ( auto& column : m_columns ) {
+    column.clear();
+  }
+
+  if ( not this->is_open() ) {
+    return false;
+  }
+
+  const std::optional<std::uint64_t> rows {ehanc::read_varint(m_file)};
+  if ( not rows.has_value() ) {
+    return false;
+  }
+
+  for ( auto& column : m_columns ) {
+    const std::optional<std::uint64_t> size {
+        ehanc::read_varint(m_file)};
+
+    // Every value takes at least one byte
+    if ( not size.has_value() || *size < *rows ) {
+      return false;
+    }
+
+    m_encoded.resize(*size);
+    const auto encoded_size {static_cast<std::streamsize>(*size)};
+    if ( not m_file.read(m_encoded.data(), encoded_size) ) {
+      return false;
+    }
+
+    const char* pos {m_encoded.data()};
+    const char* const end {pos + m_encoded.size()};
+    std::int64_t previous {0};
+
+    column.reserve(*rows);
+    for ( std::uint64_t i {0}; i != *rows; ++i ) {
+      const std::optional<std::uint64_t> delta {
+          ehanc::read_varint(pos, end)};
+      if ( not delta.has_value() ) {
+        return false;
+      }
+
+      previous += unzigzag(*delta);
+      column.push_back(previous);
+    }
+
+    if ( pos != end ) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+auto write_csv(const std::string& path, std::ostream& out) -> bool
+{
+  reader metrics(path);
+
+  if ( not metrics.is_open() ) {
+    return false;
+  }
+
+  out << "step";
+  for ( const auto name : column_names ) {
+    out << ',' << name;
+  }
+  out << '\n';
+
+  std::uint64_t step {metrics.first_step()};
+
+  while ( metrics.next_block() ) {
+    for ( std::size_t i {0}; i != metrics.block_rows(); ++i ) {
+      out << step++;
+      for ( std::size_t j {0}; j != column_count; ++j ) {
+        out << ',' << metrics.column(j)[i];
+      }
+      out << '\n';
+    }
+  }
+
+  return static_cast<bool>(out);
+}
+
+} // namespace metrics
@@ -0,0 +1,61 @@
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+
+#include "utils/bit.hpp"
+
+#include "part_set.h"
+
+auto part_set::rank(int id) const noexcept -> std::size_t
+{
+  const auto index {static_cast<std::size_t>(id)};
+  const std::size_t word {index / word_bits};
+  const std::uint64_t below {(std::uint64_t {1} << (index % word_bits))
+                             - 1};
+
+  std::size_t retval {
+      static_cast<std::size_t>(::ehanc::popcount(m_ids[word] & below))};
+  for ( std::size_t i {0}; i != word; ++i ) {
+    retval += static_cast<std::size_t>(::ehanc::popcount(m_ids[i]));
+  }
+  return retval;
+}
+
+auto part_set::insert(int id, int damage) noexcept -> bool
+{
+  if ( this->contains(id) ) {
+    return false;
+  }
+
+  m_damage.insert(
+      std::next(m_damage.begin(), static_cast<long>(this->rank(id))),
+      static_cast<std::uint8_t>(damage));
+
+  const auto index {static_cast<std::size_t>(id)};
+  m_ids[index / word_bits] |= std::uint64_t {1} << (index % word_bits);
+
+  return true;
+}
+
+auto part_set::is_subset_of(const mask& bits) const noexcept -> bool
+{
+  std::uint64_t outside {0};
+  for ( std::size_t i {0}; i != word_count; ++i ) {
+    outside |= m_ids[i] & ~bits[i];
+  }
+  return outside == 0;
+}
+
+auto part_set::damage(int id) const noexcept -> int
+{
+  if ( not this->contains(id) ) {
+    return 0;
+  }
+  return static_cast<int>(m_damage[this->rank(id)]);
+}
+
+auto part_set::total_damage() const noexcept -> int
+{
+  return std::accumulate(m_damage.cbegin(), m_damage.cend(), 0);
+}
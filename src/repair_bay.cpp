@@ -1,17 +1,150 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
 #include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
 #include <utility>
 
 #include "repair_bay.h"
 
+auto bay_spec::parse(const std::string_view text) noexcept
+    -> std::optional<bay_spec>
+{
+  bay_spec retval;
+
+  const std::size_t colon {text.find(':')};
+
+  try {
+    const std::string speed {text.substr(0, colon)};
+    char* speed_end {nullptr};
+    retval.speed = std::strtod(speed.c_str(), &speed_end);
+    if ( speed.empty() || speed_end != speed.c_str() + speed.size()
+         || not std::isfinite(retval.speed) || retval.speed <= 0.0 ) {
+      return std::nullopt;
+    }
+  } catch ( ... ) {
+    return std::nullopt;
+  }
+
+  if ( colon == std::string_view::npos ) {
+    return retval;
+  }
+
+  retval.factions = 0;
+
+  std::string_view names {text.substr(colon + 1)};
+  while ( true ) {
+    const std::size_t plus {names.find('+')};
+    const std::string_view name {names.substr(0, plus)};
+
+    bool found {false};
+    for ( std::size_t i {0}; i != ship::faction_count; ++i ) {
+      const auto fact {static_cast<ship::faction>(i)};
+      const std::string_view full {ship::faction_name(fact)};
+
+      // Names are given in lowercase
+      found = name.size() == full.size()
+              && std::equal(name.cbegin(), name.cend(), full.cbegin(),
+                            [](const char lhs, const char rhs) {
+                              return lhs
+                                     == static_cast<char>(
+                                         std::tolower(rhs));
+                            });
+      if ( found ) {
+        retval.factions |= ship::faction_bit(fact);
+        break;
+      }
+    }
+
+    if ( not found ) {
+      return std::nullopt;
+    }
+    if ( plus == std::string_view::npos ) {
+      return retval;
+    }
+    names.remove_prefix(plus + 1);
+  }
+}
+
+auto bay_spec::repair_time(const int base_time) const noexcept -> int
+{
+  return std::max(
+      static_cast<int>(std::ceil(static_cast<double>(base_time) / speed)),
+      1);
+}
+
 void repair_bay::dock(ship&& incoming_ship) noexcept
 {
   m_docked_ship.emplace(std::move(incoming_ship));
   m_remaining_repair_time =
-      conf::severity_to_time(m_docked_ship->get_total_damage());
+      m_spec.repair_time(m_docked_ship->repair_time());
+
+  if ( m_spec.track_parts ) {
+    // part_set iterates in order of ID
+    m_parts.clear();
+    for ( const ship::part part :
+          m_docked_ship->get_damaged_parts_list() ) {
+      m_parts.push_back(
+          part_progress {static_cast<std::uint16_t>(part.id),
+                         static_cast<std::uint16_t>(part.damage)});
+    }
+
+    m_cursor = 0;
+    m_step_first_done = 0;
+    m_repair_time = m_remaining_repair_time;
+    m_total_damage = m_docked_ship->get_total_damage();
+    m_damage_repaired = 0;
+    m_ship_id = m_docked_ship->get_id();
+  }
+}
+
+void repair_bay::repair_parts() noexcept
+{
+  // Damage is worked off evenly over the whole repair time, so after
+  // `elapsed` hours, total * elapsed / repair_time of it is done
+  const int elapsed {m_repair_time - m_remaining_repair_time};
+  const auto target {static_cast<int>(
+      static_cast<std::int64_t>(m_total_damage) * elapsed
+      / m_repair_time)};
+
+  int budget {target - m_damage_repaired};
+  m_damage_repaired = target;
+
+  while ( m_cursor != m_parts.size() ) {
+    part_progress& part {m_parts[m_cursor]};
+    const int work {std::min<int>(budget, part.remaining)};
+
+    part.remaining = static_cast<std::uint16_t>(part.remaining - work);
+    budget -= work;
+
+    if ( part.remaining != 0 ) {
+      break;
+    }
+    ++m_cursor;
+  }
 }
 
 void repair_bay::display(std::ostream& out) const noexcept
 {
+  // Only bays which differ from the usual say so
+  if ( m_spec.speed < 1.0 || m_spec.speed > 1.0 ) {
+    out << "Repair bay works at " << m_spec.speed << "x speed.\n";
+  }
+  if ( m_spec.factions != ship::every_faction ) {
+    out << "Repair bay only repairs ships of:";
+    for ( std::size_t i {0}; i != ship::faction_count; ++i ) {
+      const auto fact {static_cast<ship::faction>(i)};
+      if ( m_spec.accepts(fact) ) {
+        out << ' ' << ship::faction_name(fact);
+      }
+    }
+    out << '\n';
+  }
+
   if ( this->empty() ) {
     out << "Repair bay is empty." << '\n';
     return;
@@ -19,15 +152,25 @@ void repair_bay::display(std::ostream& out) const noexcept
     out << "Repair bay has docked: " << *m_docked_ship
         << "  Ship requires " << this->time_remaining()
         << " more hours to repair.\n";
+    if ( m_spec.track_parts ) {
+      out << "  " << m_cursor << " of " << m_parts.size()
+          << " parts repaired.\n";
+    }
     return;
   }
 }
 
 auto repair_bay::step() noexcept -> bool
 {
+  // Nothing finished yet this step
+  m_step_first_done = m_cursor;
+
   if ( m_remaining_repair_time != 0 ) {
     // ship in repair bay
     --m_remaining_repair_time;
+    if ( m_spec.track_parts ) {
+      this->repair_parts();
+    }
     if ( m_remaining_repair_time == 0 ) {
       // repairs completed
       m_docked_ship.reset();
@@ -1,88 +1,96 @@
 #include <algorithm>
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <iostream>
-#include <list>
-#include <numeric>
-#include <random>
+#include <iterator>
 #include <string_view>
-#include <vector>
 
-#include "utils/algorithm.hpp"
-#include "utils/etc.hpp"
+#include "utils/bounded_int.hpp"
 
 #include "random.hpp"
 #include "ship.h"
 
-template <typename Itr>
-static auto
-create_damaged_part_list_helper(const Itr begin, const Itr end,
-                                const int severity_min,
-                                const int severity_max) noexcept
-    -> std::list<ship::part>
+// Parts are looked up through a part_table, so for lists which are
+// arithmetic progressions, each ID is computed rather than loaded
+template <typename Table>
+static auto create_damaged_part_list_helper(
+    const int severity_min, const int severity_max,
+    const std::size_t broken_part_count) noexcept -> part_set
 {
-  std::size_t broken_part_count {
-      static_cast<std::size_t>(get_part_count())};
-
-  std::vector<int> selected_part_ids;
-
-  selected_part_ids.emplace_back(*random_select(begin, end));
-
-  while ( selected_part_ids.size() != broken_part_count ) {
-    int selected_id {*random_select(begin, end)};
-
-    // if selected_id not already in selected_part_ids
-    if ( !ehanc::contains(selected_part_ids.cbegin(),
-                          selected_part_ids.cend(), selected_id) ) {
-      selected_part_ids.push_back(selected_id);
+  constexpr ehanc::bounded_dist part_dist(
+      static_cast<std::uint32_t>(Table::size()));
+  const ehanc::bounded_dist sev_dist(
+      static_cast<std::uint32_t>(severity_max - severity_min + 1));
+
+  // Parts and their damage are drawn a block at a time
+  constexpr std::size_t block_size {32};
+  std::array<std::uint32_t, block_size> picks {};
+  std::array<std::uint32_t, block_size> severities {};
+
+  part_set retval;
+
+  // part_set::insert rejects IDs which were already selected, so each
+  // round draws again for however many parts are still missing
+  while ( retval.size() != broken_part_count ) {
+    const auto count {static_cast<long>(
+        std::min(broken_part_count - retval.size(), block_size))};
+    part_dist(random_engine(), picks.begin(),
+              std::next(picks.begin(), count));
+    sev_dist(random_engine(), severities.begin(),
+             std::next(severities.begin(), count));
+
+    for ( std::size_t i {0}; i != static_cast<std::size_t>(count); ++i ) {
+      retval.insert(Table::id(picks[i]),
+                    severity_min + static_cast<int>(severities[i]));
     }
   }
 
-  std::uniform_int_distribution sev_dist(severity_min, severity_max);
-
-  std::list<ship::part> retval;
-
-  std::for_each(selected_part_ids.cbegin(), selected_part_ids.cend(),
-                [&retval, &sev_dist](int id) noexcept {
-                  retval.emplace_back(id, sev_dist(random_engine()));
-                });
-
   return retval;
 }
 
 auto ship::create_damaged_part_list(ship::faction fact) noexcept
-    -> std::list<ship::part>
+    -> part_set
+{
+  return create_damaged_part_list(
+      fact, static_cast<std::size_t>(get_part_count()));
+}
+
+auto ship::create_damaged_part_list(ship::faction fact,
+                                    std::size_t part_count) noexcept
+    -> part_set
 {
   switch ( fact ) {
 
   case faction::human:
 
-    return create_damaged_part_list_helper(
-        conf::human_part_list.cbegin(), conf::human_part_list.cend(),
-        conf::human_severity_min, conf::human_severity_max);
+    return create_damaged_part_list_helper<human_parts>(
+        conf::human_severity_min, conf::human_severity_max,
+        part_count);
 
   case faction::ferengi:
 
-    return create_damaged_part_list_helper(
-        conf::ferengi_part_list.cbegin(), conf::ferengi_part_list.cend(),
-        conf::ferengi_severity_min, conf::ferengi_severity_max);
+    return create_damaged_part_list_helper<ferengi_parts>(
+        conf::ferengi_severity_min, conf::ferengi_severity_max,
+        part_count);
 
   case faction::klingon:
 
-    return create_damaged_part_list_helper(
-        conf::klingon_part_list.cbegin(), conf::klingon_part_list.cend(),
-        conf::klingon_severity_min, conf::klingon_severity_max);
+    return create_damaged_part_list_helper<klingon_parts>(
+        conf::klingon_severity_min, conf::klingon_severity_max,
+        part_count);
 
   case faction::romulan:
 
-    return create_damaged_part_list_helper(
-        conf::romulan_part_list.cbegin(), conf::romulan_part_list.cend(),
-        conf::romulan_severity_min, conf::romulan_severity_max);
+    return create_damaged_part_list_helper<romulan_parts>(
+        conf::romulan_severity_min, conf::romulan_severity_max,
+        part_count);
 
   case faction::other:
 
-    return create_damaged_part_list_helper(
-        conf::other_part_list.cbegin(), conf::other_part_list.cend(),
-        conf::other_severity_min, conf::other_severity_max);
+    return create_damaged_part_list_helper<other_parts>(
+        conf::other_severity_min, conf::other_severity_max,
+        part_count);
   }
 }
 
@@ -93,37 +101,39 @@ auto ship::construct_random_ship() noexcept -> ship
   return {random_faction};
 }
 
+auto ship::faction_name(const faction fact) noexcept -> std::string_view
+{
+  switch ( fact ) {
+  case faction::human:
+    return "Human";
+  case faction::ferengi:
+    return "Ferengi";
+  case faction::klingon:
+    return "Klingon";
+  case faction::romulan:
+    return "Romulan";
+  case faction::other:
+    return "Other";
+  }
+  return "Other";
+}
+
 void ship::display(std::ostream& out) const noexcept
 {
-  auto faction_to_string {[](faction fact) -> std::string_view {
-    switch ( fact ) {
-    case faction::human:
-      return "Human";
-    case faction::ferengi:
-      return "Ferengi";
-    case faction::klingon:
-      return "Klingon";
-    case faction::romulan:
-      return "Romulan";
-    case faction::other:
-      return "Other";
-    }
-  }};
+  ship::display(out, m_id, m_faction, this->get_damaged_part_count(),
+                this->repair_time());
+}
 
-  out << "Ship " << m_id << ", " << faction_to_string(m_faction)
-      << ", needing repairs for " << this->get_damaged_part_count()
-      << " parts, requiring "
-      << conf::severity_to_time(this->get_total_damage())
-      << " hours total for repair\n";
+void ship::display(std::ostream& out, const id_type id,
+                   const faction fact, const std::size_t part_count,
+                   const int hours) noexcept
+{
+  out << "Ship " << id << ", " << faction_name(fact)
+      << ", needing repairs for " << part_count << " parts, requiring "
+      << hours << " hours total for repair\n";
 }
 
 auto ship::get_total_damage() const noexcept -> int
 {
-  if ( this->is_damaged() ) {
-    return std::accumulate(
-        m_damaged_parts.cbegin(), m_damaged_parts.cend(), 0,
-        [](int acc, const part arg) noexcept { return acc + arg.damage; });
-  } else {
-    return 0;
-  }
+  return m_damaged_parts.total_damage();
 }
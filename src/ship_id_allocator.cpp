@@ -0,0 +1,7 @@
+#include "ship_id_allocator.h"
+
+auto ship_id_allocator::global() noexcept -> ship_id_allocator&
+{
+  static ship_id_allocator ids {};
+  return ids;
+}
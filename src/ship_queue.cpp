@@ -0,0 +1,329 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "utils/memory.hpp"
+
+#include "ship_queue.h"
+
+static_assert(conf::faction_priority.size() == ship::faction_count,
+              "conf::faction_priority needs one entry per faction");
+
+static constexpr std::array<std::string_view, 5> policy_names {
+    "fifo", "shortest", "longest", "faction", "aging"};
+
+auto ship_queue::policy_name(const policy order) noexcept
+    -> std::string_view
+{
+  return policy_names[static_cast<std::size_t>(order)];
+}
+
+auto ship_queue::parse_policy(const std::string_view name) noexcept
+    -> std::optional<policy>
+{
+  for ( std::size_t i {0}; i != policy_names.size(); ++i ) {
+    if ( policy_names[i] == name ) {
+      return static_cast<policy>(i);
+    }
+  }
+  return std::nullopt;
+}
+
+auto ship_queue::key_of(const ship_store::record& waiting,
+                        const std::uint64_t arrival_step) const noexcept
+    -> std::int64_t
+{
+  switch ( m_policy ) {
+  case policy::fifo:
+    return 0;
+  case policy::shortest_first:
+    return waiting.repair_time();
+  case policy::longest_first:
+    return -waiting.repair_time();
+  case policy::faction_priority:
+    return conf::faction_priority[static_cast<std::size_t>(
+        waiting.get_faction())];
+  case policy::aging:
+    // repair_time - rate * (now - arrival_step) orders ships the same
+    // way at every `now`, so the key never has to change
+    return waiting.repair_time()
+           + (static_cast<std::int64_t>(conf::queue_aging_rate)
+              * static_cast<std::int64_t>(arrival_step));
+  }
+  return 0;
+}
+
+auto ship_queue::lane_empty(const lane& ships) const noexcept -> bool
+{
+  return m_policy == policy::fifo ? ships.fifo.empty()
+                                  : ships.order.empty();
+}
+
+auto ship_queue::best_lane(const ship::faction_mask accepted) const
+    noexcept -> std::optional<std::size_t>
+{
+  std::optional<std::size_t> best {};
+  key best_key {};
+
+  const std::size_t lane_count {m_split ? m_lanes.size() : 1};
+
+  for ( std::size_t i {0}; i != lane_count; ++i ) {
+    const lane& ships {m_lanes[i]};
+    if ( this->lane_empty(ships)
+         || (m_split
+             && (accepted
+                 & ship::faction_bit(static_cast<ship::faction>(i)))
+                    == 0) ) {
+      continue;
+    }
+
+    const key front_key {m_policy == policy::fifo
+                             ? key {0, ships.fifo.front().order}
+                             : ships.order.top_key()};
+    if ( not best.has_value() || front_key < best_key ) {
+      best = i;
+      best_key = front_key;
+    }
+  }
+
+  return best;
+}
+
+auto ship_queue::lane_front(const lane& ships) const noexcept
+    -> const ship_store::record&
+{
+  if ( m_policy == policy::fifo ) {
+    return ships.fifo.front().waiting;
+  }
+  return ships.slots[ships.order.top()];
+}
+
+void ship_queue::add_totals(const ship_store::record& waiting,
+                            const bool arriving)
+{
+  const auto hours {static_cast<std::uint64_t>(waiting.repair_time())};
+  const auto parts {
+      static_cast<std::uint64_t>(waiting.get_damaged_part_count())};
+  const auto fact {static_cast<std::size_t>(waiting.get_faction())};
+
+  if ( arriving ) {
+    m_repair_hours += hours;
+    m_part_count += parts;
+    ++m_faction_sizes[fact];
+    m_faction_hours[fact] += hours;
+  } else {
+    m_repair_hours -= hours;
+    m_part_count -= parts;
+    --m_faction_sizes[fact];
+    m_faction_hours[fact] -= hours;
+  }
+
+  if ( m_policy == policy::shortest_first
+       || m_policy == policy::longest_first ) {
+    const auto time {static_cast<std::size_t>(waiting.repair_time())};
+    const std::int64_t sign {arriving ? 1 : -1};
+    m_time_ships.add(time, sign);
+    m_time_hours.add(time, sign * static_cast<std::int64_t>(hours));
+  }
+}
+
+auto ship_queue::memory_footprint() const noexcept -> std::size_t
+{
+  std::size_t bytes {m_store.memory_footprint()
+                     + m_time_ships.memory_footprint()
+                     + m_time_hours.memory_footprint()};
+
+  for ( const lane& ships : m_lanes ) {
+    bytes += ehanc::heap_bytes(ships.fifo) + ehanc::heap_bytes(ships.slots)
+             + ehanc::heap_bytes(ships.free_slots)
+             + ships.order.memory_footprint()
+             + ships.newest.memory_footprint();
+  }
+
+  return bytes + ehanc::heap_bytes(m_pushed) + ehanc::heap_bytes(m_popped);
+}
+
+auto ship_queue::work_ahead(const ship& arriving) const noexcept -> work
+{
+  const auto time {static_cast<std::size_t>(arriving.repair_time())};
+
+  // Ties go to the earlier arrival, so ships with the same key are
+  // always ahead
+  switch ( m_policy ) {
+  case policy::shortest_first:
+    return work {
+        static_cast<std::size_t>(m_time_ships.prefix_sum(time + 1)),
+        static_cast<std::uint64_t>(m_time_hours.prefix_sum(time + 1))};
+  case policy::longest_first:
+    return work {
+        static_cast<std::size_t>(m_time_ships.total()
+                                 - m_time_ships.prefix_sum(time)),
+        static_cast<std::uint64_t>(m_time_hours.total()
+                                   - m_time_hours.prefix_sum(time))};
+  case policy::faction_priority: {
+    const int priority {conf::faction_priority[static_cast<std::size_t>(
+        arriving.get_faction())]};
+    work ahead {};
+    for ( std::size_t i {0}; i != ship::faction_count; ++i ) {
+      if ( conf::faction_priority[i] <= priority ) {
+        ahead.ships += m_faction_sizes[i];
+        ahead.hours += m_faction_hours[i];
+      }
+    }
+    return ahead;
+  }
+  case policy::fifo:
+  case policy::aging:
+    break;
+  }
+
+  return work {m_size, m_repair_hours};
+}
+
+void ship_queue::insert(const ship_store::record& waiting,
+                        const placement where)
+{
+  lane& ships {
+      m_lanes[m_split ? static_cast<std::size_t>(waiting.get_faction())
+                      : 0]};
+
+  this->add_totals(waiting, true);
+
+  if ( m_policy == policy::fifo ) {
+    ships.fifo.push_back(arrival {where.order, waiting});
+  } else {
+    std::size_t slot {ships.slots.size()};
+    if ( ships.free_slots.empty() ) {
+      ships.slots.emplace_back();
+    } else {
+      slot = ships.free_slots.back();
+      ships.free_slots.pop_back();
+    }
+
+    ships.slots[slot] = waiting;
+    ships.order.push(slot, key {where.key, where.order});
+    ships.newest.push(slot, where.order);
+  }
+
+  ++m_size;
+}
+
+void ship_queue::push(std::vector<ship>::iterator first,
+                      const std::vector<ship>::iterator last,
+                      const std::uint64_t arrival_step)
+{
+  for ( ; first != last; ++first ) {
+    const ship_store::record waiting {m_store.store(std::move(*first))};
+    const placement where {m_arrivals,
+                           this->key_of(waiting, arrival_step)};
+    this->insert(waiting, where);
+
+    if ( m_track_changes ) {
+      m_pushed.push_back(pushed_ship {where, waiting, false});
+    }
+
+    ++m_arrivals;
+  }
+}
+
+void ship_queue::restore(const placement where, ship&& waiting)
+{
+  this->insert(m_store.store(std::move(waiting)), where);
+  m_arrivals = std::max(m_arrivals, where.order + 1);
+}
+
+void ship_queue::track_changes(const bool track) noexcept
+{
+  m_track_changes = track;
+  this->clear_changes();
+}
+
+void ship_queue::clear_changes() noexcept
+{
+  m_first_pushed = m_arrivals;
+  m_pushed.clear();
+  m_popped.clear();
+}
+
+void ship_queue::note_pop(const std::uint64_t order)
+{
+  // Every arrival since m_first_pushed is in m_pushed, in order
+  if ( order >= m_first_pushed ) {
+    m_pushed[order - m_first_pushed].popped = true;
+  } else {
+    m_popped.push_back(order);
+  }
+}
+
+auto ship_queue::pop() noexcept -> ship
+{
+  // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+  return std::move(*this->pop(ship::every_faction));
+}
+
+auto ship_queue::pop(const ship::faction_mask accepted) noexcept
+    -> std::optional<ship>
+{
+  const std::optional<std::size_t> index {this->best_lane(accepted)};
+  if ( not index.has_value() ) {
+    return std::nullopt;
+  }
+
+  lane& ships {m_lanes[*index]};
+  ship_store::record next {};
+  --m_size;
+
+  if ( m_policy == policy::fifo ) {
+    if ( m_track_changes ) {
+      this->note_pop(ships.fifo.front().order);
+    }
+    next = ships.fifo.front().waiting;
+    ships.fifo.pop_front();
+  } else {
+    if ( m_track_changes ) {
+      this->note_pop(ships.order.top_key().second);
+    }
+    const std::size_t slot {ships.order.pop()};
+    ships.newest.erase(slot);
+    next = ships.slots[slot];
+    ships.free_slots.push_back(slot);
+  }
+
+  this->add_totals(next, false);
+  return m_store.take(next);
+}
+
+auto ship_queue::front() const noexcept -> const ship_store::record&
+{
+  // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+  return this->lane_front(m_lanes[*this->best_lane(ship::every_faction)]);
+}
+
+auto ship_queue::back() const noexcept -> const ship_store::record&
+{
+  const ship_store::record* newest {nullptr};
+  std::uint64_t newest_order {0};
+
+  for ( const lane& ships : m_lanes ) {
+    if ( this->lane_empty(ships) ) {
+      continue;
+    }
+
+    const std::uint64_t order {m_policy == policy::fifo
+                                   ? ships.fifo.back().order
+                                   : ships.newest.top_key()};
+    if ( newest == nullptr || order > newest_order ) {
+      newest = m_policy == policy::fifo
+                   ? &ships.fifo.back().waiting
+                   : &ships.slots[ships.newest.top()];
+      newest_order = order;
+    }
+  }
+
+  return *newest;
+}
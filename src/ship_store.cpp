@@ -0,0 +1,82 @@
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "utils/memory.hpp"
+
+#include "ship_store.h"
+
+void ship_store::next_page()
+{
+  if ( m_free_pages.empty() ) {
+    m_page = m_pages.size();
+    m_pages.emplace_back(page_words);
+    m_live.push_back(0);
+  } else {
+    m_page = m_free_pages.back();
+    m_free_pages.pop_back();
+  }
+  m_fill = 0;
+}
+
+auto ship_store::store(ship&& src) -> record
+{
+  const part_set& damaged {src.get_damaged_parts_list()};
+  if ( m_fill + damaged.size() > page_words ) {
+    this->next_page();
+  }
+
+  const auto parts {static_cast<handle>((m_page << offset_bits) | m_fill)};
+  std::vector<std::uint32_t>& page {m_pages[m_page]};
+  for ( const part_set::part& broken : damaged ) {
+    page[m_fill++] = (static_cast<std::uint32_t>(broken.id) << 8U)
+                     | static_cast<std::uint32_t>(broken.damage);
+  }
+  ++m_live[m_page];
+
+  return record {src.get_id(), parts, src.get_faction(), damaged.size(),
+                 src.repair_time()};
+}
+
+auto ship_store::parts(const record& stored) const -> part_set
+{
+  const std::size_t page {stored.parts() >> offset_bits};
+  const std::size_t offset {stored.parts() & ((1U << offset_bits) - 1)};
+
+  // Parts were stored in ascending ID order, so each insert appends
+  const std::size_t last {offset + stored.get_damaged_part_count()};
+  part_set damaged;
+  for ( std::size_t i {offset}; i != last; ++i ) {
+    const std::uint32_t word {m_pages[page][i]};
+    damaged.insert(static_cast<int>(word >> 8U),
+                   static_cast<int>(word & 0xFFU));
+  }
+  return damaged;
+}
+
+auto ship_store::take(const record& stored) -> ship
+{
+  ship retval(stored.get_id(), stored.get_faction(), this->parts(stored));
+
+  // The page being filled is not recycled, but filled again from the
+  // start
+  const std::size_t page {stored.parts() >> offset_bits};
+  if ( --m_live[page] == 0 ) {
+    if ( page == m_page ) {
+      m_fill = 0;
+    } else {
+      m_free_pages.push_back(page);
+    }
+  }
+
+  return retval;
+}
+
+auto ship_store::memory_footprint() const noexcept -> std::size_t
+{
+  // Every page is allocated whole
+  return ehanc::heap_bytes(m_pages) + ehanc::heap_bytes(m_live)
+         + ehanc::heap_bytes(m_free_pages)
+         + (m_pages.size() * page_words * sizeof(std::uint32_t));
+}
@@ -1,34 +1,236 @@
 #include <algorithm>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <optional>
 #include <utility>
 #include <vector>
 
+#include "utils/algorithm.hpp"
 #include "utils/etc.hpp"
+#include "utils/execution.hpp"
+#include "utils/memory.hpp"
 
-#include "random.hpp"
 #include "space_station.h"
 
+// std::push_heap and std::pop_heap work with signed distances, which
+// GCC warns may overflow at -O3, so the heaps here sift by hand with
+// unsigned positions. `later(lhs, rhs)` is true if `lhs` should come out
+// of the heap after `rhs`.
+template <typename T, typename Later>
+static void heap_push(std::vector<T>& heap, const T value,
+                      const Later later)
+{
+  std::size_t position {heap.size()};
+  heap.push_back(value);
+  while ( position != 0 ) {
+    const std::size_t parent {(position - 1) / 2};
+    if ( not later(heap[parent], value) ) {
+      break;
+    }
+    heap[position] = heap[parent];
+    position = parent;
+  }
+  heap[position] = value;
+}
+
+// Removes the front of a heap built by heap_push()
+template <typename T, typename Later>
+static void heap_pop(std::vector<T>& heap, const Later later)
+{
+  const T last {heap.back()};
+  heap.pop_back();
+  if ( heap.empty() ) {
+    return;
+  }
+
+  const std::size_t size {heap.size()};
+  std::size_t position {0};
+  for ( std::size_t child {1}; child < size;
+        child = (2 * position) + 1 ) {
+    if ( child + 1 < size && later(heap[child], heap[child + 1]) ) {
+      ++child;
+    }
+    if ( not later(last, heap[child]) ) {
+      break;
+    }
+    heap[position] = heap[child];
+    position = child;
+  }
+  heap[position] = last;
+}
+
 auto space_station::step() noexcept -> step_summary
 {
-  const std::size_t new_ship_count {
-      static_cast<std::size_t>(get_new_ship_count())};
+  const arrival_generator::arrivals new_ships {m_arrivals.next_step()};
 
-  // new ships get in line
-  for ( std::size_t i {0}; i != new_ship_count; ++i ) {
-    m_repair_queue.push(ship::construct_random_ship());
+  return this->step(new_ships.begin(), new_ships.end());
+}
+
+void space_station::dock_next(repair_bay& bay) noexcept
+{
+  // A specialized bay takes the best ship it can repair, if any
+  std::optional<ship> next {m_repair_queue.pop(bay.spec().factions)};
+  if ( not next.has_value() ) {
+    return;
+  }
+
+  // Docking happens in the step after m_step_count
+  const std::uint64_t hour {m_step_count + 1};
+
+  if ( m_check_predictions ) {
+    const auto predicted {m_predicted_docks.find(next->get_id())};
+    if ( predicted != m_predicted_docks.end() ) {
+      const auto error {static_cast<std::int64_t>(hour)
+                        - static_cast<std::int64_t>(predicted->second)};
+      const auto abs_error {
+          static_cast<std::uint64_t>(error < 0 ? -error : error)};
+
+      ++m_prediction_stats.ships;
+      m_prediction_stats.total_error += error;
+      m_prediction_stats.total_abs_error += abs_error;
+      m_prediction_stats.max_abs_error =
+          std::max(m_prediction_stats.max_abs_error, abs_error);
+      m_predicted_docks.erase(predicted);
+    }
+  }
+
+  const auto index {static_cast<std::size_t>(&bay - m_bays.data())};
+  m_bay_dock_hours[index] = hour;
+  if ( m_track_changes && not m_bay_changed[index] ) {
+    m_bay_changed[index] = true;
+    m_changed_bays.push_back(index);
+  }
+
+  m_docked_ship_hours += static_cast<std::uint64_t>(next->repair_time());
+  bay.dock(std::move(*next));
+  m_docked_bay_hours += static_cast<std::uint64_t>(bay.time_remaining());
+  ++m_docked_ships;
+
+  const std::uint64_t free_hour {
+      hour + static_cast<std::uint64_t>(bay.time_remaining())};
+  heap_push(m_bay_free_hours, free_hour, std::greater<> {});
+  m_bay_free_hour_sum += free_hour;
+}
+
+void space_station::prune_bay_free_hours() noexcept
+{
+  while ( not m_bay_free_hours.empty()
+          && m_bay_free_hours.front() <= m_step_count ) {
+    m_bay_free_hour_sum -= m_bay_free_hours.front();
+    heap_pop(m_bay_free_hours, std::greater<> {});
+  }
+}
+
+auto space_station::nth_bay_free_hour(const std::size_t rank) const
+    -> std::uint64_t
+{
+  // Walks the heap smallest first, with a second heap holding the
+  // frontier of positions not yet taken
+  const auto later {[this](const std::size_t lhs, const std::size_t rhs) {
+    return m_bay_free_hours[lhs] > m_bay_free_hours[rhs];
+  }};
+
+  std::vector<std::size_t> frontier {0};
+  for ( std::size_t taken {0}; taken != rank; ++taken ) {
+    const std::size_t position {frontier.front()};
+    heap_pop(frontier, later);
+
+    for ( const std::size_t child : {(2 * position) + 1,
+                                     (2 * position) + 2} ) {
+      if ( child < m_bay_free_hours.size() ) {
+        heap_push(frontier, child, later);
+      }
+    }
+  }
+
+  return m_bay_free_hours[frontier.front()];
+}
+
+auto space_station::bay_hours_per_hour() const noexcept -> double
+{
+  if ( m_docked_ship_hours == 0 ) {
+    return 1.0 / m_mean_bay_speed;
+  }
+  return static_cast<double>(m_docked_bay_hours)
+         / static_cast<double>(m_docked_ship_hours);
+}
+
+auto space_station::predict(const ship& arriving) const -> prediction
+{
+  const std::uint64_t hour {m_step_count + 1};
+
+  if ( m_bays.empty() ) {
+    return prediction {std::numeric_limits<std::uint64_t>::max(),
+                       std::numeric_limits<std::uint64_t>::max()};
   }
 
+  const ship_queue::work ahead {m_repair_queue.work_ahead(arriving)};
+
+  // Every bay in the heap frees up in this step or later
+  const std::size_t busy {m_bay_free_hours.size()};
+  const std::size_t idle {m_bays.size() - busy};
+
+  std::uint64_t dock_hour {hour};
+  if ( ahead.ships >= idle && ahead.ships < m_bays.size() ) {
+    dock_hour = this->nth_bay_free_hour(ahead.ships - idle);
+  } else if ( ahead.ships >= m_bays.size() ) {
+    const double bays {static_cast<double>(m_bays.size())};
+    const double mean_repair {
+        m_docked_ships == 0 ? 0.0
+                            : static_cast<double>(m_docked_bay_hours)
+                                  / static_cast<double>(m_docked_ships)};
+
+    const double bay_hours {
+        static_cast<double>(m_bay_free_hour_sum - (busy * hour))
+        + (static_cast<double>(ahead.hours) * this->bay_hours_per_hour())
+        - ((bays - 1.0) * mean_repair / 2.0)};
+    dock_hour = hour
+                + static_cast<std::uint64_t>(
+                    std::max(std::round(bay_hours / bays), 0.0));
+  }
+
+  const double repair_hours {static_cast<double>(arriving.repair_time())
+                             * this->bay_hours_per_hour()};
+
+  return prediction {
+      dock_hour,
+      dock_hour
+          + static_cast<std::uint64_t>(
+              std::max(std::round(repair_hours), 1.0))};
+}
+
+void space_station::add_part_events(
+    const std::size_t index, const repair_bay& bay,
+    std::vector<part_event>& events) noexcept
+{
+  for ( const repair_bay::part_progress part :
+        bay.last_finished_parts() ) {
+    events.push_back(part_event {index, bay.tracked_ship_id(),
+                                 static_cast<int>(part.id)});
+  }
+}
+
+auto space_station::step_bays() noexcept -> std::size_t
+{
   std::size_t exiting_ship_count {0};
 
   // all bays step (tick down timer, clear if done), then,
   // if empty, dock next in line
-  for ( repair_bay& bay : m_bays ) {
+  for ( std::size_t i {0}; i != m_bays.size(); ++i ) {
+    repair_bay& bay {m_bays[i]};
     const bool ship_left_bay {bay.step()};
+    if ( m_track_parts ) {
+      add_part_events(i, bay, m_part_events);
+    }
     if ( bay.empty() ) {
       if ( this->queue_size() != 0 ) {
-        bay.dock(std::move(m_repair_queue.front()));
-        m_repair_queue.pop();
+        this->dock_next(bay);
       }
       if ( ship_left_bay ) {
         ++exiting_ship_count;
@@ -36,8 +238,96 @@ auto space_station::step() noexcept -> step_summary
     }
   }
 
+  return exiting_ship_count;
+}
+
+auto space_station::step_bays_sharded() noexcept -> std::size_t
+{
+  // Stepping a bay never depends on the queue, so every bay can step
+  // first, in parallel, and then docking happens in bay order, exactly
+  // as in step_bays().
+  // Unless some bays turn ships away, no more bays can take a ship than
+  // there are ships waiting, so no shard needs to list more empty bays.
+  const std::size_t wanted {m_repair_queue.split_by_faction()
+                                ? m_bays.size()
+                                : this->queue_size()};
+
+  const auto step_shard {[this, wanted](
+                             const std::size_t shard,
+                             std::vector<std::size_t>& empty_bays,
+                             std::vector<part_event>& events,
+                             std::size_t& leaving) {
+    const std::size_t first_bay {shard * conf::bay_shard_size};
+    const std::size_t last_bay {
+        std::min(first_bay + conf::bay_shard_size, m_bays.size())};
+
+    empty_bays.clear();
+    events.clear();
+    leaving = 0;
+    for ( std::size_t i {first_bay}; i != last_bay; ++i ) {
+      const bool ship_left_bay {m_bays[i].step()};
+      if ( m_track_parts ) {
+        add_part_events(i, m_bays[i], events);
+      }
+      if ( m_bays[i].empty() ) {
+        if ( empty_bays.size() != wanted ) {
+          empty_bays.push_back(i);
+        }
+        if ( ship_left_bay ) {
+          ++leaving;
+        }
+      }
+    }
+  }};
+
+  ehanc::for_each_all(ehanc::execution::par.on(*m_pool), step_shard,
+                      m_shard_ids, m_shard_empty_bays,
+                      m_shard_part_events, m_shard_leaving);
+
+  std::size_t exiting_ship_count {0};
+  for ( std::size_t shard {0}; shard != m_shard_leaving.size(); ++shard ) {
+    exiting_ship_count += m_shard_leaving[shard];
+    m_part_events.insert(m_part_events.end(),
+                         m_shard_part_events[shard].cbegin(),
+                         m_shard_part_events[shard].cend());
+  }
+
+  for ( const std::vector<std::size_t>& empty_bays : m_shard_empty_bays ) {
+    for ( const std::size_t index : empty_bays ) {
+      if ( this->queue_size() == 0 ) {
+        return exiting_ship_count;
+      }
+      this->dock_next(m_bays[index]);
+    }
+  }
+
+  return exiting_ship_count;
+}
+
+auto space_station::step(std::vector<ship>::iterator first,
+                         std::vector<ship>::iterator last) noexcept
+    -> step_summary
+{
+  const auto new_ship_count {static_cast<std::size_t>(last - first)};
+
+  // new ships get in line
+  if ( m_check_predictions ) {
+    for ( ; first != last; ++first ) {
+      m_predicted_docks.emplace(first->get_id(),
+                                this->predict(*first).dock_hour);
+      m_repair_queue.push(first, std::next(first), m_step_count + 1);
+    }
+  } else {
+    m_repair_queue.push(first, last, m_step_count + 1);
+  }
+
+  m_part_events.clear();
+  const std::size_t exiting_ship_count {
+      m_pool ? this->step_bays_sharded() : this->step_bays()};
+
   // increase internal counter
   ++m_step_count;
+  this->prune_bay_free_hours();
 
   m_last_step_summary = step_summary {new_ship_count, exiting_ship_count};
 
@@ -54,8 +344,11 @@ void space_station::display(std::ostream& out) const noexcept
   out << conf::header_line << '\n' << '\n';
 
   out << m_last_step_summary.new_ships << " ships arrived, "
-      << m_last_step_summary.leaving_ships << " ships exited." << '\n'
-      << '\n';
+      << m_last_step_summary.leaving_ships << " ships exited";
+  if ( m_track_parts ) {
+    out << ", " << m_part_events.size() << " parts repaired";
+  }
+  out << "." << '\n' << '\n';
 
   std::for_each(m_bays.cbegin(), m_bays.cend(),
                 [&out, index {0}](const repair_bay& bay) mutable {
@@ -80,6 +373,82 @@ void space_station::display(std::ostream& out) const noexcept
   }
 }
 
+auto space_station::predicted_dock(const ship::id_type id) const noexcept
+    -> std::optional<std::uint64_t>
+{
+  const auto predicted {m_predicted_docks.find(id)};
+  if ( predicted == m_predicted_docks.end() ) {
+    return std::nullopt;
+  }
+  return predicted->second;
+}
+
+auto space_station::get_counters() const noexcept -> counters
+{
+  return counters {m_step_count,         m_repair_queue.arrival_count(),
+                   m_docked_ships,       m_docked_ship_hours,
+                   m_docked_bay_hours,   m_prediction_stats,
+                   m_last_step_summary};
+}
+
+void space_station::track_changes(const bool track) noexcept
+{
+  m_track_changes = track;
+  m_bay_changed.assign(track ? m_bays.size() : 0, false);
+  m_changed_bays.clear();
+  m_repair_queue.track_changes(track);
+}
+
+void space_station::clear_changes() noexcept
+{
+  for ( const std::size_t index : m_changed_bays ) {
+    m_bay_changed[index] = false;
+  }
+  m_changed_bays.clear();
+  m_repair_queue.clear_changes();
+}
+
+void space_station::restore_counters(const counters& saved) noexcept
+{
+  m_step_count = saved.step_count;
+  m_repair_queue.restore_arrival_count(saved.queue_arrivals);
+  m_docked_ships = saved.docked_ships;
+  m_docked_ship_hours = saved.docked_ship_hours;
+  m_docked_bay_hours = saved.docked_bay_hours;
+  m_prediction_stats = saved.predictions;
+  m_last_step_summary = saved.last_step;
+}
+
+void space_station::restore_bay(const std::size_t index, ship&& docked,
+                                const std::uint64_t dock_hour) noexcept
+{
+  repair_bay& bay {m_bays[index]};
+  bay.dock(std::move(docked));
+  m_bay_dock_hours[index] = dock_hour;
+
+  // The bay has stepped once in every step since the one it docked in
+  for ( std::uint64_t hour {dock_hour}; hour != m_step_count; ++hour ) {
+    if ( bay.step() ) {
+      return;
+    }
+  }
+
+  const std::uint64_t free_hour {
+      m_step_count + static_cast<std::uint64_t>(bay.time_remaining())};
+  heap_push(m_bay_free_hours, free_hour, std::greater<> {});
+  m_bay_free_hour_sum += free_hour;
+}
+
+void space_station::restore_waiting(
+    const ship_queue::placement where, ship&& waiting,
+    const std::optional<std::uint64_t> predicted)
+{
+  if ( m_check_predictions && predicted.has_value() ) {
+    m_predicted_docks.emplace(waiting.get_id(), *predicted);
+  }
+  m_repair_queue.restore(where, std::move(waiting));
+}
+
 auto space_station::empty_bay_count() const noexcept -> int
 {
   return static_cast<int>(
@@ -93,3 +462,38 @@ auto space_station::occupied_bay_count() const noexcept -> int
       m_bays.cbegin(), m_bays.cend(),
       [](const repair_bay& bay) { return not bay.empty(); }));
 }
+
+auto space_station::total_bay_time_remaining() const noexcept -> long
+{
+  return std::accumulate(m_bays.cbegin(), m_bays.cend(), 0L,
+                         [](const long sum, const repair_bay& bay) {
+                           return sum + bay.time_remaining();
+                         });
+}
+
+auto space_station::memory_footprint() const noexcept -> std::size_t
+{
+  std::size_t bytes {ehanc::heap_bytes(m_bays)};
+  for ( const repair_bay& bay : m_bays ) {
+    bytes += bay.memory_footprint();
+  }
+
+  bytes += ehanc::heap_bytes(m_shard_ids)
+           + ehanc::heap_bytes(m_shard_empty_bays)
+           + ehanc::heap_bytes(m_shard_leaving)
+           + ehanc::heap_bytes(m_shard_part_events);
+  for ( std::size_t shard {0}; shard != m_shard_empty_bays.size();
+        ++shard ) {
+    bytes += ehanc::heap_bytes(m_shard_empty_bays[shard])
+             + ehanc::heap_bytes(m_shard_part_events[shard]);
+  }
+
+  return bytes + ehanc::heap_bytes(m_bay_dock_hours)
+         + ehanc::heap_bytes(m_changed_bays)
+         + ehanc::heap_bytes(m_bay_changed)
+         + ehanc::heap_bytes(m_part_events)
+         + ehanc::heap_bytes(m_bay_free_hours)
+         + ehanc::heap_bytes(m_predicted_docks)
+         + m_repair_queue.memory_footprint()
+         + m_arrivals.memory_footprint();
+}
@@ -0,0 +1,8 @@
+#ifndef TEST_ALGORITHM_HPP
+#define TEST_ALGORITHM_HPP
+
+#include "utils/algorithm.hpp"
+
+void test_algorithm();
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef TEST_ARRIVAL_GENERATOR_H
+#define TEST_ARRIVAL_GENERATOR_H
+
+#include "arrival_generator.h"
+
+void test_arrival_generator();
+
+#endif
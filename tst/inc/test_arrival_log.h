@@ -0,0 +1,8 @@
+#ifndef TEST_ARRIVAL_LOG_H
+#define TEST_ARRIVAL_LOG_H
+
+#include "arrival_log.h"
+
+void test_arrival_log();
+
+#endif
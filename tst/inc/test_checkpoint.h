@@ -0,0 +1,8 @@
+#ifndef TEST_CHECKPOINT_H
+#define TEST_CHECKPOINT_H
+
+#include "checkpoint.h"
+
+void test_checkpoint();
+
+#endif
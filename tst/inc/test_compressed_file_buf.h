@@ -0,0 +1,8 @@
+#ifndef TEST_COMPRESSED_FILE_BUF_H
+#define TEST_COMPRESSED_FILE_BUF_H
+
+#include "compressed_file_buf.h"
+
+void test_compressed_file_buf();
+
+#endif
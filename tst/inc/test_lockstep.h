@@ -0,0 +1,8 @@
+#ifndef TEST_LOCKSTEP_H
+#define TEST_LOCKSTEP_H
+
+#include "lockstep.h"
+
+void test_lockstep();
+
+#endif
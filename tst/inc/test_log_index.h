@@ -0,0 +1,8 @@
+#ifndef TEST_LOG_INDEX_H
+#define TEST_LOG_INDEX_H
+
+#include "log_index.h"
+
+void test_log_index();
+
+#endif
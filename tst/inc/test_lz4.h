@@ -0,0 +1,8 @@
+#ifndef TEST_LZ4_H
+#define TEST_LZ4_H
+
+#include "lz4.h"
+
+void test_lz4();
+
+#endif
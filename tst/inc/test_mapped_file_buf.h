@@ -0,0 +1,8 @@
+#ifndef TEST_MAPPED_FILE_BUF_H
+#define TEST_MAPPED_FILE_BUF_H
+
+#include "mapped_file_buf.h"
+
+void test_mapped_file_buf();
+
+#endif
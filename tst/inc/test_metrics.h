@@ -0,0 +1,8 @@
+#ifndef TEST_METRICS_H
+#define TEST_METRICS_H
+
+#include "metrics.h"
+
+void test_metrics();
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef TEST_PART_SET_H
+#define TEST_PART_SET_H
+
+#include "part_set.h"
+
+void test_part_set();
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef TEST_SHIP_ID_ALLOCATOR_H
+#define TEST_SHIP_ID_ALLOCATOR_H
+
+#include "ship_id_allocator.h"
+
+void test_ship_id_allocator();
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef TEST_SHIP_QUEUE_H
+#define TEST_SHIP_QUEUE_H
+
+#include "ship_queue.h"
+
+void test_ship_queue();
+
+#endif
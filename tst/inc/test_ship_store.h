@@ -0,0 +1,8 @@
+#ifndef TEST_SHIP_STORE_H
+#define TEST_SHIP_STORE_H
+
+#include "ship_store.h"
+
+void test_ship_store();
+
+#endif
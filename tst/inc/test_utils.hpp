@@ -1,13 +1,25 @@
 #ifndef EHANC_TEST_UTILS_HPP
 #define EHANC_TEST_UTILS_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
 #include <functional>
+#include <future>
 #include <iomanip>
 #include <iostream>
+#include <map>
+#include <numeric>
+#include <random>
 #include <sstream>
 #include <string>
 #include <string_view>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 #include "utils/etc.hpp"
 #include "utils/term_colors.h"
@@ -64,23 +76,230 @@ public:
 
 }; // class test
 
+/* {{{ doc */
+/**
+ * @brief Running count, mean, variance, and extremes of a stream of
+ * samples (Welford's algorithm), so that large sampling tests need not
+ * store their samples. Partial results from separate threads are
+ * combined with `merge`.
+ */
+/* }}} */
+class running_stats
+{
+private:
+
+  std::size_t m_count {0};
+  double m_mean {0.0};
+  double m_m2 {0.0};
+  double m_min {0.0};
+  double m_max {0.0};
+
+public:
+
+  inline void push(const double value) noexcept
+  {
+    if ( m_count == 0 ) {
+      m_min = value;
+      m_max = value;
+    } else {
+      m_min = std::min(m_min, value);
+      m_max = std::max(m_max, value);
+    }
+
+    ++m_count;
+    const double delta {value - m_mean};
+    m_mean += delta / static_cast<double>(m_count);
+    m_m2 += delta * (value - m_mean);
+  }
+
+  inline void merge(const running_stats& other) noexcept
+  {
+    if ( other.m_count == 0 ) {
+      return;
+    }
+    if ( m_count == 0 ) {
+      *this = other;
+      return;
+    }
+
+    const auto count {static_cast<double>(m_count)};
+    const auto other_count {static_cast<double>(other.m_count)};
+    const double total {count + other_count};
+    const double delta {other.m_mean - m_mean};
+
+    m_mean += delta * other_count / total;
+    m_m2 += other.m_m2 + (delta * delta * count * other_count / total);
+    m_count += other.m_count;
+    m_min = std::min(m_min, other.m_min);
+    m_max = std::max(m_max, other.m_max);
+  }
+
+  [[nodiscard]] inline auto count() const noexcept -> std::size_t
+  {
+    return m_count;
+  }
+
+  [[nodiscard]] inline auto mean() const noexcept -> double
+  {
+    return m_mean;
+  }
+
+  [[nodiscard]] inline auto variance() const noexcept -> double
+  {
+    return m_count > 1 ? m_m2 / static_cast<double>(m_count - 1) : 0.0;
+  }
+
+  [[nodiscard]] inline auto min() const noexcept -> double
+  {
+    return m_min;
+  }
+
+  [[nodiscard]] inline auto max() const noexcept -> double
+  {
+    return m_max;
+  }
+};
+
+/* {{{ doc */
+/**
+ * @brief Counts of how many times each of the values
+ * [0, size) occurred in a stream of samples.
+ */
+/* }}} */
+class histogram
+{
+private:
+
+  std::vector<std::size_t> m_counts;
+
+public:
+
+  explicit histogram(const std::size_t size)
+      : m_counts(size)
+  {}
+
+  inline void push(const std::size_t value)
+  {
+    ++m_counts.at(value);
+  }
+
+  inline void merge(const histogram& other)
+  {
+    for ( std::size_t i {0}; i != m_counts.size(); ++i ) {
+      m_counts[i] += other.m_counts.at(i);
+    }
+  }
+
+  [[nodiscard]] inline auto count(const std::size_t value) const
+      -> std::size_t
+  {
+    return m_counts.at(value);
+  }
+
+  [[nodiscard]] inline auto total() const -> std::size_t
+  {
+    return std::accumulate(m_counts.cbegin(), m_counts.cend(),
+                           std::size_t {0});
+  }
+};
+
+/* {{{ doc */
+/**
+ * @brief Seed every test's random stream is derived from. Taken from the
+ * `ZEBRA_TEST_SEED` environment variable if set, otherwise random.
+ */
+/* }}} */
+inline auto test_base_seed() -> std::uint32_t
+{
+  static const std::uint32_t seed {[]() -> std::uint32_t {
+    // NOLINTNEXTLINE(concurrency-mt-unsafe)
+    const char* const env_seed {std::getenv("ZEBRA_TEST_SEED")};
+    if ( env_seed != nullptr ) {
+      return static_cast<std::uint32_t>(std::stoul(env_seed));
+    }
+    return std::random_device {}();
+  }()}; // IILE
+  return seed;
+}
+
+/* {{{ doc */
+/**
+ * @brief Seed of the test running on the calling thread.
+ */
+/* }}} */
+inline auto current_test_seed() -> std::uint32_t&
+{
+  thread_local std::uint32_t seed {test_base_seed()};
+  return seed;
+}
+
+/* {{{ doc */
+/**
+ * @brief Stream test results are written to from the calling thread.
+ * Sections running concurrently each write to their own buffer.
+ */
+/* }}} */
+inline auto test_output() -> std::ostream*&
+{
+  thread_local std::ostream* out {&std::cout};
+  return out;
+}
+
+/* {{{ doc */
+/**
+ * @brief Number of failed tests so far, across all threads.
+ */
+/* }}} */
+inline auto test_failures() -> std::atomic<int>&
+{
+  static std::atomic<int> failures {0};
+  return failures;
+}
+
+/* {{{ doc */
+/**
+ * @brief Seeds the calling thread's random engine, whatever the code
+ * under test draws from, before each test. Unset by default, in which
+ * case tests only get a seed in `current_test_seed()`.
+ */
+/* }}} */
+inline auto test_seeder() -> std::function<void(std::uint32_t)>&
+{
+  static std::function<void(std::uint32_t)> seeder {};
+  return seeder;
+}
+
 inline void run_test(const std::string_view name,
                      const std::function<test()>& test_func)
 {
+  // Each test gets its own stream, derived from the base seed and its
+  // name, so that it reproduces regardless of scheduling
+  std::uint32_t seed {test_base_seed()};
+  for ( const char c : name ) {
+    seed = (seed ^ static_cast<std::uint8_t>(c)) * 16777619U;
+  }
+  current_test_seed() = seed;
+  if ( test_seeder() ) {
+    test_seeder()(seed);
+  }
+
   test result = test_func();
 
+  std::ostream& out {*test_output()};
+
   if ( result.pass() ) {
-    std::cout << std::left << std::setw(TEST_OUTPUT_WIDTH)
-              << std::setfill('.') << name << FG_GREEN << "PASS" << RESET
-              << '\n';
+    out << std::left << std::setw(TEST_OUTPUT_WIDTH) << std::setfill('.')
+        << name << FG_GREEN << "PASS" << RESET << '\n';
   } else {
-    std::cout << std::left << std::setw(TEST_OUTPUT_WIDTH)
-              << std::setfill('.') << name << FG_RED << "FAIL" << RESET
-              << '\n'
-              << '\n';
+    ++test_failures();
+
+    out << std::left << std::setw(TEST_OUTPUT_WIDTH) << std::setfill('.')
+        << name << FG_RED << "FAIL" << RESET
+        << " (ZEBRA_TEST_SEED=" << test_base_seed() << ")" << '\n'
+        << '\n';
 
     for ( const auto& details : result.cases() ) {
-      std::cout << details;
+      out << details;
     }
   }
 }
@@ -88,11 +307,95 @@ inline void run_test(const std::string_view name,
 inline void test_section(const std::string_view section_name,
                          const std::function<void()>& section_func)
 {
-  std::cout << HEADER_COLOR << section_name << ':' << RESET << '\n';
+  std::ostream& out {*test_output()};
+  out << HEADER_COLOR << section_name << ':' << RESET << '\n';
   section_func();
-  std::cout << '\n' << '\n';
+  out << '\n' << '\n';
 }
 
+/* {{{ doc */
+/**
+ * @brief Collection of test sections, run concurrently.
+ *
+ * Sections added to the same chain run one after another, in the order
+ * they were added; this is for sections which share state, such as a
+ * global counter. Separate chains run concurrently. Output is buffered
+ * per section and printed in the order sections were added.
+ */
+/* }}} */
+class test_suite
+{
+private:
+
+  struct section {
+    std::string name;
+    std::function<void()> func;
+    std::string chain;
+  };
+
+  std::vector<section> m_sections {};
+
+public:
+
+  /* {{{ doc */
+  /**
+   * @param name Name of section.
+   *
+   * @param func Function running the section's tests.
+   *
+   * @param chain Name of the chain to run in. Defaults to the name of
+   * the section, so that it runs independently of all others.
+   */
+  /* }}} */
+  inline void add_section(const std::string_view name,
+                          std::function<void()> func,
+                          const std::string_view chain = "")
+  {
+    m_sections.push_back({std::string {name}, std::move(func),
+                          std::string {chain.empty() ? name : chain}});
+  }
+
+  /* {{{ doc */
+  /**
+   * @brief Runs every section and prints results.
+   *
+   * @return True if every test passed.
+   */
+  /* }}} */
+  inline auto run() -> bool
+  {
+    std::cout << "Test seed: " << test_base_seed() << "\n\n";
+
+    std::vector<std::stringstream> outputs(m_sections.size());
+
+    std::map<std::string, std::vector<std::size_t>> chains;
+    for ( std::size_t i {0}; i != m_sections.size(); ++i ) {
+      chains[m_sections[i].chain].push_back(i);
+    }
+
+    std::vector<std::future<void>> running;
+    running.reserve(chains.size());
+    for ( const auto& [chain, indices] : chains ) {
+      running.push_back(std::async(std::launch::async, [&, indices]() {
+        for ( const std::size_t i : indices ) {
+          test_output() = &outputs[i];
+          test_section(m_sections[i].name, m_sections[i].func);
+        }
+      }));
+    }
+
+    for ( auto& chain : running ) {
+      chain.get();
+    }
+
+    for ( const auto& output : outputs ) {
+      std::cout << output.str();
+    }
+
+    return test_failures() == 0;
+  }
+};
+
 } // namespace ehanc
 
 #endif
@@ -1,20 +1,69 @@
+#include "random.hpp"
 #include "test_utils.hpp"
 
+#include "test_algorithm.h"
+#include "test_arrival_generator.h"
+#include "test_arrival_log.h"
+#include "test_checkpoint.h"
+#include "test_compressed_file_buf.h"
+#include "test_log_index.h"
+#include "test_lockstep.h"
+#include "test_lz4.h"
+#include "test_mapped_file_buf.h"
+#include "test_metrics.h"
+#include "test_part_set.h"
 #include "test_random.h"
 #include "test_repair_bay.h"
 #include "test_ship.h"
+#include "test_ship_id_allocator.h"
+#include "test_ship_queue.h"
+#include "test_ship_store.h"
 #include "test_space_station.h"
 
 auto main() -> int
 {
+  ehanc::test_seeder() = &seed_random_engine;
 
-  ehanc::test_section("Random", &test_random);
+  ehanc::test_suite suite;
 
-  ehanc::test_section("Ship", &test_ship);
+  suite.add_section("Algorithm", &test_algorithm);
 
-  ehanc::test_section("Repair Bay", &test_repair_bay);
+  suite.add_section("Random", &test_random);
 
-  ehanc::test_section("Space Station", &test_space_station);
+  suite.add_section("Part Set", &test_part_set);
 
-  return 0;
+  suite.add_section("Mapped File Buffer", &test_mapped_file_buf);
+
+  suite.add_section("LZ4", &test_lz4);
+
+  suite.add_section("Compressed File Buffer", &test_compressed_file_buf);
+
+  suite.add_section("Log Index", &test_log_index);
+
+  suite.add_section("Ship ID Allocator", &test_ship_id_allocator);
+
+  // These all construct ships which take their IDs from the global
+  // allocator, and "Ship" expects to construct the very first one
+  suite.add_section("Ship", &test_ship, "ships");
+
+  suite.add_section("Repair Bay", &test_repair_bay, "ships");
+
+  suite.add_section("Ship Store", &test_ship_store, "ships");
+
+  suite.add_section("Ship Queue", &test_ship_queue, "ships");
+
+  suite.add_section("Space Station", &test_space_station, "ships");
+
+  // These number their ships with allocators of their own
+  suite.add_section("Arrival Generator", &test_arrival_generator);
+
+  suite.add_section("Metrics", &test_metrics);
+
+  suite.add_section("Arrival Log", &test_arrival_log);
+
+  suite.add_section("Lockstep", &test_lockstep);
+
+  suite.add_section("Checkpoint", &test_checkpoint);
+
+  return suite.run() ? 0 : 1;
 }
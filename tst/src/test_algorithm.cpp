@@ -0,0 +1,330 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <list>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "utils/execution.hpp"
+#include "utils/memory.hpp"
+#include "utils/simd.hpp"
+#include "utils/thread_pool.hpp"
+
+#include "test_algorithm.h"
+#include "test_utils.hpp"
+
+// Long enough to be split into many chunks on any pool
+constexpr inline std::size_t range_size {10'000};
+
+static auto test_sequential() -> ehanc::test
+{
+  ehanc::test results;
+
+  const std::vector<int> first {1, 2, 3};
+  const std::vector<int> second {4, 5, 6, 7};
+
+  std::vector<int> seen;
+  ehanc::for_each_adjacent(first.cbegin(), first.cend(),
+                           [&](const int lead, const int follow) {
+                             seen.push_back((lead * 10) + follow);
+                           });
+  results.add_case(seen, std::vector<int> {21, 32},
+                   "for_each_adjacent wrong pairs");
+
+  seen.clear();
+  ehanc::for_each_adjacent_n(first.cbegin(), first.cend(), 1,
+                             [&](const int lead, const int follow) {
+                               seen.push_back((lead * 10) + follow);
+                             });
+  results.add_case(seen, std::vector<int> {21},
+                   "for_each_adjacent_n ignores n");
+
+  seen.clear();
+  ehanc::for_each_both(first.cbegin(), first.cend(), second.cbegin(),
+                       second.cend(), [&](const int lhs, const int rhs) {
+                         seen.push_back(lhs * rhs);
+                       });
+  results.add_case(seen, std::vector<int> {4, 10, 18},
+                   "for_each_both wrong pairs");
+
+  seen.clear();
+  ehanc::for_each_both_n(first.cbegin(), first.cend(), second.cbegin(),
+                         second.cend(), 2,
+                         [&](const int lhs, const int rhs) {
+                           seen.push_back(lhs * rhs);
+                         });
+  results.add_case(seen, std::vector<int> {4, 10},
+                   "for_each_both_n ignores n");
+
+  seen.clear();
+  std::vector<int> out(3);
+  ehanc::for_each_all(
+      [&](const int lhs, const int rhs, int& sum) { sum = lhs + rhs; },
+      first, second, out);
+  results.add_case(out, std::vector<int> {5, 7, 9},
+                   "for_each_all wrong sums");
+
+  int total {0};
+  ehanc::for_each_all_c([&](const int lhs,
+                            const int rhs) { total += lhs - rhs; },
+                        first, second);
+  results.add_case(total, -9, "for_each_all_c wrong total");
+
+  int next {0};
+  ehanc::generate(out.begin(), out.end(), [&]() { return next++; });
+  results.add_case(out, std::vector<int> {0, 1, 2},
+                   "generate out of order");
+
+  // A policy of seq is the overload without one
+  seen.clear();
+  ehanc::for_each_adjacent(ehanc::execution::seq, first.cbegin(),
+                           first.cend(),
+                           [&](const int lead, const int follow) {
+                             seen.push_back((lead * 10) + follow);
+                           });
+  results.add_case(seen, std::vector<int> {21, 32},
+                   "seq for_each_adjacent wrong pairs");
+
+  const auto add {
+      [](const int lhs, const int rhs, int& sum) { sum = lhs + rhs; }};
+  out.assign(3, 0);
+  ehanc::for_each_all(ehanc::execution::seq, add, first, second, out);
+  results.add_case(out, std::vector<int> {5, 7, 9},
+                   "seq for_each_all wrong sums");
+
+  next = 0;
+  ehanc::generate(ehanc::execution::seq, out.begin(), out.end(),
+                  [&]() { return next++; });
+  results.add_case(out, std::vector<int> {0, 1, 2},
+                   "seq generate out of order");
+
+  return results;
+}
+
+static auto test_parallel() -> ehanc::test
+{
+  ehanc::test results;
+
+  ehanc::thread_pool pool(4);
+  const ehanc::execution::parallel_policy policy {
+      ehanc::execution::par.on(pool)};
+
+  std::vector<long> values(range_size);
+  std::iota(values.begin(), values.end(), 0L);
+
+  // Every element is visited exactly once, wherever the chunks fall
+  std::vector<long> doubled(range_size);
+  ehanc::for_each_all(
+      policy, [](const long value, long& out) { out = value * 2; },
+      values, doubled);
+  std::vector<long> expected(range_size);
+  ehanc::for_each_all(
+      [](const long value, long& out) { out = value * 2; }, values,
+      expected);
+  results.add_case(doubled, expected, "for_each_all differs from seq");
+
+  std::atomic<long> sum {0};
+  ehanc::for_each_all_c(ehanc::execution::par,
+                        [&](const long value) { sum += value; }, values);
+  results.add_case(sum.load(),
+                   static_cast<long>(range_size * (range_size - 1) / 2),
+                   "for_each_all_c on the shared pool missed elements");
+
+  std::atomic<std::size_t> pairs {0};
+  std::atomic<bool> adjacent {true};
+  ehanc::for_each_adjacent(policy, values.cbegin(), values.cend(),
+                           [&](const long lead, const long follow) {
+                             ++pairs;
+                             if ( lead != follow + 1 ) {
+                               adjacent = false;
+                             }
+                           });
+  results.add_case(pairs.load(), range_size - 1,
+                   "for_each_adjacent wrong pair count");
+  results.add_case(adjacent.load(), true,
+                   "for_each_adjacent split a pair");
+
+  pairs = 0;
+  ehanc::for_each_adjacent_n(policy, values.cbegin(), values.cend(), 100,
+                             [&](long, long) { ++pairs; });
+  results.add_case(pairs.load(), std::size_t {100},
+                   "for_each_adjacent_n ignores n");
+
+  pairs = 0;
+  ehanc::for_each_adjacent(policy, values.cend(), values.cend(),
+                           [&](long, long) { ++pairs; });
+  results.add_case(pairs.load(), std::size_t {0},
+                   "for_each_adjacent on an empty range");
+
+  std::vector<long> products(range_size);
+  ehanc::for_each_both_n(
+      policy, values.cbegin(), values.cend(), products.begin(),
+      products.end(), range_size / 2,
+      [](const long value, long& out) { out = value * value; });
+  results.add_case(products[(range_size / 2) - 1],
+                   static_cast<long>(((range_size / 2) - 1)
+                                     * ((range_size / 2) - 1)),
+                   "for_each_both_n missed an element");
+  results.add_case(products[range_size / 2], 0L,
+                   "for_each_both_n ignores n");
+
+  std::vector<long> filled(range_size);
+  ehanc::generate(policy, filled.begin(), filled.end(),
+                  []() { return 7L; });
+  results.add_case(std::count(filled.cbegin(), filled.cend(), 7L),
+                   static_cast<std::ptrdiff_t>(range_size),
+                   "generate missed elements");
+
+  // Ranges without random access fall back to running in order
+  const std::list<int> listed {1, 2, 3};
+  std::vector<int> seen;
+  ehanc::for_each_both(policy, listed.cbegin(), listed.cend(),
+                       listed.cbegin(), listed.cend(),
+                       [&](const int lhs, const int rhs) {
+                         seen.push_back(lhs * rhs);
+                       });
+  results.add_case(seen, std::vector<int> {1, 4, 9},
+                   "for_each_both on a list out of order");
+
+  // Threads sharing a pool take turns, rather than mixing up rounds
+  std::atomic<int> bad_rounds {0};
+  std::vector<std::thread> callers;
+  for ( int i {0}; i != 4; ++i ) {
+    callers.emplace_back([&]() {
+      for ( int round {0}; round != 50; ++round ) {
+        std::atomic<long> round_sum {0};
+        ehanc::for_each_all_c(
+            policy, [&](const long value) { round_sum += value; },
+            values);
+        if ( round_sum.load()
+             != static_cast<long>(range_size * (range_size - 1) / 2) ) {
+          ++bad_rounds;
+        }
+      }
+    });
+  }
+  for ( std::thread& caller : callers ) {
+    caller.join();
+  }
+  results.add_case(bad_rounds.load(), 0,
+                   "Concurrent callers corrupted each other's rounds");
+
+  return results;
+}
+
+// Searches every prefix of a range of distinct values, longer than a few
+// vector widths, for values in it, and for one which is not, at every
+// position the vector kernel or its scalar tail could find it
+template <typename T>
+static void check_contains(ehanc::test& results, const std::string& name)
+{
+  constexpr std::size_t length {(ehanc::simd_width * 3) + 7};
+
+  std::vector<T> values(length);
+  for ( std::size_t i {0}; i != length; ++i ) {
+    values[i] = static_cast<T>(i + 1);
+  }
+  // Differs from a value in the range only in its high bits
+  const T missing {static_cast<T>(std::numeric_limits<T>::max() - 1)};
+
+  bool found_all {true};
+  bool found_missing {false};
+  for ( std::size_t size {0}; size <= length; ++size ) {
+    const auto end {std::next(values.cbegin(), static_cast<long>(size))};
+    for ( std::size_t i {0}; i != size; ++i ) {
+      found_all = found_all
+                  && ehanc::contains(values.cbegin(), end, values[i]);
+    }
+    found_missing = found_missing
+                    || ehanc::contains(values.cbegin(), end, missing)
+                    || (size != length
+                        && ehanc::contains(values.cbegin(), end,
+                                           values[size]));
+  }
+
+  results.add_case(found_all, true, "Missed a value - " + name);
+  results.add_case(found_missing, false,
+                   "Found a missing value - " + name);
+}
+
+static auto test_contains() -> ehanc::test
+{
+  ehanc::test results;
+
+  check_contains<std::int8_t>(results, "int8");
+  check_contains<std::uint8_t>(results, "uint8");
+  check_contains<std::int16_t>(results, "int16");
+  check_contains<std::uint32_t>(results, "uint32");
+  check_contains<int>(results, "int");
+  check_contains<std::int64_t>(results, "int64");
+  check_contains<std::uint64_t>(results, "uint64");
+  check_contains<float>(results, "float");
+  check_contains<double>(results, "double");
+
+  // Compared as with ==, not bit for bit
+  const std::vector<double> zeros(9, -0.0);
+  results.add_case(ehanc::contains(zeros.cbegin(), zeros.cend(), 0.0),
+                   true, "Missed 0.0 matching -0.0");
+  const std::vector<double> nans(9,
+                                 std::numeric_limits<double>::quiet_NaN());
+  results.add_case(ehanc::contains(nans.cbegin(), nans.cend(), nans[0]),
+                   false, "NaN matched NaN");
+
+  // Iterators without contiguous storage take the generic path
+  const std::deque<int> queued {3, 1, 4, 1, 5};
+  results.add_case(ehanc::contains(queued.cbegin(), queued.cend(), 5),
+                   true, "Missed a value in a deque");
+  const std::vector<bool> flags {false, false};
+  results.add_case(ehanc::contains(flags.cbegin(), flags.cend(), true),
+                   false, "Found a missing value in a vector<bool>");
+
+  static_assert(ehanc::is_contiguous_v<std::vector<int>::iterator>);
+  static_assert(ehanc::is_contiguous_v<const double*>);
+  static_assert(not ehanc::is_contiguous_v<std::deque<int>::iterator>);
+  static_assert(
+      not ehanc::is_contiguous_v<std::vector<bool>::const_iterator>);
+
+  return results;
+}
+
+static auto test_parse_byte_size() -> ehanc::test
+{
+  ehanc::test results;
+
+  // optional cannot be printed, so invalid sizes are shown as this
+  constexpr std::uint64_t invalid {
+      std::numeric_limits<std::uint64_t>::max()};
+  const auto parse {[&](const std::string_view text) {
+    return ehanc::parse_byte_size(text).value_or(invalid);
+  }};
+
+  results.add_case(parse("0"), std::uint64_t {0});
+  results.add_case(parse("1234"), std::uint64_t {1234});
+  results.add_case(parse("64k"), std::uint64_t {64} << 10U);
+  results.add_case(parse("512M"), std::uint64_t {512} << 20U);
+  results.add_case(parse("2GiB"), std::uint64_t {2} << 30U);
+  results.add_case(parse("3tb"), std::uint64_t {3} << 40U);
+  results.add_case(parse("100B"), std::uint64_t {100});
+
+  for ( const std::string_view text :
+        {"", "M", "-1", "12X", "1.5G", "4 G", "8MiBs",
+         "18446744073709551616", "16777216T"} ) {
+    results.add_case(parse(text), invalid,
+                     "Accepted " + std::string {text});
+  }
+
+  return results;
+}
+
+void test_algorithm()
+{
+  ehanc::run_test("ehanc::contains", &test_contains);
+  ehanc::run_test("ehanc algorithms in sequence", &test_sequential);
+  ehanc::run_test("ehanc algorithms in parallel", &test_parallel);
+  ehanc::run_test("ehanc::parse_byte_size", &test_parse_byte_size);
+}
@@ -0,0 +1,95 @@
+#include <cmath>
+#include <cstddef>
+#include <string>
+
+#include "test_arrival_generator.h"
+#include "test_utils.hpp"
+
+#include "constants.h"
+
+static auto test_generate() -> ehanc::test
+{
+  ehanc::test results;
+
+  const std::size_t lookahead {16};
+  const std::size_t num_steps {100'000};
+
+  // Poisson with mean 1.2 over 100'000 steps, well within 0.02
+  const double mean_fudge_factor {0.02};
+
+  arrival_generator test(lookahead);
+
+  results.add_case(test.buffered_steps(), std::size_t {0},
+                   "Buffered arrivals before first use");
+
+  test.generate(num_steps);
+
+  results.add_case(test.buffered_steps(), num_steps,
+                   "Wrong number of buffered steps after generate");
+
+  std::size_t total_arrivals {0};
+  ship::id_type last_id {conf::starting_ship_id - 1};
+  bool ids_dense {true};
+  bool all_damaged {true};
+
+  for ( std::size_t i {0}; i != num_steps; ++i ) {
+    const arrival_generator::arrivals step_arrivals {test.next_step()};
+    total_arrivals += step_arrivals.size();
+
+    for ( const ship& arrival : step_arrivals ) {
+      ids_dense      = ids_dense && arrival.get_id() == last_id + 1;
+      all_damaged    = all_damaged && arrival.is_damaged();
+      last_id        = arrival.get_id();
+    }
+  }
+
+  // The generator numbers its own ships, from the first ID up
+  results.add_case(ids_dense, true,
+                   "Ship IDs not consecutive in arrival order");
+  results.add_case(all_damaged, true, "Generated an undamaged ship");
+  results.add_case(test.buffered_steps(), std::size_t {0},
+                   "Buffered steps remaining after consuming all");
+
+  const double mean_arrivals {static_cast<double>(total_arrivals)
+                              / static_cast<double>(num_steps)};
+  const double mean_diff {
+      std::abs(mean_arrivals - conf::new_ship_count_poisson_mean)};
+
+  results.add_case(mean_diff < mean_fudge_factor, true,
+                   "Mean arrivals per step off by "
+                       + std::to_string(mean_diff));
+
+  return results;
+}
+
+static auto test_next_step() -> ehanc::test
+{
+  ehanc::test results;
+
+  const std::size_t lookahead {4};
+
+  arrival_generator test(lookahead);
+
+  // First request refills by exactly the lookahead
+  static_cast<void>(test.next_step());
+  results.add_case(test.buffered_steps(), lookahead - 1,
+                   "Did not refill by lookahead");
+
+  for ( std::size_t i {0}; i != lookahead - 1; ++i ) {
+    static_cast<void>(test.next_step());
+  }
+  results.add_case(test.buffered_steps(), std::size_t {0},
+                   "Wrong buffered steps after draining");
+
+  static_cast<void>(test.next_step());
+  results.add_case(test.buffered_steps(), lookahead - 1,
+                   "Did not refill once drained");
+
+  return results;
+}
+
+void test_arrival_generator()
+{
+  ehanc::run_test("arrival_generator::generate", &test_generate);
+  ehanc::run_test("arrival_generator::next_step", &test_next_step);
+}
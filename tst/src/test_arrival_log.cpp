@@ -0,0 +1,134 @@
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "test_arrival_log.h"
+#include "test_utils.hpp"
+
+// Everything recorded about the arrivals of one hour
+static auto describe(const arrival_generator::arrivals& ships)
+    -> std::string
+{
+  std::string retval;
+
+  for ( const ship& arrival : ships ) {
+    retval += std::to_string(static_cast<int>(arrival.get_faction()));
+    for ( const part_set::part part : arrival.get_damaged_parts_list() ) {
+      retval += ' ' + std::to_string(part.id) + '='
+                + std::to_string(part.damage);
+    }
+    retval += ';';
+  }
+
+  return retval;
+}
+
+// Records `hours` hours of generated arrivals to `path`, returning the
+// description of each hour's arrivals
+static auto record_hours(const std::string& path, const std::size_t hours)
+    -> std::vector<std::string>
+{
+  arrival_log::writer writer(path);
+  arrival_generator generator;
+  std::vector<std::string> recorded;
+
+  for ( std::uint64_t hour {1}; hour <= hours; ++hour ) {
+    const arrival_generator::arrivals ships {generator.next_step()};
+    writer.record(hour, ships);
+    recorded.push_back(describe(ships));
+  }
+
+  writer.close();
+
+  return recorded;
+}
+
+static auto test_replay() -> ehanc::test
+{
+  ehanc::test results;
+
+  const std::string path {(std::filesystem::temp_directory_path()
+                           / "zebra_test_arrival_log.bin")
+                              .string()};
+
+  const std::size_t hours {500};
+  const std::vector<std::string> recorded {record_hours(path, hours)};
+
+  // Tiny chunks, so records are split across many reads
+  arrival_log::reader reader(path, 16);
+  results.add_case(reader.is_open(), true, "Failed to open");
+
+  for ( std::uint64_t hour {1}; hour <= hours; ++hour ) {
+    const auto replayed {reader.arrivals_for(hour)};
+
+    if ( not replayed.has_value() ) {
+      results.add_case(false, true,
+                       "Replay ended at hour " + std::to_string(hour));
+      break;
+    }
+
+    results.add_case(describe(*replayed), recorded[hour - 1],
+                     "Replay differs at hour " + std::to_string(hour));
+  }
+
+  results.add_case(reader.arrivals_for(hours + 1).has_value(), false,
+                   "Replay went on past the last hour");
+  results.add_case(reader.failed(), false, "Replay failed");
+
+  // Hours may be skipped
+  arrival_log::reader skipping(path);
+  const auto skipped_to {skipping.arrivals_for(hours / 2)};
+  results.add_case(skipped_to.has_value()
+                       && describe(*skipped_to) == recorded[hours / 2 - 1],
+                   true, "Wrong arrivals after skipping hours");
+
+  std::filesystem::remove(path);
+
+  return results;
+}
+
+static auto test_bad_logs() -> ehanc::test
+{
+  ehanc::test results;
+
+  const std::string path {(std::filesystem::temp_directory_path()
+                           / "zebra_test_arrival_log_bad.bin")
+                              .string()};
+
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << "Not an arrival log";
+  }
+
+  const arrival_log::reader wrong_magic(path);
+  results.add_case(wrong_magic.is_open(), false,
+                   "Opened something other than an arrival log");
+
+  // Cut off in the middle of the last record
+  const std::size_t hours {50};
+  record_hours(path, hours);
+  std::filesystem::resize_file(path,
+                               std::filesystem::file_size(path) - 1);
+
+  arrival_log::reader truncated(path);
+  std::uint64_t hour {1};
+  while ( truncated.arrivals_for(hour).has_value() ) {
+    ++hour;
+  }
+
+  results.add_case(truncated.failed(), true,
+                   "Truncated log not reported");
+
+  std::filesystem::remove(path);
+
+  return results;
+}
+
+void test_arrival_log()
+{
+  ehanc::run_test("arrival_log replay", &test_replay);
+  ehanc::run_test("arrival_log bad logs", &test_bad_logs);
+}
@@ -0,0 +1,212 @@
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "random.hpp"
+
+#include "test_checkpoint.h"
+#include "test_utils.hpp"
+
+static auto checkpoint_path(const std::string& name) -> std::string
+{
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+static auto report(const space_station& station) -> std::string
+{
+  std::ostringstream out;
+  station.display(out);
+  return out.str();
+}
+
+// Runs a station for `hours`, checkpointing every `every` hours
+static void run_checkpointed(space_station& station,
+                             checkpoint::writer& writer,
+                             const std::size_t hours,
+                             const std::size_t every)
+{
+  for ( std::size_t hour {1}; hour <= hours; ++hour ) {
+    station.step();
+    if ( hour % every == 0 ) {
+      writer.save(station);
+    }
+  }
+}
+
+// Checkpoints a station with several bases and deltas, restores it into
+// another, and runs both on from there
+static void check_resume(ehanc::test& results,
+                         const std::vector<bay_spec>& bays,
+                         const ship_queue::policy order,
+                         const bool predict)
+{
+  const std::string path {checkpoint_path("zebra_test_checkpoint.bin")};
+
+  seed_random_engine(4242);
+  space_station original("Zebra", bays, order);
+  original.check_predictions(predict);
+  {
+    checkpoint::writer writer(path, 3);
+    run_checkpointed(original, writer, 230, 10);
+  }
+
+  space_station restored("Zebra", bays, order);
+  restored.check_predictions(predict);
+  const std::optional<std::uint64_t> hour {
+      checkpoint::restore(path, restored)};
+
+  results.add_case(hour == std::uint64_t {230}, true,
+                   "Restored the wrong hour");
+  results.add_case(restored.queue_size(), original.queue_size(),
+                   "Restored queue has the wrong size");
+  results.add_case(restored.queue_repair_hours(),
+                   original.queue_repair_hours(),
+                   "Restored queue has the wrong repair hours");
+  results.add_case(restored.occupied_bay_count(),
+                   original.occupied_bay_count(),
+                   "Restored the wrong bays");
+  results.add_case(restored.total_bay_time_remaining(),
+                   original.total_bay_time_remaining(),
+                   "Restored bays have the wrong time remaining");
+
+  // Both draw from this thread's engine, from where the checkpoint was
+  const conf::random_engine engine {random_engine()};
+  for ( int i {0}; i != 150; ++i ) {
+    original.step();
+  }
+  random_engine() = engine;
+  for ( int i {0}; i != 150; ++i ) {
+    restored.step();
+  }
+
+  results.add_case(report(restored), report(original),
+                   "Restored station ran differently");
+  results.add_case(restored.prediction_accuracy().total_abs_error,
+                   original.prediction_accuracy().total_abs_error,
+                   "Restored station predicted differently");
+  results.add_case(restored.prediction_accuracy().ships,
+                   original.prediction_accuracy().ships,
+                   "Restored station checked different predictions");
+
+  std::filesystem::remove(path);
+}
+
+static auto test_resume() -> ehanc::test
+{
+  ehanc::test results;
+
+  check_resume(results, std::vector<bay_spec>(3),
+               ship_queue::policy::fifo, false);
+
+  std::vector<bay_spec> mixed(3);
+  mixed[1].speed = 2.0;
+  mixed[1].factions = ship::faction_bit(ship::faction::klingon)
+                      | ship::faction_bit(ship::faction::romulan);
+  mixed[2].speed = 0.5;
+  for ( bay_spec& spec : mixed ) {
+    spec.track_parts = true;
+  }
+  check_resume(results, mixed, ship_queue::policy::aging, true);
+
+  check_resume(results, std::vector<bay_spec>(2),
+               ship_queue::policy::shortest_first, true);
+
+  return results;
+}
+
+static auto test_incremental() -> ehanc::test
+{
+  ehanc::test results;
+
+  const std::string path {
+      checkpoint_path("zebra_test_checkpoint_delta.bin")};
+
+  // One bay, so the queue grows long
+  seed_random_engine(7);
+  space_station station("Zebra", 1);
+  checkpoint::writer writer(path, 8);
+
+  for ( int i {0}; i != 1000; ++i ) {
+    station.step();
+  }
+  writer.save(station);
+  const std::uintmax_t base_size {std::filesystem::file_size(path)};
+
+  station.step();
+  writer.save(station);
+  const std::uintmax_t delta_size {std::filesystem::file_size(path)
+                                   - base_size};
+
+  results.add_case(station.queue_size() > 500, true,
+                   "Queue did not grow");
+  results.add_case(delta_size * 4 < base_size, true,
+                   "Incremental checkpoint not much smaller than full");
+
+  writer.close();
+  std::filesystem::remove(path);
+
+  return results;
+}
+
+static auto test_bad_checkpoints() -> ehanc::test
+{
+  ehanc::test results;
+
+  const std::string path {
+      checkpoint_path("zebra_test_checkpoint_bad.bin")};
+
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << "Not a checkpoint";
+  }
+
+  space_station wrong_magic("Zebra", 2);
+  results.add_case(checkpoint::restore(path, wrong_magic).has_value(),
+                   false, "Restored something other than a checkpoint");
+
+  // A base at hour 10 and deltas at 20 and 30, the last one cut off
+  {
+    space_station station("Zebra", 2);
+    checkpoint::writer writer(path);
+    run_checkpointed(station, writer, 30, 10);
+  }
+  std::filesystem::resize_file(path,
+                               std::filesystem::file_size(path) - 1);
+
+  space_station truncated("Zebra", 2);
+  results.add_case(checkpoint::restore(path, truncated)
+                       == std::uint64_t {20},
+                   true, "Cut off checkpoint not skipped");
+  results.add_case(truncated.step_count(), std::size_t {20},
+                   "Cut off checkpoint restored the wrong hour");
+
+  space_station other_bays("Zebra", 3);
+  results.add_case(checkpoint::restore(path, other_bays).has_value(),
+                   false, "Restored into a station with other bays");
+  results.add_case(other_bays.step_count(), std::size_t {0},
+                   "Station changed by a failed restore");
+
+  space_station other_policy("Zebra", 2, ship_queue::policy::aging);
+  results.add_case(checkpoint::restore(path, other_policy).has_value(),
+                   false, "Restored into a station with another policy");
+
+  results.add_case(
+      checkpoint::restore(path + ".missing", other_policy).has_value(),
+      false, "Restored a missing checkpoint");
+
+  std::filesystem::remove(path);
+
+  return results;
+}
+
+void test_checkpoint()
+{
+  ehanc::run_test("checkpoint resume", &test_resume);
+  ehanc::run_test("checkpoint incremental", &test_incremental);
+  ehanc::run_test("checkpoint bad checkpoints", &test_bad_checkpoints);
+}
@@ -0,0 +1,87 @@
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+#include "lz4.h"
+
+#include "test_compressed_file_buf.h"
+#include "test_utils.hpp"
+
+static auto test_write() -> ehanc::test
+{
+  ehanc::test results;
+
+  const std::filesystem::path path {
+      std::filesystem::temp_directory_path()
+      / "zebra_test_compressed_file_buf.txt.lz4"};
+
+  // Small blocks and a short queue, so that writing hands off many
+  // blocks and has to wait on the compressing thread
+  const std::size_t block_size {1000};
+  const std::size_t queue_depth {1};
+  const std::size_t line_count {20'000};
+
+  std::stringstream expected;
+
+  {
+    compressed_file_buf buf(path.string(), block_size, queue_depth);
+    results.add_case(buf.is_open(), true, "Failed to open");
+
+    std::ostream out(&buf);
+
+    for ( std::size_t i {0}; i != line_count; ++i ) {
+      if ( i == line_count / 2 ) {
+        results.add_case(static_cast<std::size_t>(out.tellp()),
+                         expected.str().size(), "tellp() is wrong");
+        out << std::flush;
+      }
+      out << "Line " << i << " of the report\n";
+      expected << "Line " << i << " of the report\n";
+    }
+
+    out << std::flush;
+    results.add_case(buf.size(),
+                     static_cast<std::uint64_t>(expected.str().size()),
+                     "Wrong size before close");
+    results.add_case(buf.close(), true, "Failed to close");
+    results.add_case(buf.is_open(), false, "Open after close");
+  }
+
+  results.add_case(std::filesystem::file_size(path)
+                       < expected.str().size() / 2,
+                   true, "File is not compressed");
+
+  std::ifstream in(path, std::ios::binary);
+  std::stringstream contents;
+
+  results.add_case(lz4::decompress_frames(in, contents), true,
+                   "File is not a valid LZ4 frame");
+  results.add_case(contents.str() == expected.str(), true,
+                   "File contents differ from what was written");
+
+  std::filesystem::remove(path);
+
+  return results;
+}
+
+static auto test_bad_path() -> ehanc::test
+{
+  ehanc::test results;
+
+  compressed_file_buf buf("/nonexistent_directory/zebra.txt.lz4");
+
+  results.add_case(buf.is_open(), false, "Opened a nonexistent path");
+  results.add_case(buf.close(), false, "Closed a file never opened");
+
+  return results;
+}
+
+void test_compressed_file_buf()
+{
+  ehanc::run_test("compressed_file_buf write", &test_write);
+  ehanc::run_test("compressed_file_buf bad path", &test_bad_path);
+}
@@ -0,0 +1,83 @@
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "utils/thread_pool.hpp"
+
+#include "test_lockstep.h"
+#include "test_utils.hpp"
+
+static auto test_thread_pool() -> ehanc::test
+{
+  ehanc::test results;
+
+  ehanc::thread_pool pool(4);
+  results.add_case(pool.size(), std::size_t {4}, "Wrong thread count");
+
+  // Many short rounds, as lockstep uses it
+  for ( std::size_t round {0}; round != 200; ++round ) {
+    const std::size_t count {round % 13};
+    std::vector<std::atomic<int>> calls(count);
+
+    pool.run(count, [&calls](const std::size_t index) { ++calls[index]; });
+
+    bool once {true};
+    for ( const auto& call : calls ) {
+      once = once && call == 1;
+    }
+    results.add_case(once, true, "Index not handled exactly once");
+  }
+
+  return results;
+}
+
+static auto test_shared_arrivals() -> ehanc::test
+{
+  ehanc::test results;
+
+  // Steps not a multiple of the batch size, and more stations than
+  // threads
+  lockstep stations({{std::vector<bay_spec>(3)},
+                     {std::vector<bay_spec>(3)},
+                     {std::vector<bay_spec>(5)}},
+                    16, 2);
+  stations.run(1000);
+  stations.run(5);
+
+  results.add_case(stations.size(), std::size_t {3},
+                   "Wrong station count");
+
+  for ( std::size_t i {0}; i != stations.size(); ++i ) {
+    results.add_case(stations.station(i).step_count(), std::size_t {1005},
+                     "Wrong step count");
+    results.add_case(stations.get_totals(i).arrived,
+                     stations.get_totals(0).arrived,
+                     "Stations saw different arrivals");
+  }
+
+  // Identical stations fed identical arrivals end up identical
+  const lockstep::totals& first {stations.get_totals(0)};
+  const lockstep::totals& second {stations.get_totals(1)};
+  results.add_case(first.repaired, second.repaired,
+                   "Identical stations repaired different numbers");
+  results.add_case(first.queue_hours, second.queue_hours,
+                   "Identical stations queued differently");
+  results.add_case(stations.station(0).queue_size(),
+                   stations.station(1).queue_size(),
+                   "Identical stations have different queues");
+
+  // Extra bays can only help
+  results.add_case(stations.get_totals(2).repaired >= first.repaired, true,
+                   "More bays repaired fewer ships");
+  results.add_case(stations.get_totals(2).queue_hours <= first.queue_hours,
+                   true, "More bays queued more ships");
+
+  return results;
+}
+
+void test_lockstep()
+{
+  ehanc::run_test("ehanc::thread_pool", &test_thread_pool);
+  ehanc::run_test("lockstep shared arrivals", &test_shared_arrivals);
+}
@@ -0,0 +1,187 @@
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+#include "compressed_file_buf.h"
+#include "lz4.h"
+#include "mapped_file_buf.h"
+
+#include "test_log_index.h"
+#include "test_utils.hpp"
+
+// Stands in for an hourly report, with a different length every hour
+static auto make_report(const std::uint64_t hour) -> std::string
+{
+  return "Report for hour " + std::to_string(hour) + '\n'
+         + std::string(hour % 13, '.') + '\n';
+}
+
+static auto test_writer_reader() -> ehanc::test
+{
+  ehanc::test results;
+
+  const std::filesystem::path path {
+      std::filesystem::temp_directory_path() / "zebra_test_log_index.idx"};
+
+  const std::uint64_t step_count {1000};
+  const std::size_t flush_interval {7};
+
+  {
+    log_index::writer writer(path.string(), flush_interval);
+    results.add_case(writer.is_open(), true, "Failed to open");
+
+    for ( std::uint64_t step {1}; step <= step_count; ++step ) {
+      writer.add(step, step * 100);
+    }
+
+    // Everything but the records since the last flush must already be
+    // in the file, in case the run never gets to close it
+    const log_index::reader partial(path.string());
+    results.add_case(partial.size(),
+                     step_count - (step_count % flush_interval),
+                     "Records not written incrementally");
+
+    results.add_case(writer.close(), true, "Failed to close");
+  }
+
+  const log_index::reader reader(path.string());
+  results.add_case(reader.is_open(), true, "Failed to open for reading");
+  results.add_case(reader.size(), step_count, "Wrong number of records");
+
+  const auto middle {reader.find(500)};
+  results.add_case(middle.has_value() && middle->step == 500
+                       && middle->offset == 50'000,
+                   true, "Did not find step 500");
+
+  const auto before {reader.find(0)};
+  results.add_case(before.has_value() && before->step == 1, true,
+                   "Did not find the first step");
+
+  results.add_case(reader.find(step_count + 1).has_value(), false,
+                   "Found a step after the last one");
+
+  // A crash in the middle of writing leaves part of a record
+  std::filesystem::resize_file(path,
+                               std::filesystem::file_size(path) - 5);
+
+  const log_index::reader truncated(path.string());
+  results.add_case(truncated.size(), step_count - 1,
+                   "Partial record not ignored");
+
+  std::filesystem::remove(path);
+
+  return results;
+}
+
+// Writes reports of hours 1 through hours to the log at `path` through
+// `buf`, and indexes them, returning everything written
+static auto write_log(log_buf& buf, const std::string& path,
+                      const std::uint64_t hours) -> std::string
+{
+  log_index::writer index(log_index::index_path(path),
+                          conf::log_index_flush_interval, &buf);
+  std::ostream out(&buf);
+  std::string written;
+
+  for ( std::uint64_t hour {1}; hour <= hours; ++hour ) {
+    index.add(hour, static_cast<std::uint64_t>(out.tellp()));
+    out << make_report(hour);
+    written += make_report(hour);
+  }
+
+  out << std::flush;
+  buf.close();
+  index.close();
+
+  return written;
+}
+
+static void check_copy_steps(ehanc::test& results, const std::string& path,
+                             const std::string& written,
+                             const std::string& label)
+{
+  auto copy {[&path](const std::uint64_t first, const std::uint64_t last)
+                  -> std::optional<std::string> {
+    std::stringstream out;
+    if ( not log_index::copy_steps(path, first, last, out) ) {
+      return std::nullopt;
+    }
+    return out.str();
+  }};
+
+  std::string expected_range;
+  for ( std::uint64_t hour {10}; hour <= 12; ++hour ) {
+    expected_range += make_report(hour);
+  }
+
+  results.add_case(copy(10, 12) == expected_range, true,
+                   label + ": wrong reports for hours 10 to 12");
+  results.add_case(copy(400, 400) == make_report(400), true,
+                   label + ": wrong report for the last hour");
+  results.add_case(copy(1, 400) == written, true,
+                   label + ": wrong reports for every hour");
+  results.add_case(copy(401, 500).has_value(), false,
+                   label + ": read hours never written");
+
+  std::filesystem::remove(log_index::index_path(path));
+  std::filesystem::remove(path);
+}
+
+static auto test_copy_steps() -> ehanc::test
+{
+  ehanc::test results;
+
+  const std::uint64_t hours {400};
+
+  const std::string text_path {(std::filesystem::temp_directory_path()
+                                / "zebra_test_log_index.txt")
+                                   .string()};
+  const std::string compressed_path {
+      (std::filesystem::temp_directory_path()
+       / "zebra_test_log_index.txt.lz4")
+          .string()};
+
+  {
+    mapped_file_buf buf(text_path);
+    const std::string written {write_log(buf, text_path, hours)};
+    check_copy_steps(results, text_path, written, "Text log");
+  }
+
+  {
+    // Small blocks, so that the reports span many of them
+    compressed_file_buf buf(compressed_path, 256);
+    const std::string written {write_log(buf, compressed_path, hours)};
+
+    // Late hours are read from their own block, so a damaged block
+    // early in the log does not get in the way
+    {
+      std::fstream log(compressed_path,
+                       std::ios::binary | std::ios::in | std::ios::out);
+      log.seekp(static_cast<std::streamoff>(lz4::frame_header().size()));
+      log.write("\xFF\xFF\xFF\x7F", 4);
+    }
+    std::stringstream late;
+    results.add_case(
+        log_index::copy_steps(compressed_path, 400, 400, late)
+            && late.str() == make_report(400),
+        true, "Compressed log: read from the start for a late hour");
+
+    compressed_file_buf rewritten(compressed_path, 256);
+    write_log(rewritten, compressed_path, hours);
+    check_copy_steps(results, compressed_path, written, "Compressed log");
+  }
+
+  return results;
+}
+
+void test_log_index()
+{
+  ehanc::run_test("log_index::writer and reader", &test_writer_reader);
+  ehanc::run_test("log_index::copy_steps", &test_copy_steps);
+}
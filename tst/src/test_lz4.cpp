@@ -0,0 +1,205 @@
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "random.hpp"
+
+#include "test_lz4.h"
+#include "test_utils.hpp"
+
+// Compresses `data` as a single block, then decompresses it again
+static auto block_round_trip(const std::string& data)
+    -> std::optional<std::string>
+{
+  lz4::block_compressor compressor;
+
+  std::vector<char> compressed(lz4::compress_bound(data.size()));
+  const std::size_t compressed_size {
+      compressor.compress(data.data(), data.size(), compressed.data())};
+
+  std::string decompressed(data.size(), '\0');
+  const std::optional<std::size_t> decompressed_size {
+      lz4::decompress_block(compressed.data(), compressed_size,
+                            decompressed.data(), decompressed.size())};
+
+  if ( not decompressed_size.has_value() ) {
+    return std::nullopt;
+  }
+
+  decompressed.resize(*decompressed_size);
+  return decompressed;
+}
+
+// Text as repetitive as the hourly reports
+static auto make_report_text(const std::size_t hours) -> std::string
+{
+  std::stringstream text;
+
+  for ( std::size_t i {0}; i != hours; ++i ) {
+    text << "==== Space Station Zebra hour " << i << " report ====\n";
+    for ( int bay {1}; bay <= 4; ++bay ) {
+      text << "Repair Bay #" << bay << "'s report\n"
+           << "Currently repairing ship " << (i * 4) + 100 << '\n';
+    }
+    text << "Ships in queue: " << i % 7 << '\n';
+  }
+
+  return text.str();
+}
+
+static auto make_random_text(const std::size_t size) -> std::string
+{
+  std::string text(size, '\0');
+
+  for ( auto& ch : text ) {
+    ch = static_cast<char>(random_engine()());
+  }
+
+  return text;
+}
+
+static auto test_xxh32() -> ehanc::test
+{
+  ehanc::test results;
+
+  auto hash {[](const std::string_view data) {
+    return lz4::xxh32(data.data(), data.size());
+  }};
+
+  results.add_case(hash(""), std::uint32_t {0x02CC5D05U},
+                   "Wrong hash of nothing");
+  results.add_case(hash("abc"), std::uint32_t {0x32D153FFU},
+                   "Wrong hash of short input");
+  results.add_case(hash("Nobody inspects the spammish repetition"),
+                   std::uint32_t {0xE2293B2FU},
+                   "Wrong hash of long input");
+
+  return results;
+}
+
+static auto test_block() -> ehanc::test
+{
+  ehanc::test results;
+
+  const std::vector<std::string> inputs {
+      "",
+      "a",
+      "Twelve bytes",
+      std::string(1000, 'z'),
+      std::string(300, 'x') + make_random_text(300)
+          + std::string(300, 'x'),
+      make_report_text(2000),
+      make_random_text(100'000)};
+
+  for ( std::size_t i {0}; i != inputs.size(); ++i ) {
+    results.add_case(block_round_trip(inputs[i]) == inputs[i], true,
+                     "Round trip changed input " + std::to_string(i));
+  }
+
+  const std::string report {make_report_text(2000)};
+  std::vector<char> compressed(lz4::compress_bound(report.size()));
+  lz4::block_compressor compressor;
+
+  results.add_case(compressor.compress(report.data(), report.size(),
+                                       compressed.data())
+                       < report.size() / 4,
+                   true, "Reports compressed less than 4:1");
+
+  return results;
+}
+
+static auto test_malformed_block() -> ehanc::test
+{
+  ehanc::test results;
+
+  std::string output(64, '\0');
+
+  // A match reaching back before the start of the output
+  const std::string bad_offset {"\x14"
+                                "a\x05\x00",
+                                4};
+  results.add_case(lz4::decompress_block(bad_offset.data(),
+                                         bad_offset.size(), output.data(),
+                                         output.size())
+                       .has_value(),
+                   false, "Accepted an offset out of range");
+
+  // Literals running past the end of the input
+  const std::string short_literals {"\x50"
+                                    "ab"};
+  results.add_case(lz4::decompress_block(short_literals.data(),
+                                         short_literals.size(),
+                                         output.data(), output.size())
+                       .has_value(),
+                   false, "Accepted truncated literals");
+
+  // More output than there is room for
+  const std::string data(100, 'q');
+  std::vector<char> compressed(lz4::compress_bound(data.size()));
+  lz4::block_compressor compressor;
+  const std::size_t compressed_size {
+      compressor.compress(data.data(), data.size(), compressed.data())};
+
+  results.add_case(lz4::decompress_block(compressed.data(),
+                                         compressed_size, output.data(),
+                                         output.size())
+                       .has_value(),
+                   false, "Overflowed the output buffer");
+
+  return results;
+}
+
+static auto test_frames() -> ehanc::test
+{
+  ehanc::test results;
+
+  const std::string report {make_report_text(500)};
+  const std::string noise {make_random_text(5000)};
+
+  lz4::block_compressor compressor;
+  std::vector<char> encoded;
+
+  // Two frames back to back, the first with two blocks
+  const std::vector<std::vector<std::string>> frames {{report, noise},
+                                                     {report}};
+
+  for ( const auto& blocks : frames ) {
+    const auto header {lz4::frame_header()};
+    encoded.insert(encoded.end(), header.begin(), header.end());
+    for ( const auto& block : blocks ) {
+      lz4::encode_block(compressor, block.data(), block.size(), encoded);
+    }
+    encoded.insert(encoded.end(), lz4::frame_end.begin(),
+                   lz4::frame_end.end());
+  }
+
+  std::stringstream in(std::string(encoded.begin(), encoded.end()));
+  std::stringstream out;
+
+  results.add_case(lz4::decompress_frames(in, out), true,
+                   "Failed to decompress frames");
+  results.add_case(out.str() == report + noise + report, true,
+                   "Frames decompressed to the wrong data");
+
+  std::stringstream truncated(
+      std::string(encoded.begin(), std::prev(encoded.end())));
+  std::stringstream ignored;
+
+  results.add_case(lz4::decompress_frames(truncated, ignored), false,
+                   "Accepted a truncated frame");
+
+  return results;
+}
+
+void test_lz4()
+{
+  ehanc::run_test("lz4::xxh32", &test_xxh32);
+  ehanc::run_test("lz4 block round trip", &test_block);
+  ehanc::run_test("lz4 malformed blocks", &test_malformed_block);
+  ehanc::run_test("lz4 frames", &test_frames);
+}
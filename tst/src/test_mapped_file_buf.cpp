@@ -0,0 +1,81 @@
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+#include "test_mapped_file_buf.h"
+#include "test_utils.hpp"
+
+static auto test_write() -> ehanc::test
+{
+  ehanc::test results;
+
+  const std::filesystem::path path {
+      std::filesystem::temp_directory_path()
+      / "zebra_test_mapped_file_buf.txt"};
+
+  // Smallest possible extent, so that writing crosses several of them
+  const std::size_t extent {1};
+  const std::size_t line_count {5000};
+
+  std::stringstream expected;
+
+  {
+    mapped_file_buf buf(path.string(), extent);
+    results.add_case(buf.is_open(), true, "Failed to open");
+
+    std::ostream out(&buf);
+
+    for ( std::size_t i {0}; i != line_count; ++i ) {
+      if ( i == line_count / 2 ) {
+        results.add_case(static_cast<std::size_t>(out.tellp()),
+                         expected.str().size(), "tellp() is wrong");
+      }
+      out << "Line " << i << " of the report\n";
+      expected << "Line " << i << " of the report\n";
+    }
+
+    out << std::flush;
+    results.add_case(buf.size(), expected.str().size(),
+                     "Wrong size before close");
+    results.add_case(buf.close(), true, "Failed to close");
+    results.add_case(buf.is_open(), false, "Open after close");
+  }
+
+  results.add_case(
+      static_cast<std::size_t>(std::filesystem::file_size(path)),
+      expected.str().size(), "File not truncated to written size");
+
+  std::ifstream in(path, std::ios::binary);
+  std::string contents(
+      static_cast<std::size_t>(std::filesystem::file_size(path)), '\0');
+  in.read(contents.data(), static_cast<std::streamsize>(contents.size()));
+
+  results.add_case(contents == expected.str(), true,
+                   "File contents differ from what was written");
+
+  std::filesystem::remove(path);
+
+  return results;
+}
+
+static auto test_bad_path() -> ehanc::test
+{
+  ehanc::test results;
+
+  mapped_file_buf buf("/nonexistent_directory/zebra.txt");
+
+  results.add_case(buf.is_open(), false, "Opened a nonexistent path");
+  results.add_case(buf.close(), false, "Closed a file never opened");
+
+  return results;
+}
+
+void test_mapped_file_buf()
+{
+  ehanc::run_test("mapped_file_buf write", &test_write);
+  ehanc::run_test("mapped_file_buf bad path", &test_bad_path);
+}
@@ -0,0 +1,172 @@
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "test_metrics.h"
+#include "test_utils.hpp"
+
+// Rows which exercise every kind of delta: none, small and large, of
+// either sign
+static auto make_rows(const std::size_t count) -> std::vector<metrics::row>
+{
+  std::vector<metrics::row> rows;
+
+  for ( std::size_t i {0}; i != count; ++i ) {
+    const auto step {static_cast<std::int64_t>(i)};
+    rows.push_back({step % 4, 3 - (step % 3), step * 1000,
+                    (step / 10) % 5, step % 2 == 0 ? -step : step << 30U,
+                    step * 7, 42});
+  }
+
+  return rows;
+}
+
+static auto test_round_trip() -> ehanc::test
+{
+  ehanc::test results;
+
+  const std::filesystem::path path {
+      std::filesystem::temp_directory_path() / "zebra_test_metrics.bin"};
+
+  // Several full blocks, then a partial one
+  const std::size_t block_rows {7};
+  const std::vector<metrics::row> rows {make_rows(100)};
+
+  {
+    metrics::writer writer(path.string(), 1, block_rows);
+    results.add_case(writer.is_open(), true, "Failed to open");
+
+    for ( const auto& values : rows ) {
+      writer.record(values);
+    }
+
+    results.add_case(writer.close(), true, "Failed to close");
+  }
+
+  std::vector<metrics::row> read_rows;
+  std::size_t block_count {0};
+
+  {
+    metrics::reader reader(path.string());
+    results.add_case(reader.is_open(), true, "Failed to open for reading");
+
+    while ( reader.next_block() ) {
+      ++block_count;
+      for ( std::size_t i {0}; i != reader.block_rows(); ++i ) {
+        metrics::row values {};
+        for ( std::size_t j {0}; j != metrics::column_count; ++j ) {
+          values[j] = reader.column(j)[i];
+        }
+        read_rows.push_back(values);
+      }
+    }
+  }
+
+  const std::size_t expected_block_count {
+      (rows.size() + block_rows - 1) / block_rows};
+  results.add_case(block_count, expected_block_count,
+                   "Wrong number of blocks");
+  results.add_case(read_rows == rows, true, "Rows changed in round trip");
+
+  // A crash in the middle of writing leaves part of a block
+  std::filesystem::resize_file(path,
+                               std::filesystem::file_size(path) - 3);
+
+  metrics::reader truncated(path.string());
+  std::size_t truncated_block_count {0};
+  while ( truncated.next_block() ) {
+    ++truncated_block_count;
+  }
+
+  results.add_case(truncated_block_count, block_count - 1,
+                   "Partial block not ignored");
+
+  std::filesystem::remove(path);
+
+  return results;
+}
+
+static auto test_write_csv() -> ehanc::test
+{
+  ehanc::test results;
+
+  const std::filesystem::path path {
+      std::filesystem::temp_directory_path()
+      / "zebra_test_metrics_csv.bin"};
+
+  {
+    metrics::writer writer(path.string());
+    writer.record({1, 0, 1, 1, 5, 3, 2});
+    writer.record({0, 1, 0, 1, -2, 0, 0});
+  }
+
+  std::stringstream csv;
+
+  results.add_case(metrics::write_csv(path.string(), csv), true,
+                   "Failed to write CSV");
+  results.add_case(csv.str(),
+                   std::string {"step,new_ships,leaving_ships,queue_size,"
+                                "occupied_bays,bay_time_remaining,"
+                                "queue_repair_hours,queue_parts\n"
+                                "1,1,0,1,1,5,3,2\n"
+                                "2,0,1,0,1,-2,0,0\n"},
+                   "Wrong CSV");
+
+  // A resumed run numbers its steps from where it resumed
+  {
+    metrics::writer writer(path.string(), 297);
+    writer.record({1, 0, 1, 1, 5, 3, 2});
+    writer.record({0, 1, 0, 1, -2, 0, 0});
+  }
+
+  std::stringstream resumed_csv;
+  metrics::write_csv(path.string(), resumed_csv);
+  results.add_case(resumed_csv.str().substr(csv.str().find('\n') + 1),
+                   std::string {"297,1,0,1,1,5,3,2\n"
+                                "298,0,1,0,1,-2,0,0\n"},
+                   "Resumed steps numbered from 1");
+
+  std::filesystem::remove(path);
+
+  std::stringstream ignored;
+  results.add_case(metrics::write_csv(path.string(), ignored), false,
+                   "Wrote CSV of a nonexistent file");
+
+  return results;
+}
+
+static auto test_sample() -> ehanc::test
+{
+  ehanc::test results;
+
+  space_station station("Guinea Pig");
+
+  for ( int i {0}; i != 100; ++i ) {
+    const space_station::step_summary summary {station.step()};
+    const metrics::row values {metrics::sample(station)};
+
+    const metrics::row expected {
+        static_cast<std::int64_t>(summary.new_ships),
+        static_cast<std::int64_t>(summary.leaving_ships),
+        static_cast<std::int64_t>(station.queue_size()),
+        station.occupied_bay_count(),
+        station.total_bay_time_remaining(),
+        static_cast<std::int64_t>(station.queue_repair_hours()),
+        static_cast<std::int64_t>(station.queue_part_count())};
+
+    results.add_case(values == expected, true,
+                     "Sample differs from the station");
+  }
+
+  return results;
+}
+
+void test_metrics()
+{
+  ehanc::run_test("metrics round trip", &test_round_trip);
+  ehanc::run_test("metrics::write_csv", &test_write_csv);
+  ehanc::run_test("metrics::sample", &test_sample);
+}
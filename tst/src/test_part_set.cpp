@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "test_part_set.h"
+#include "test_utils.hpp"
+
+#include "constants.h"
+#include "part_table.h"
+
+static auto test_insert() -> ehanc::test
+{
+  ehanc::test results;
+
+  part_set test;
+
+  results.add_case(test.empty(), true, "Not empty on construction");
+  results.add_case(test.size(), std::size_t {0}, "Nonzero size");
+
+  // Spread across several words, inserted out of order
+  const std::array<int, 6> ids {999, 3, 64, 0, 63, 500};
+  const std::array<int, 6> damages {10, 1, 7, 2, 5, 4};
+
+  for ( std::size_t i {0}; i != ids.size(); ++i ) {
+    results.add_case(test.insert(ids[i], damages[i]), true,
+                     "Rejected a new part");
+  }
+
+  results.add_case(test.insert(64, 9), false, "Accepted a duplicate part");
+  results.add_case(test.damage(64), 7, "Duplicate overwrote damage");
+
+  results.add_case(test.size(), ids.size(), "Wrong size");
+  results.add_case(test.total_damage(), 29, "Wrong total damage");
+
+  for ( std::size_t i {0}; i != ids.size(); ++i ) {
+    results.add_case(test.contains(ids[i]), true, "Lost a part");
+    results.add_case(test.damage(ids[i]), damages[i],
+                     "Damage does not match part");
+  }
+
+  results.add_case(test.contains(1), false, "Contains a missing part");
+  results.add_case(test.damage(1), 0, "Damage for a missing part");
+
+  test.clear();
+
+  results.add_case(test.empty(), true, "Not empty after clear");
+  results.add_case(test.contains(999), false, "Part left after clear");
+  results.add_case(test.total_damage(), 0, "Damage left after clear");
+
+  return results;
+}
+
+static auto test_iteration() -> ehanc::test
+{
+  ehanc::test results;
+
+  part_set test;
+
+  results.add_case(test.begin() == test.end(), true,
+                   "Empty set not empty range");
+
+  test.insert(700, 3);
+  test.insert(2, 6);
+  test.insert(128, 1);
+  test.insert(65, 8);
+
+  std::vector<int> ids;
+  std::vector<int> damages;
+  for ( const part_set::part& p : test ) {
+    ids.push_back(p.id);
+    damages.push_back(p.damage);
+  }
+
+  results.add_case(ids, std::vector<int> {2, 65, 128, 700},
+                   "IDs not in ascending order");
+  results.add_case(damages, std::vector<int> {6, 8, 1, 3},
+                   "Damage not paired with IDs");
+
+  return results;
+}
+
+static auto test_masks() -> ehanc::test
+{
+  ehanc::test results;
+
+  constexpr std::array<int, 4> valid_ids {1, 2, 100, 900};
+  constexpr part_set::mask valid {part_set::make_mask(valid_ids)};
+
+  static_assert(part_set::mask_count(valid) == valid_ids.size());
+
+  part_set test;
+  test.insert(2, 1);
+  test.insert(900, 1);
+
+  results.add_case(test.is_subset_of(valid), true,
+                   "Valid parts not a subset");
+
+  test.insert(3, 1);
+
+  results.add_case(test.is_subset_of(valid), false,
+                   "Invalid part went unnoticed");
+
+  return results;
+}
+
+// Not arithmetic progressions, so looked up in memory
+static constexpr std::array<int, 5> irregular_ids {3, 4, 9, 10, 500};
+static constexpr std::array<int, 3> descending_ids {9, 6, 3};
+static constexpr std::array<int, 1> single_id {42};
+
+// Checks a part_table against the list it was built from
+template <const auto& Ids>
+static void check_part_table(ehanc::test& results,
+                             const bool expect_progression,
+                             const std::string& name)
+{
+  using table = part_table<Ids>;
+
+  results.add_case(table::is_progression, expect_progression,
+                   "Progression not detected - " + name);
+  results.add_case(table::size(), Ids.size(), "Wrong size - " + name);
+
+  bool ids_match {true};
+  for ( std::size_t i {0}; i != Ids.size(); ++i ) {
+    ids_match = ids_match && table::id(i) == Ids[i];
+  }
+  results.add_case(ids_match, true, "Wrong ID - " + name);
+
+  bool contains_match {true};
+  for ( int id {-10}; id != conf::part_id_limit + 10; ++id ) {
+    const bool listed {std::find(Ids.cbegin(), Ids.cend(), id)
+                       != Ids.cend()};
+    contains_match = contains_match && table::contains(id) == listed;
+  }
+  results.add_case(contains_match, true, "Wrong membership - " + name);
+}
+
+static auto test_part_table() -> ehanc::test
+{
+  ehanc::test results;
+
+  check_part_table<conf::human_part_list>(results, true, "human");
+  check_part_table<conf::ferengi_part_list>(results, true, "ferengi");
+  check_part_table<conf::klingon_part_list>(results, true, "klingon");
+  check_part_table<conf::romulan_part_list>(results, true, "romulan");
+  check_part_table<conf::other_part_list>(results, true, "other");
+  check_part_table<irregular_ids>(results, false, "irregular");
+  check_part_table<descending_ids>(results, false, "descending");
+  check_part_table<single_id>(results, true, "single");
+
+  static_assert(part_table<conf::klingon_part_list>::stride == 2);
+  static_assert(part_table<conf::klingon_part_list>::contains(200));
+  static_assert(not part_table<conf::klingon_part_list>::contains(201));
+
+  return results;
+}
+
+void test_part_set()
+{
+  ehanc::run_test("part_set::insert", &test_insert);
+  ehanc::run_test("part_set iteration", &test_iteration);
+  ehanc::run_test("part_set::make_mask", &test_masks);
+  ehanc::run_test("part_table", &test_part_table);
+}
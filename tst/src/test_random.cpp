@@ -1,43 +1,101 @@
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstddef>
-#include <deque>
+#include <cstdint>
+#include <future>
+#include <limits>
 #include <numeric>
+#include <random>
 #include <sstream>
 #include <string>
 #include <string_view>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "utils/alias_table.hpp"
+#include "utils/bounded_int.hpp"
 #include "utils/etc.hpp"
 
 #include "constants.h"
 #include "test_random.h"
 #include "test_utils.hpp"
 
-static auto test_get_part_count() -> ehanc::test
+// Number of independently seeded chunks large sampling tests are split
+// into. Fixed, rather than tied to the number of cores, so that results
+// only depend on the seed.
+constexpr inline std::size_t sample_chunks {8};
+
+// Draws `num_samples` samples split into `sample_chunks` chunks, each
+// on its own thread, and merges the partial results. Each chunk starts
+// from a copy of `init`, and calls `sample_chunk(count, partial)` with
+// its thread's random engine seeded from the test's seed and the chunk
+// index.
+template <typename Result, typename ChunkFunc>
+static auto parallel_samples(const std::size_t num_samples,
+                             const Result& init,
+                             const ChunkFunc& sample_chunk) -> Result
 {
-  ehanc::test results;
+  const std::uint32_t seed {ehanc::current_test_seed()};
+
+  std::vector<std::future<Result>> chunks;
+  chunks.reserve(sample_chunks);
+
+  for ( std::size_t i {0}; i != sample_chunks; ++i ) {
+    const std::size_t count {(num_samples / sample_chunks)
+                             + (i < num_samples % sample_chunks ? 1 : 0)};
+    const auto chunk_seed {
+        static_cast<std::uint32_t>(seed + ((i + 1) * 0x9E3779B9U))};
+
+    chunks.push_back(std::async(
+        std::launch::async, [&sample_chunk, &init, count, chunk_seed]() {
+          seed_random_engine(chunk_seed);
+          Result partial {init};
+          sample_chunk(count, partial);
+          return partial;
+        }));
+  }
+
+  Result retval {init};
+  for ( auto& chunk : chunks ) {
+    retval.merge(chunk.get());
+  }
+  return retval;
+}
 
-  using test_value_t = long;
+// Batch samplers are exercised in blocks of this size, so that no test
+// needs to hold all of its samples at once
+constexpr inline std::size_t sample_block_size {4096};
 
-  std::deque<test_value_t> test_values;
+// Feeds `count` values from a batch sampler into `sink`, one block at a
+// time
+template <typename Value, typename BatchFunc, typename SinkFunc>
+static void sample_in_blocks(std::size_t count, const BatchFunc& batch,
+                             const SinkFunc& sink)
+{
+  std::vector<Value> block(sample_block_size);
 
-  const std::size_t num_samples {1'000'000};
+  while ( count != 0 ) {
+    const std::size_t block_count {std::min(count, sample_block_size)};
+    const auto block_end {
+        std::next(block.begin(), static_cast<long>(block_count))};
 
-  const double mean_fudge_factor {0.5};
+    batch(block.begin(), block_end);
+    std::for_each(block.begin(), block_end, sink);
 
-  for ( std::size_t i {0}; i < num_samples; ++i ) {
-    test_values.push_back(static_cast<long>(get_part_count()));
+    count -= block_count;
   }
+}
 
-  double test_values_mean {
-      static_cast<double>(
-          std::accumulate(test_values.cbegin(), test_values.cend(), 0L))
-      / static_cast<double>(num_samples)};
+// Checks samples of part counts against the normal distribution
+// configured in constants.h
+static void check_part_counts(ehanc::test& results,
+                              const ehanc::running_stats& stats)
+{
+  const double mean_fudge_factor {0.5};
 
-  double mean_diff {
-      std::abs(test_values_mean - conf::broken_part_count_mean)};
+  double mean_diff {std::abs(stats.mean() - conf::broken_part_count_mean)};
 
   // Testing for being within mean_fudge_factor of mean, because requiring
   // a minimum of 1 drags down the mean
@@ -46,52 +104,109 @@ static auto test_get_part_count() -> ehanc::test
       + " of expected, actual mean diff == " + std::to_string(mean_diff)};
 
   results.add_case(mean_diff < mean_fudge_factor, true, mean_test_msg);
-  results.add_case(test_values_mean < conf::broken_part_count_mean, true,
+  results.add_case(stats.mean() < conf::broken_part_count_mean, true,
                    "Mean not dragged down");
 
-  using diff_t = typename std::iterator_traits<
-      std::deque<test_value_t>::const_iterator>::difference_type;
-
-  diff_t num_bad_values {
-      std::count_if(test_values.cbegin(), test_values.cend(),
-                    [](const test_value_t val) -> bool {
-                      return val < conf::broken_part_count_min;
-                    })};
-
   results.add_case(
-      num_bad_values, static_cast<diff_t>(0),
+      stats.min() < conf::broken_part_count_min, false,
       "Returned a value less than conf::broken_part_count_min");
+}
+
+static auto test_get_part_count() -> ehanc::test
+{
+  ehanc::test results;
+
+  const std::size_t num_samples {1'000'000};
+
+  const ehanc::running_stats stats {parallel_samples(
+      num_samples, ehanc::running_stats {},
+      [](const std::size_t count, ehanc::running_stats& partial) {
+        for ( std::size_t i {0}; i < count; ++i ) {
+          partial.push(static_cast<double>(get_part_count()));
+        }
+      })};
+
+  check_part_counts(results, stats);
 
   return results;
 }
 
-static auto test_get_new_ship_count() noexcept -> ehanc::test
+static auto test_get_part_counts() -> ehanc::test
 {
   ehanc::test results;
 
-  using test_value_t = double;
-  std::deque<test_value_t> test_values;
-  const std::size_t num_samples {3'000'000};
+  const std::size_t num_samples {1'000'000};
 
-  const double mean_fudge_factor {0.003};
+  const ehanc::running_stats stats {parallel_samples(
+      num_samples, ehanc::running_stats {},
+      [](const std::size_t count, ehanc::running_stats& partial) {
+        sample_in_blocks<long>(
+            count,
+            [](auto begin, auto end) { get_part_counts(begin, end); },
+            [&partial](const long value) {
+              partial.push(static_cast<double>(value));
+            });
+      })};
 
-  for ( std::size_t i {0}; i < num_samples; ++i ) {
-    test_values.push_back(static_cast<double>(get_new_ship_count()));
-  }
+  check_part_counts(results, stats);
 
-  double test_values_mean {
-      static_cast<double>(
-          std::accumulate(test_values.cbegin(), test_values.cend(), 0.0))
-      / static_cast<double>(num_samples)};
+  return results;
+}
+
+// Checks the mean of samples of new ship counts against the
+// poisson mean configured in constants.h
+static void check_new_ship_counts(ehanc::test& results,
+                                  const ehanc::running_stats& stats)
+{
+  const double mean_fudge_factor {0.003};
 
   double mean_diff {
-      std::abs(test_values_mean - conf::new_ship_count_poisson_mean)};
+      std::abs(stats.mean() - conf::new_ship_count_poisson_mean)};
 
   std::string mean_test_msg {
       "Measured mean not within " + std::to_string(mean_fudge_factor)
       + " of expected, actual mean diff == " + std::to_string(mean_diff)};
 
   results.add_case(mean_diff < mean_fudge_factor, true, mean_test_msg);
+}
+
+static auto test_get_new_ship_count() noexcept -> ehanc::test
+{
+  ehanc::test results;
+
+  const std::size_t num_samples {3'000'000};
+
+  const ehanc::running_stats stats {parallel_samples(
+      num_samples, ehanc::running_stats {},
+      [](const std::size_t count, ehanc::running_stats& partial) {
+        for ( std::size_t i {0}; i < count; ++i ) {
+          partial.push(static_cast<double>(get_new_ship_count()));
+        }
+      })};
+
+  check_new_ship_counts(results, stats);
+
+  return results;
+}
+
+static auto test_get_new_ship_counts() noexcept -> ehanc::test
+{
+  ehanc::test results;
+
+  const std::size_t num_samples {3'000'000};
+
+  const ehanc::running_stats stats {parallel_samples(
+      num_samples, ehanc::running_stats {},
+      [](const std::size_t count, ehanc::running_stats& partial) {
+        sample_in_blocks<int>(
+            count,
+            [](auto begin, auto end) { get_new_ship_counts(begin, end); },
+            [&partial](const int value) {
+              partial.push(static_cast<double>(value));
+            });
+      })};
+
+  check_new_ship_counts(results, stats);
 
   return results;
 }
@@ -106,25 +221,27 @@ static auto test_random_select() -> ehanc::test
   // Fudge factor for how often a particular value is selected
   // Any element may be selected
   // ((num_samples / range_max) +- count_fudge_factor) times
-  const int count_fudge_factor {800};
+  const long count_fudge_factor {800};
 
   // fill range with [1, range_max]
   std::vector<int> range(range_max);
   std::iota(range.begin(), range.end(), 1);
 
-  std::deque<int> samples;
-  for ( std::size_t i {0}; i < num_samples; ++i ) {
-    samples.push_back(*random_select(range.cbegin(), range.cend()));
-  }
-
-  using count_t = typename std::iterator_traits<
-      std::vector<int>::const_iterator>::difference_type;
+  const ehanc::histogram samples {parallel_samples(
+      num_samples, ehanc::histogram {range_max},
+      [&range](const std::size_t count, ehanc::histogram& partial) {
+        for ( std::size_t i {0}; i < count; ++i ) {
+          partial.push(static_cast<std::size_t>(
+              *random_select(range.cbegin(), range.cend()) - 1));
+        }
+      })};
 
   for ( const auto val : range ) {
     // Number of times val occures in samples
-    count_t num_occurances {
-        std::count(samples.cbegin(), samples.cend(), val)};
-    count_t expected_occurances {num_samples / range_max};
+    const auto num_occurances {static_cast<long>(
+        samples.count(static_cast<std::size_t>(val - 1)))};
+    const auto expected_occurances {
+        static_cast<long>(num_samples / range_max)};
 
     std::stringstream message;
     message << "Expected " << expected_occurances << " +- "
@@ -140,34 +257,16 @@ static auto test_random_select() -> ehanc::test
   return results;
 }
 
-static auto test_get_random_faction() -> ehanc::test
+// Checks that faction frequencies among samples
+// match the conf::*_ship_chance constants
+static void check_faction_chances(ehanc::test& results,
+                                  const ehanc::histogram& samples)
 {
-  ehanc::test results;
-
-  const int num_samples {1'000'000};
   const double chance_fudge_factor {1.5};
 
-  using count_t = typename std::iterator_traits<
-      std::deque<ship::faction>::const_iterator>::difference_type;
-  std::deque<ship::faction> samples;
+  const auto num_samples {static_cast<double>(samples.total())};
 
-  for ( std::size_t i {0}; i < num_samples; ++i ) {
-    samples.push_back(get_random_faction());
-  }
-
-  const count_t human_count {
-      std::count(samples.cbegin(), samples.cend(), ship::faction::human)};
-  const count_t ferengi_count {std::count(samples.cbegin(), samples.cend(),
-                                          ship::faction::ferengi)};
-  const count_t klingon_count {std::count(samples.cbegin(), samples.cend(),
-                                          ship::faction::klingon)};
-  const count_t romulan_count {std::count(samples.cbegin(), samples.cend(),
-                                          ship::faction::romulan)};
-  const count_t other_count {
-      std::count(samples.cbegin(), samples.cend(), ship::faction::other)};
-
-  auto case_adder {[&](const count_t count, const ship::faction type,
-                       int expected_chance) {
+  auto case_adder {[&](const ship::faction type, int expected_chance) {
     auto faction_to_string {
         [](const ship::faction fact) -> std::string_view {
           switch ( fact ) {
@@ -184,9 +283,10 @@ static auto test_get_random_faction() -> ehanc::test
           }
         }};
 
-    double apparent_chance {
-        (static_cast<double>(count) / static_cast<double>(num_samples))
-        * 100};
+    const auto count {samples.count(static_cast<std::size_t>(type))};
+
+    double apparent_chance {(static_cast<double>(count) / num_samples)
+                            * 100};
 
     std::stringstream message;
     message << "Expected " << expected_chance << "% "
@@ -200,14 +300,273 @@ static auto test_get_random_faction() -> ehanc::test
     results.add_case(is_good_chance, true, message.str());
   }};
 
-  case_adder(human_count, ship::faction::human, conf::human_ship_chance);
-  case_adder(ferengi_count, ship::faction::ferengi,
-             conf::ferengi_ship_chance);
-  case_adder(klingon_count, ship::faction::klingon,
-             conf::klingon_ship_chance);
-  case_adder(romulan_count, ship::faction::romulan,
-             conf::romulan_ship_chance);
-  case_adder(other_count, ship::faction::other, conf::other_ship_chance);
+  case_adder(ship::faction::human, conf::human_ship_chance);
+  case_adder(ship::faction::ferengi, conf::ferengi_ship_chance);
+  case_adder(ship::faction::klingon, conf::klingon_ship_chance);
+  case_adder(ship::faction::romulan, conf::romulan_ship_chance);
+  case_adder(ship::faction::other, conf::other_ship_chance);
+}
+
+static auto test_get_random_faction() -> ehanc::test
+{
+  ehanc::test results;
+
+  const std::size_t num_samples {1'000'000};
+
+  const ehanc::histogram samples {parallel_samples(
+      num_samples, ehanc::histogram {faction_table.size()},
+      [](const std::size_t count, ehanc::histogram& partial) {
+        for ( std::size_t i {0}; i < count; ++i ) {
+          partial.push(static_cast<std::size_t>(get_random_faction()));
+        }
+      })};
+
+  check_faction_chances(results, samples);
+
+  return results;
+}
+
+static auto test_get_random_factions() -> ehanc::test
+{
+  ehanc::test results;
+
+  const std::size_t num_samples {1'000'000};
+
+  const ehanc::histogram samples {parallel_samples(
+      num_samples, ehanc::histogram {faction_table.size()},
+      [](const std::size_t count, ehanc::histogram& partial) {
+        sample_in_blocks<ship::faction>(
+            count,
+            [](auto begin, auto end) { get_random_factions(begin, end); },
+            [&partial](const ship::faction value) {
+              partial.push(static_cast<std::size_t>(value));
+            });
+      })};
+
+  check_faction_chances(results, samples);
+
+  return results;
+}
+
+static auto test_alias_table() -> ehanc::test
+{
+  ehanc::test results;
+
+  // Built at run time, includes a category which must never be drawn
+  const std::array<long, 5> weights {3, 0, 1, 6, 10};
+  const ehanc::alias_table<5> table(weights);
+
+  results.add_case(table.total_weight(), std::uint64_t {20},
+                   "Wrong total weight");
+
+  for ( std::size_t i {0}; i != weights.size(); ++i ) {
+    results.add_case(table.outcomes(i),
+                     static_cast<std::uint64_t>(weights[i]) * 5,
+                     "Table does not reproduce weight of category "
+                         + std::to_string(i));
+  }
+
+  const std::size_t num_samples {1'000'000};
+  const double chance_fudge_factor {0.5};
+
+  const ehanc::histogram samples {parallel_samples(
+      num_samples, ehanc::histogram {weights.size()},
+      [&table](const std::size_t count, ehanc::histogram& partial) {
+        sample_in_blocks<std::size_t>(
+            count,
+            [&table](auto begin, auto end) {
+              table(random_engine(), begin, end);
+            },
+            [&partial](const std::size_t value) { partial.push(value); });
+      })};
+
+  for ( std::size_t i {0}; i != weights.size(); ++i ) {
+    const double apparent_chance {
+        (static_cast<double>(samples.count(i))
+         / static_cast<double>(num_samples))
+        * 100};
+    const double expected_chance {static_cast<double>(weights[i]) * 5};
+
+    std::stringstream message;
+    message << "Expected " << expected_chance << "% of category " << i
+            << ", but got " << apparent_chance << "%";
+
+    results.add_case(std::abs(expected_chance - apparent_chance)
+                         < chance_fudge_factor,
+                     true, message.str());
+  }
+
+  results.add_case(samples.count(1), std::size_t {0},
+                   "Drew a category with zero weight");
+
+  return results;
+}
+
+// Engine which outputs a fixed sequence of 32 bit values, to check which
+// draws bounded sampling rejects
+class scripted_engine
+{
+private:
+
+  std::vector<std::uint32_t> m_outputs;
+  std::size_t m_next {0};
+
+public:
+
+  using result_type = std::uint32_t;
+
+  explicit scripted_engine(std::vector<std::uint32_t> outputs)
+      : m_outputs {std::move(outputs)}
+  {}
+
+  static constexpr auto min() noexcept -> result_type
+  {
+    return 0;
+  }
+
+  static constexpr auto max() noexcept -> result_type
+  {
+    return std::numeric_limits<std::uint32_t>::max();
+  }
+
+  auto operator()() -> result_type
+  {
+    return m_outputs.at(m_next++);
+  }
+
+  [[nodiscard]] auto used() const noexcept -> std::size_t
+  {
+    return m_next;
+  }
+};
+
+// Checks that every value in [0, range) was drawn about equally often
+static void check_uniform(ehanc::test& results,
+                          const ehanc::histogram& samples,
+                          const std::size_t range,
+                          const std::string_view name)
+{
+  const double chance_fudge_factor {0.3};
+  const auto num_samples {static_cast<double>(samples.total())};
+
+  for ( std::size_t i {0}; i != range; ++i ) {
+    const double apparent_chance {
+        (static_cast<double>(samples.count(i)) / num_samples) * 100};
+    const double expected_chance {100.0 / static_cast<double>(range)};
+
+    std::stringstream message;
+    message << name << ": expected " << expected_chance << "% of " << i
+            << ", but got " << apparent_chance << "%";
+
+    results.add_case(std::abs(expected_chance - apparent_chance)
+                         < chance_fudge_factor,
+                     true, message.str());
+  }
+}
+
+static auto test_bounded_rand() -> ehanc::test
+{
+  ehanc::test results;
+
+  // For a range of 3, 2^32 % 3 is 1, so only a draw whose product with 3
+  // is 0 modulo 2^32, which is only 0, must be rejected
+  scripted_engine script {{0, 0xFFFF'FFFF, 0x5555'5556}};
+  results.add_case(ehanc::bounded_rand(script, 3), std::uint64_t {2},
+                   "Biased draw not rejected");
+  results.add_case(script.used(), std::size_t {2},
+                   "Rejected the wrong draws");
+  results.add_case(ehanc::bounded_rand(script, 3), std::uint64_t {1},
+                   "Wrong scaling");
+
+  const std::size_t range {7};
+  const std::size_t num_samples {1'000'000};
+
+  const ehanc::histogram samples {parallel_samples(
+      num_samples, ehanc::histogram {range},
+      [](const std::size_t count, ehanc::histogram& partial) {
+        for ( std::size_t i {0}; i != count; ++i ) {
+          partial.push(ehanc::bounded_rand(random_engine(), range));
+        }
+      })};
+  check_uniform(results, samples, range, "32 bit engine");
+
+  // Engines of other widths use the standard distribution instead
+  const ehanc::histogram fallback_samples {parallel_samples(
+      num_samples, ehanc::histogram {range},
+      [](const std::size_t count, ehanc::histogram& partial) {
+        std::minstd_rand gen(random_engine()());
+        for ( std::size_t i {0}; i != count; ++i ) {
+          partial.push(ehanc::bounded_rand(gen, range));
+        }
+      })};
+  check_uniform(results, fallback_samples, range, "Other engine");
+
+  return results;
+}
+
+static auto test_bounded_dist() -> ehanc::test
+{
+  ehanc::test results;
+
+  constexpr ehanc::bounded_dist three(3);
+  static_assert(three.range() == 3);
+
+  scripted_engine script {{0, 0xFFFF'FFFF, 0, 0x5555'5556, 7}};
+  results.add_case(three(script), std::uint32_t {2},
+                   "Biased draw not rejected");
+
+  // Rejected draws in a batch are redrawn, after the rest of the block
+  std::array<std::uint32_t, 2> batch {};
+  three(script, batch.begin(), batch.end());
+  results.add_case(batch[0], std::uint32_t {0},
+                   "Biased batch draw not redrawn");
+  results.add_case(batch[1], std::uint32_t {1}, "Wrong batch scaling");
+  results.add_case(script.used(), std::size_t {5},
+                   "Rejected the wrong batch draws");
+
+  const std::size_t range {13};
+  const ehanc::bounded_dist dist(static_cast<std::uint32_t>(range));
+  const std::size_t num_samples {1'000'000};
+
+  const ehanc::histogram samples {parallel_samples(
+      num_samples, ehanc::histogram {range},
+      [&dist](const std::size_t count, ehanc::histogram& partial) {
+        sample_in_blocks<std::uint32_t>(
+            count,
+            [&dist](auto begin, auto end) {
+              dist(random_engine(), begin, end);
+            },
+            [&partial](const std::uint32_t value) {
+              partial.push(value);
+            });
+      })};
+  check_uniform(results, samples, range, "Batch");
+
+  return results;
+}
+
+static auto test_seed_random_engine() -> ehanc::test
+{
+  ehanc::test results;
+
+  const std::uint32_t seed {ehanc::current_test_seed()};
+  const std::size_t num_samples {64};
+
+  auto draw {[num_samples]() {
+    std::vector<int> retval;
+    for ( std::size_t i {0}; i != num_samples; ++i ) {
+      retval.push_back(get_part_count());
+      retval.push_back(get_new_ship_count());
+    }
+    return retval;
+  }};
+
+  seed_random_engine(seed);
+  const std::vector<int> first {draw()};
+  seed_random_engine(seed);
+  const std::vector<int> second {draw()};
+
+  results.add_case(first, second, "Same seed, different samples");
 
   return results;
 }
@@ -215,7 +574,14 @@ static auto test_get_random_faction() -> ehanc::test
 void test_random()
 {
   ehanc::run_test("get_part_count", &test_get_part_count);
+  ehanc::run_test("get_part_counts", &test_get_part_counts);
   ehanc::run_test("get_new_ship_count", &test_get_new_ship_count);
+  ehanc::run_test("get_new_ship_counts", &test_get_new_ship_counts);
   ehanc::run_test("random_select", &test_random_select);
   ehanc::run_test("get_random_faction", &test_get_random_faction);
+  ehanc::run_test("get_random_factions", &test_get_random_factions);
+  ehanc::run_test("ehanc::alias_table", &test_alias_table);
+  ehanc::run_test("ehanc::bounded_rand", &test_bounded_rand);
+  ehanc::run_test("ehanc::bounded_dist", &test_bounded_dist);
+  ehanc::run_test("seed_random_engine", &test_seed_random_engine);
 }
@@ -1,4 +1,7 @@
 #include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -77,8 +80,112 @@ static auto test_step() -> ehanc::test
   return results;
 }
 
+static auto test_bay_spec() -> ehanc::test
+{
+  ehanc::test results;
+
+  const std::optional<bay_spec> plain {bay_spec::parse("1")};
+  results.add_case(plain.has_value() && plain->factions
+                                            == ship::every_faction,
+                   true, "Plain bay does not accept every faction");
+
+  const std::optional<bay_spec> fast {
+      bay_spec::parse("2.5:klingon+romulan")};
+  results.add_case(fast.has_value(), true, "Failed to parse");
+  if ( fast.has_value() ) {
+    results.add_case(fast->accepts(ship::faction::klingon)
+                         && fast->accepts(ship::faction::romulan)
+                         && not fast->accepts(ship::faction::human),
+                     true, "Wrong factions");
+    results.add_case(fast->repair_time(10), 4, "Wrong sped up time");
+    results.add_case(fast->repair_time(1), 1, "Repair time below 1");
+  }
+
+  const std::optional<bay_spec> slow {bay_spec::parse("0.5")};
+  results.add_case(slow.has_value() && slow->repair_time(3) == 6, true,
+                   "Wrong slowed down time");
+
+  for ( const char* const bad :
+        {"", "0", "-1", "fast", "1:", "1:vulcan", "1:human+", "2x"} ) {
+    results.add_case(bay_spec::parse(bad).has_value(), false,
+                     std::string {"Parsed \""} + bad + "\"");
+  }
+
+  repair_bay bay(*fast);
+  ship sample {ship::construct_random_ship()};
+  const int expected_time {fast->repair_time(sample.repair_time())};
+  bay.dock(std::move(sample));
+  results.add_case(bay.time_remaining(), expected_time,
+                   "Bay ignores its speed");
+
+  return results;
+}
+
+static auto test_track_parts() -> ehanc::test
+{
+  ehanc::test results;
+
+  bay_spec spec {};
+  spec.track_parts = true;
+
+  for ( const double speed : {1.0, 0.5, 3.0} ) {
+    spec.speed = speed;
+    repair_bay bay(spec);
+
+    for ( int sample_index {0}; sample_index != 200; ++sample_index ) {
+      ship sample {ship::construct_random_ship()};
+      const std::size_t part_count {
+          sample.get_damaged_parts_list().size()};
+      const ship::id_type sample_id {sample.get_id()};
+
+      bay.dock(std::move(sample));
+      results.add_case(bay.last_finished_parts().size(), std::size_t {0},
+                       "Parts finished before any repair");
+
+      std::size_t finished {0};
+      int last_part_id {-1};
+      bool in_order {true};
+      bool right_ship {true};
+
+      while ( not bay.step() ) {
+        for ( const repair_bay::part_progress part :
+              bay.last_finished_parts() ) {
+          in_order = in_order && part.remaining == 0
+                     && static_cast<int>(part.id) > last_part_id;
+          last_part_id = part.id;
+        }
+        finished += bay.last_finished_parts().size();
+        right_ship = right_ship && bay.tracked_ship_id() == sample_id;
+      }
+
+      // The step the ship leaves in finishes whatever is left
+      for ( const repair_bay::part_progress part :
+            bay.last_finished_parts() ) {
+        in_order = in_order && part.remaining == 0
+                   && static_cast<int>(part.id) > last_part_id;
+        last_part_id = part.id;
+      }
+      finished += bay.last_finished_parts().size();
+
+      results.add_case(finished, part_count,
+                       "Parts left unfinished when the ship left");
+      results.add_case(in_order, true, "Parts finished out of order");
+      results.add_case(right_ship, true, "Parts credited to wrong ship");
+
+      // An empty bay finishes nothing
+      bay.step();
+      results.add_case(bay.last_finished_parts().size(), std::size_t {0},
+                       "Parts finished again in an empty bay");
+    }
+  }
+
+  return results;
+}
+
 void test_repair_bay()
 {
   ehanc::run_test("repair_bay::dock", &test_dock);
   ehanc::run_test("repair_bay::step", &test_step);
+  ehanc::run_test("bay_spec", &test_bay_spec);
+  ehanc::run_test("repair_bay part tracking", &test_track_parts);
 }
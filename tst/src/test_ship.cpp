@@ -1,7 +1,6 @@
 #include <algorithm>
 #include <cstddef>
 #include <iterator>
-#include <list>
 #include <numeric>
 #include <string>
 #include <vector>
@@ -16,20 +15,21 @@ auto test_create_damaged_part_list() -> ehanc::test
 {
   ehanc::test results;
 
-  const std::list<ship::part> human_list {
+  const part_set human_list {
       ship::create_damaged_part_list(ship::faction::human)};
-  const std::list<ship::part> ferengi_list {
+  const part_set ferengi_list {
       ship::create_damaged_part_list(ship::faction::ferengi)};
-  const std::list<ship::part> klingon_list {
+  const part_set klingon_list {
       ship::create_damaged_part_list(ship::faction::klingon)};
-  const std::list<ship::part> romulan_list {
+  const part_set romulan_list {
       ship::create_damaged_part_list(ship::faction::romulan)};
-  const std::list<ship::part> other_list {
+  const part_set other_list {
       ship::create_damaged_part_list(ship::faction::other)};
 
   // get_part_count() and random_select() already well tested
 
-  auto test_helper {[&results](const std::list<ship::part>& test_list,
+  auto test_helper {[&results](const part_set& test_list,
+                               const ship::faction fact,
                                const auto& valid_part_list,
                                const int severity_min,
                                const int severity_max,
@@ -54,6 +54,9 @@ auto test_create_damaged_part_list() -> ehanc::test
     results.add_case(std::adjacent_find(tmp_vec.cbegin(), tmp_vec.cend())
                          == tmp_vec.cend(),
                      true, "Part ID not all unique - " + faction_name);
+
+    results.add_case(test_list.is_subset_of(ship::valid_parts(fact)),
+                     true, "Part outside faction mask - " + faction_name);
   }};
 
   const std::string human {"human"};
@@ -62,23 +65,23 @@ auto test_create_damaged_part_list() -> ehanc::test
   const std::string romulan {"romulan"};
   const std::string other {"other"};
 
-  test_helper(human_list, conf::human_part_list, conf::human_severity_min,
-              conf::human_severity_max, human);
+  test_helper(human_list, ship::faction::human, conf::human_part_list,
+              conf::human_severity_min, conf::human_severity_max, human);
 
-  test_helper(ferengi_list, conf::ferengi_part_list,
-              conf::ferengi_severity_min, conf::ferengi_severity_max,
-              ferengi);
+  test_helper(ferengi_list, ship::faction::ferengi,
+              conf::ferengi_part_list, conf::ferengi_severity_min,
+              conf::ferengi_severity_max, ferengi);
 
-  test_helper(klingon_list, conf::klingon_part_list,
-              conf::klingon_severity_min, conf::klingon_severity_max,
-              klingon);
+  test_helper(klingon_list, ship::faction::klingon,
+              conf::klingon_part_list, conf::klingon_severity_min,
+              conf::klingon_severity_max, klingon);
 
-  test_helper(romulan_list, conf::romulan_part_list,
-              conf::romulan_severity_min, conf::romulan_severity_max,
-              romulan);
+  test_helper(romulan_list, ship::faction::romulan,
+              conf::romulan_part_list, conf::romulan_severity_min,
+              conf::romulan_severity_max, romulan);
 
-  test_helper(other_list, conf::other_part_list, conf::other_severity_min,
-              conf::other_severity_max, other);
+  test_helper(other_list, ship::faction::other, conf::other_part_list,
+              conf::other_severity_min, conf::other_severity_max, other);
 
   return results;
 }
@@ -97,7 +100,7 @@ auto test_construct_random_ship() -> ehanc::test
     samples.push_back(ship::construct_random_ship());
   }
 
-  int ref {conf::starting_ship_id - 1};
+  ship::id_type ref {conf::starting_ship_id - 1};
 
   using namespace ehanc::literals::size_t_literal;
   std::for_each(samples.begin(), samples.end(), [&](ship& sample) {
@@ -145,7 +148,7 @@ auto test_get_total_damage() -> ehanc::test
   }()}; // IILE
 
   std::for_each(samples.cbegin(), samples.cend(), [&](const ship& sample) {
-    const std::list<ship::part>& damaged_part_list {
+    const part_set& damaged_part_list {
         sample.get_damaged_parts_list()};
     const int actual_damage {[&]() -> int {
       std::vector<int> tmp_vec;
@@ -162,6 +165,32 @@ auto test_get_total_damage() -> ehanc::test
   return results;
 }
 
+auto test_clone() -> ehanc::test
+{
+  ehanc::test results;
+
+  for ( int i {0}; i < 1000; ++i ) {
+    const ship original {ship::construct_random_ship()};
+    const ship copy {original.clone()};
+
+    results.add_case(copy.get_id(), original.get_id(), "Different ID");
+    results.add_case(copy.get_faction() == original.get_faction(), true,
+                     "Different faction");
+    results.add_case(std::equal(copy.get_damaged_parts_list().cbegin(),
+                                copy.get_damaged_parts_list().cend(),
+                                original.get_damaged_parts_list().cbegin(),
+                                original.get_damaged_parts_list().cend(),
+                                [](const ship::part lhs,
+                                   const ship::part rhs) {
+                                  return lhs.id == rhs.id
+                                         && lhs.damage == rhs.damage;
+                                }),
+                     true, "Different damaged parts");
+  }
+
+  return results;
+}
+
 void test_ship()
 {
   ehanc::run_test("ship::create_damaged_part_list",
@@ -169,4 +198,5 @@ void test_ship()
   ehanc::run_test("ship::construct_random_ship",
                   &test_construct_random_ship);
   ehanc::run_test("ship::get_total_damage", &test_get_total_damage);
+  ehanc::run_test("ship::clone", &test_clone);
 }
@@ -0,0 +1,87 @@
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "utils/thread_pool.hpp"
+
+#include "test_ship_id_allocator.h"
+#include "test_utils.hpp"
+
+#include "constants.h"
+
+static auto test_reserve() -> ehanc::test
+{
+  ehanc::test results;
+
+  ship_id_allocator ids;
+
+  results.add_case(ids.peek(),
+                   ship_id_allocator::id_type {conf::starting_ship_id},
+                   "Does not start at conf::starting_ship_id");
+
+  ship_id_allocator::block first {ids.reserve(3)};
+  ship_id_allocator::block second {ids.reserve(2)};
+
+  results.add_case(first.size(), std::size_t {3}, "Wrong block size");
+
+  ship_id_allocator::id_type expected {conf::starting_ship_id};
+  for ( ship_id_allocator::block* block : {&first, &second} ) {
+    while ( not block->empty() ) {
+      results.add_case(block->take(), expected++, "Blocks not dense");
+    }
+  }
+
+  results.add_case(ids.next(), expected, "Single ID not after blocks");
+  results.add_case(ids.reserve(0).empty(), true,
+                   "Empty reservation not empty");
+
+  return results;
+}
+
+static auto test_concurrent_reserve() -> ehanc::test
+{
+  ehanc::test results;
+
+  const std::size_t task_count {8};
+  const std::size_t blocks_per_task {500};
+  const std::size_t block_size {7};
+
+  ship_id_allocator ids;
+  std::vector<std::vector<ship_id_allocator::id_type>> taken(task_count);
+
+  ehanc::thread_pool pool(4);
+  pool.run(task_count, [&](const std::size_t task) {
+    for ( std::size_t i {0}; i != blocks_per_task; ++i ) {
+      ship_id_allocator::block block {ids.reserve(block_size)};
+      while ( not block.empty() ) {
+        taken[task].push_back(block.take());
+      }
+    }
+  });
+
+  std::vector<ship_id_allocator::id_type> all;
+  for ( const auto& task_ids : taken ) {
+    all.insert(all.end(), task_ids.cbegin(), task_ids.cend());
+  }
+  std::sort(all.begin(), all.end());
+
+  // Every ID handed out exactly once, with no gaps
+  bool dense {true};
+  for ( std::size_t i {0}; i != all.size(); ++i ) {
+    dense = dense && all[i] == conf::starting_ship_id + i;
+  }
+
+  results.add_case(all.size(), task_count * blocks_per_task * block_size,
+                   "Wrong number of IDs");
+  results.add_case(dense, true, "IDs repeated or skipped");
+
+  return results;
+}
+
+void test_ship_id_allocator()
+{
+  ehanc::run_test("ship_id_allocator::reserve", &test_reserve);
+  ehanc::run_test("ship_id_allocator across threads",
+                  &test_concurrent_reserve);
+}
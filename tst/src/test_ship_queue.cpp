@@ -0,0 +1,470 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "utils/fenwick_tree.hpp"
+#include "utils/indexed_heap.hpp"
+
+#include "random.hpp"
+#include "test_ship_queue.h"
+#include "test_utils.hpp"
+
+static auto test_indexed_heap() -> ehanc::test
+{
+  ehanc::test results;
+
+  ehanc::indexed_heap<int> heap;
+  std::set<std::pair<int, std::size_t>> reference;
+  std::vector<int> keys(500);
+
+  std::uniform_int_distribution<int> key_dist(-50, 50);
+  std::uniform_int_distribution<std::size_t> id_dist(0, keys.size() - 1);
+
+  for ( int i {0}; i != 20'000; ++i ) {
+    const std::size_t id {id_dist(random_engine())};
+
+    if ( heap.contains(id) ) {
+      results.add_case(heap.erase(id), true, "Failed to erase");
+      reference.erase({keys[id], id});
+    } else {
+      keys[id] = key_dist(random_engine());
+      heap.push(id, keys[id]);
+      reference.insert({keys[id], id});
+    }
+
+    results.add_case(heap.size(), reference.size(), "Wrong size");
+    if ( not reference.empty() ) {
+      results.add_case(keys[heap.top()], reference.begin()->first,
+                       "Top is not the smallest key");
+    }
+  }
+
+  while ( not heap.empty() ) {
+    const int smallest {reference.begin()->first};
+    const std::size_t id {heap.pop()};
+    results.add_case(keys[id], smallest, "Popped out of order");
+    reference.erase({keys[id], id});
+  }
+
+  results.add_case(heap.erase(0), false, "Erased from an empty heap");
+
+  return results;
+}
+
+static auto test_fenwick_tree() -> ehanc::test
+{
+  ehanc::test results;
+
+  ehanc::fenwick_tree<std::int64_t> tree;
+  std::vector<std::int64_t> reference;
+
+  std::uniform_int_distribution<std::size_t> index_dist(0, 999);
+  std::uniform_int_distribution<std::int64_t> delta_dist(-20, 20);
+
+  for ( int i {0}; i != 5'000; ++i ) {
+    // Indices spread out over time, so the tree grows several times
+    const std::size_t index {index_dist(random_engine())
+                             % static_cast<std::size_t>(i + 1)};
+    const std::int64_t delta {delta_dist(random_engine())};
+
+    tree.add(index, delta);
+    if ( index >= reference.size() ) {
+      reference.resize(index + 1);
+    }
+    reference[index] += delta;
+
+    const std::size_t end {index_dist(random_engine())};
+    std::int64_t expected {0};
+    for ( std::size_t j {0}; j < end && j < reference.size(); ++j ) {
+      expected += reference[j];
+    }
+    results.add_case(tree.prefix_sum(end), expected, "Wrong prefix sum");
+  }
+
+  std::int64_t expected_total {0};
+  for ( const std::int64_t value : reference ) {
+    expected_total += value;
+  }
+  results.add_case(tree.total(), expected_total, "Wrong total");
+  results.add_case(tree.prefix_sum(tree.size() + 10), expected_total,
+                   "Prefix past the end is not the total");
+
+  return results;
+}
+
+// Order the queue should hand out ships in, as computed from scratch
+static auto expected_key(const ship_queue::policy order, const ship& s,
+                         const std::uint64_t arrival_step)
+    -> std::int64_t
+{
+  switch ( order ) {
+  case ship_queue::policy::fifo:
+    return 0;
+  case ship_queue::policy::shortest_first:
+    return s.repair_time();
+  case ship_queue::policy::longest_first:
+    return -s.repair_time();
+  case ship_queue::policy::faction_priority:
+    return conf::faction_priority[static_cast<std::size_t>(
+        s.get_faction())];
+  case ship_queue::policy::aging:
+    return s.repair_time()
+           + (conf::queue_aging_rate
+              * static_cast<std::int64_t>(arrival_step));
+  }
+  return 0;
+}
+
+static auto test_policies() -> ehanc::test
+{
+  ehanc::test results;
+
+  for ( const auto& [order, split] :
+        {std::pair {ship_queue::policy::fifo, false},
+         std::pair {ship_queue::policy::shortest_first, false},
+         std::pair {ship_queue::policy::fifo, true},
+         std::pair {ship_queue::policy::shortest_first, true},
+         std::pair {ship_queue::policy::longest_first, true},
+         std::pair {ship_queue::policy::faction_priority, true},
+         std::pair {ship_queue::policy::aging, true}} ) {
+    const std::string name {std::string {ship_queue::policy_name(order)}
+                            + (split ? " split" : "")};
+
+    ship_queue queue(order, split);
+
+    // (key, arrival order, ID) of every ship still waiting
+    std::vector<
+        std::tuple<std::int64_t, std::uint64_t, ship::id_type>>
+        waiting;
+    std::uint64_t arrivals {0};
+
+    for ( std::uint64_t step {1}; step != 400; ++step ) {
+      std::vector<ship> batch;
+      for ( int i {0}; i != 3; ++i ) {
+        batch.push_back(ship::construct_random_ship());
+        waiting.emplace_back(expected_key(order, batch.back(), step),
+                             arrivals++, batch.back().get_id());
+      }
+
+      queue.push(batch.begin(), batch.end(), step);
+
+      // Fewer leave than arrive, so the queue grows and slots are reused
+      for ( int i {0}; i != 2; ++i ) {
+        const auto next {
+            std::min_element(waiting.begin(), waiting.end())};
+
+        results.add_case(queue.front().get_id(), std::get<2>(*next),
+                         "Wrong front - " + name);
+        results.add_case(queue.pop().get_id(), std::get<2>(*next),
+                         "Popped out of order - " + name);
+
+        // Order does not matter, so the last ship takes its place
+        *next = waiting.back();
+        waiting.pop_back();
+
+        const auto newest {std::max_element(
+            waiting.cbegin(), waiting.cend(),
+            [](const auto& lhs, const auto& rhs) {
+              return std::get<1>(lhs) < std::get<1>(rhs);
+            })};
+        results.add_case(queue.back().get_id(), std::get<2>(*newest),
+                         "Back is not the newest arrival - " + name);
+      }
+
+      results.add_case(queue.size(), waiting.size(),
+                       "Wrong size - " + name);
+    }
+  }
+
+  for ( std::size_t i {0}; i != 5; ++i ) {
+    const auto order {static_cast<ship_queue::policy>(i)};
+    results.add_case(ship_queue::parse_policy(ship_queue::policy_name(
+                         order))
+                         == order,
+                     true, "Name does not parse back");
+  }
+
+  results.add_case(ship_queue::parse_policy("lifo").has_value(), false,
+                   "Parsed a policy which does not exist");
+
+  return results;
+}
+
+static auto test_faction_lanes() -> ehanc::test
+{
+  ehanc::test results;
+
+  ship_queue queue(ship_queue::policy::shortest_first, true);
+
+  std::vector<ship> batch;
+  for ( int i {0}; i != 200; ++i ) {
+    batch.push_back(ship::construct_random_ship());
+  }
+
+  // (key, arrival order, ID, faction) of every ship still waiting
+  std::vector<
+      std::tuple<int, std::size_t, ship::id_type, ship::faction>>
+      waiting;
+  for ( std::size_t i {0}; i != batch.size(); ++i ) {
+    waiting.emplace_back(batch[i].repair_time(), i, batch[i].get_id(),
+                         batch[i].get_faction());
+  }
+
+  queue.push(batch.begin(), batch.end(), 1);
+
+  const ship::faction_mask warships {static_cast<ship::faction_mask>(
+      ship::faction_bit(ship::faction::klingon)
+      | ship::faction_bit(ship::faction::romulan))};
+
+  // Only ever the best of the accepted factions, until there are none
+  while ( true ) {
+    const auto next {std::min_element(
+        waiting.cbegin(), waiting.cend(),
+        [warships](const auto& lhs, const auto& rhs) {
+          const bool lhs_ok {(warships
+                              & ship::faction_bit(std::get<3>(lhs)))
+                             != 0};
+          const bool rhs_ok {(warships
+                              & ship::faction_bit(std::get<3>(rhs)))
+                             != 0};
+          return lhs_ok != rhs_ok ? lhs_ok : lhs < rhs;
+        })};
+
+    const std::optional<ship> popped {queue.pop(warships)};
+
+    if ( next == waiting.cend()
+         || (warships & ship::faction_bit(std::get<3>(*next))) == 0 ) {
+      results.add_case(popped.has_value(), false,
+                       "Popped a ship of another faction");
+      break;
+    }
+
+    results.add_case(popped.has_value() && popped->get_id()
+                                               == std::get<2>(*next),
+                     true, "Wrong ship for the accepted factions");
+    waiting.erase(next);
+  }
+
+  results.add_case(queue.size(), waiting.size(), "Wrong size");
+
+  return results;
+}
+
+static auto test_totals() -> ehanc::test
+{
+  ehanc::test results;
+
+  for ( const auto& [order, split] :
+        {std::pair {ship_queue::policy::fifo, false},
+         std::pair {ship_queue::policy::aging, false},
+         std::pair {ship_queue::policy::fifo, true},
+         std::pair {ship_queue::policy::shortest_first, true}} ) {
+    const std::string name {std::string {ship_queue::policy_name(order)}
+                            + (split ? " split" : "")};
+
+    ship_queue queue(order, split);
+
+    // Every ship still waiting
+    std::vector<std::tuple<int, std::size_t, ship::faction>> waiting;
+
+    auto check {[&]() {
+      std::uint64_t hours {0};
+      std::uint64_t parts {0};
+      std::array<std::size_t, ship::faction_count> sizes {};
+      for ( const auto& [time, part_count, fact] : waiting ) {
+        hours += static_cast<std::uint64_t>(time);
+        parts += part_count;
+        ++sizes[static_cast<std::size_t>(fact)];
+      }
+
+      results.add_case(queue.repair_hours(), hours,
+                       "Wrong repair hours - " + name);
+      results.add_case(queue.part_count(), parts,
+                       "Wrong part count - " + name);
+      for ( std::size_t i {0}; i != ship::faction_count; ++i ) {
+        results.add_case(queue.size(static_cast<ship::faction>(i)),
+                         sizes[i], "Wrong faction size - " + name);
+      }
+    }};
+
+    const ship::faction_mask humans {
+        ship::faction_bit(ship::faction::human)};
+
+    for ( std::uint64_t step {1}; step != 200; ++step ) {
+      std::vector<ship> batch;
+      for ( int i {0}; i != 3; ++i ) {
+        batch.push_back(ship::construct_random_ship());
+        waiting.emplace_back(batch.back().repair_time(),
+                             batch.back().get_damaged_part_count(),
+                             batch.back().get_faction());
+      }
+      queue.push(batch.begin(), batch.end(), step);
+      check();
+
+      // Both kinds of pop take their ships off the totals
+      for ( const ship::faction_mask accepted :
+            {ship::every_faction, humans} ) {
+        const std::optional<ship> popped {queue.pop(accepted)};
+        if ( popped.has_value() ) {
+          waiting.erase(std::find(
+              waiting.cbegin(), waiting.cend(),
+              std::tuple {popped->repair_time(),
+                          popped->get_damaged_part_count(),
+                          popped->get_faction()}));
+        }
+        check();
+      }
+    }
+
+    while ( not queue.empty() ) {
+      static_cast<void>(queue.pop());
+    }
+    waiting.clear();
+    check();
+  }
+
+  return results;
+}
+
+static auto test_memory_footprint() -> ehanc::test
+{
+  ehanc::test results;
+
+  for ( const auto& [order, split] :
+        {std::pair {ship_queue::policy::fifo, false},
+         std::pair {ship_queue::policy::shortest_first, false},
+         std::pair {ship_queue::policy::faction_priority, true}} ) {
+    const std::string name {std::string {ship_queue::policy_name(order)}
+                            + (split ? " split" : "")};
+
+    ship_queue queue(order, split);
+    const std::size_t empty_bytes {queue.memory_footprint()};
+
+    std::vector<ship> arrivals;
+    for ( int i {0}; i != 10'000; ++i ) {
+      arrivals.push_back(ship::construct_random_ship());
+    }
+
+    // What the ships would take up if they waited whole
+    std::size_t ship_bytes {0};
+
+    const auto fill {[&](const std::uint64_t step) {
+      std::vector<ship> batch;
+      ship_bytes = 0;
+      for ( const ship& arriving : arrivals ) {
+        batch.push_back(arriving.clone());
+        ship_bytes += sizeof(ship) + batch.back().memory_footprint();
+      }
+      queue.push(batch.begin(), batch.end(), step);
+    }};
+    const auto drain {[&]() {
+      while ( not queue.empty() ) {
+        static_cast<void>(queue.pop());
+      }
+    }};
+
+    fill(1);
+    const std::size_t first_bytes {queue.memory_footprint()};
+    results.add_case(first_bytes > empty_bytes, true,
+                     "Waiting ships not counted - " + name);
+    results.add_case(first_bytes - empty_bytes < ship_bytes, true,
+                     "Waiting ships not split - " + name);
+
+    // After the first round, capacity and pages are kept, so the same
+    // ships come to the same bytes again
+    drain();
+    fill(2);
+    const std::size_t full_bytes {queue.memory_footprint()};
+    drain();
+    const std::size_t drained_bytes {queue.memory_footprint()};
+    results.add_case(drained_bytes <= full_bytes, true,
+                     "Docked ships still counted - " + name);
+    fill(3);
+    results.add_case(queue.memory_footprint(), full_bytes,
+                     "Refilled queue differs - " + name);
+    drain();
+    results.add_case(queue.memory_footprint(), drained_bytes,
+                     "Drained queue differs - " + name);
+  }
+
+  return results;
+}
+
+static auto test_work_ahead() -> ehanc::test
+{
+  ehanc::test results;
+
+  for ( const ship_queue::policy order :
+        {ship_queue::policy::fifo, ship_queue::policy::shortest_first,
+         ship_queue::policy::longest_first,
+         ship_queue::policy::faction_priority} ) {
+    const std::string name {ship_queue::policy_name(order)};
+
+    ship_queue queue(order);
+
+    // (key, repair time) of every ship still waiting
+    std::vector<std::pair<std::int64_t, int>> waiting;
+
+    for ( std::uint64_t step {1}; step != 300; ++step ) {
+      // A ship which might arrive next, and everything it would wait on
+      const ship candidate {ship::construct_random_ship()};
+      const std::int64_t candidate_key {
+          expected_key(order, candidate, step)};
+
+      ship_queue::work expected {};
+      for ( const auto& [key, time] : waiting ) {
+        if ( key <= candidate_key ) {
+          ++expected.ships;
+          expected.hours += static_cast<std::uint64_t>(time);
+        }
+      }
+
+      const ship_queue::work ahead {queue.work_ahead(candidate)};
+      results.add_case(ahead.ships, expected.ships,
+                       "Wrong ships ahead - " + name);
+      results.add_case(ahead.hours, expected.hours,
+                       "Wrong hours ahead - " + name);
+
+      std::vector<ship> batch;
+      for ( int i {0}; i != 2; ++i ) {
+        batch.push_back(ship::construct_random_ship());
+        waiting.emplace_back(expected_key(order, batch.back(), step),
+                             batch.back().repair_time());
+      }
+      queue.push(batch.begin(), batch.end(), step);
+
+      // Fewer leave than arrive, so the queue grows
+      if ( step % 2 == 0 ) {
+        const ship popped {queue.pop()};
+        const auto first {std::min_element(
+            waiting.cbegin(), waiting.cend(),
+            [](const auto& lhs, const auto& rhs) {
+              return lhs.first < rhs.first;
+            })};
+        results.add_case(popped.repair_time(), first->second,
+                         "Popped out of order - " + name);
+        waiting.erase(first);
+      }
+    }
+  }
+
+  return results;
+}
+
+void test_ship_queue()
+{
+  ehanc::run_test("ehanc::indexed_heap", &test_indexed_heap);
+  ehanc::run_test("ehanc::fenwick_tree", &test_fenwick_tree);
+  ehanc::run_test("ship_queue policies", &test_policies);
+  ehanc::run_test("ship_queue faction lanes", &test_faction_lanes);
+  ehanc::run_test("ship_queue totals", &test_totals);
+  ehanc::run_test("ship_queue::work_ahead", &test_work_ahead);
+  ehanc::run_test("ship_queue::memory_footprint", &test_memory_footprint);
+}
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "random.hpp"
+#include "test_ship_store.h"
+#include "test_utils.hpp"
+
+static auto same_parts(const part_set& lhs, const part_set& rhs) -> bool
+{
+  return std::equal(lhs.cbegin(), lhs.cend(), rhs.cbegin(), rhs.cend(),
+                    [](const part_set::part& a, const part_set::part& b) {
+                      return a.id == b.id && a.damage == b.damage;
+                    });
+}
+
+static auto test_round_trip() -> ehanc::test
+{
+  ehanc::test results;
+
+  ship_store store;
+  std::vector<ship> originals;
+  std::vector<ship_store::record> records;
+
+  for ( int i {0}; i != 5'000; ++i ) {
+    originals.push_back(ship::construct_random_ship());
+    records.push_back(store.store(originals.back().clone()));
+
+    const ship& original {originals.back()};
+    const ship_store::record& stored {records.back()};
+    results.add_case(stored.get_id(), original.get_id(), "Wrong ID");
+    results.add_case(stored.get_faction() == original.get_faction(), true,
+                     "Wrong faction");
+    results.add_case(stored.get_damaged_part_count(),
+                     original.get_damaged_part_count(),
+                     "Wrong part count");
+    results.add_case(stored.repair_time(), original.repair_time(),
+                     "Wrong repair time");
+
+    std::stringstream expected;
+    std::stringstream result;
+    expected << original;
+    result << stored;
+    results.add_case(result.str(), expected.str(), "Wrong display");
+  }
+
+  // Ships may be taken out in any order
+  std::vector<std::size_t> order(originals.size());
+  for ( std::size_t i {0}; i != order.size(); ++i ) {
+    order[i] = i;
+  }
+  std::shuffle(order.begin(), order.end(), random_engine());
+
+  for ( const std::size_t i : order ) {
+    results.add_case(
+        same_parts(store.parts(records[i]),
+                   originals[i].get_damaged_parts_list()),
+        true, "Parts changed while stored");
+
+    const ship taken {store.take(records[i])};
+    results.add_case(taken.get_id(), originals[i].get_id(),
+                     "Took the wrong ship");
+    results.add_case(taken.get_faction() == originals[i].get_faction(),
+                     true, "Faction changed");
+    results.add_case(same_parts(taken.get_damaged_parts_list(),
+                                originals[i].get_damaged_parts_list()),
+                     true, "Parts changed");
+  }
+
+  return results;
+}
+
+static auto test_page_recycling() -> ehanc::test
+{
+  ehanc::test results;
+
+  ship_store store;
+  std::vector<ship_store::record> records;
+
+  // Rounds store the same ships in the same order, so they pack the same
+  std::vector<ship> pool;
+  for ( int i {0}; i != 20'000; ++i ) {
+    pool.push_back(ship::construct_random_ship());
+  }
+  std::size_t cursor {0};
+
+  const auto fill {[&](const int count) {
+    for ( int i {0}; i != count; ++i ) {
+      records.push_back(store.store(pool[cursor].clone()));
+      cursor = (cursor + 1) % pool.size();
+    }
+  }};
+
+  // Enough ships to spread over several pages
+  fill(20'000);
+  const std::size_t pages {store.page_count()};
+  results.add_case(pages > 1, true, "Ships did not fill several pages");
+
+  // Taking every ship out frees every page, in whatever order they go
+  std::shuffle(records.begin(), records.end(), random_engine());
+  for ( const ship_store::record& stored : records ) {
+    static_cast<void>(store.take(stored));
+  }
+  records.clear();
+
+  for ( int round {0}; round != 3; ++round ) {
+    cursor = 0;
+    fill(20'000);
+    results.add_case(store.page_count() <= pages + 1, true,
+                     "Pages not recycled");
+
+    // First come, first served, with arrivals all along, which keeps
+    // partly filled pages at either end
+    std::size_t next {0};
+    for ( int i {0}; i != 50'000; ++i ) {
+      static_cast<void>(store.take(records[next++]));
+      fill(1);
+    }
+    results.add_case(store.page_count() <= pages + 1, true,
+                     "Pages not recycled in order");
+
+    for ( ; next != records.size(); ++next ) {
+      static_cast<void>(store.take(records[next]));
+    }
+    records.clear();
+  }
+
+  return results;
+}
+
+void test_ship_store()
+{
+  ehanc::run_test("ship_store round trip", &test_round_trip);
+  ehanc::run_test("ship_store page recycling", &test_page_recycling);
+}
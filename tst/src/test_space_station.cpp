@@ -1,5 +1,11 @@
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <sstream>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "utils/etc.hpp"
 
@@ -43,7 +49,287 @@ static auto test_step() -> ehanc::test
   return results;
 }
 
+static auto test_step_with_arrivals() -> ehanc::test
+{
+  using namespace ehanc::literals::size_t_literal;
+
+  ehanc::test results;
+
+  space_station test("Guinea Pig");
+
+  const std::size_t arrival_count {10};
+
+  std::vector<ship> arrivals;
+  arrivals.reserve(arrival_count);
+  for ( std::size_t i {0}; i != arrival_count; ++i ) {
+    arrivals.push_back(ship::construct_random_ship());
+  }
+
+  const ship::id_type front_id {arrivals.front().get_id()};
+
+  // The first arrivals all dock right away
+  long expected_time_remaining {0};
+  for ( int i {0}; i != conf::num_repair_bays; ++i ) {
+    expected_time_remaining += conf::severity_to_time(
+        arrivals[static_cast<std::size_t>(i)].get_total_damage());
+  }
+
+  auto [new_ships, leaving_ships] =
+      test.step(arrivals.begin(), arrivals.end());
+
+  results.add_case(new_ships, arrival_count, "Wrong arrival count");
+  results.add_case(leaving_ships, 0_z, "Ships left on first step");
+  results.add_case(test.occupied_bay_count(), conf::num_repair_bays,
+                   "Not all bays filled");
+  results.add_case(test.queue_size(),
+                   arrival_count
+                       - static_cast<std::size_t>(conf::num_repair_bays),
+                   "Wrong queue size");
+  results.add_case(test.total_bay_time_remaining(),
+                   expected_time_remaining, "Wrong bay time remaining");
+
+  std::stringstream report;
+  test.display(report);
+  results.add_case(report.str().find("Ship " + std::to_string(front_id))
+                       != std::string::npos,
+                   true, "First arrival not docked in first bay");
+
+  // No arrivals at all
+  const space_station::step_summary empty_step {
+      test.step(arrivals.end(), arrivals.end())};
+
+  results.add_case(empty_step.new_ships, 0_z,
+                   "Arrivals from an empty range");
+
+  return results;
+}
+
+static auto test_specialized_bays() -> ehanc::test
+{
+  ehanc::test results;
+
+  // Only the second bay takes Klingons, and nobody else takes them
+  const std::vector<bay_spec> bays {
+      *bay_spec::parse("1:human+ferengi+romulan+other"),
+      *bay_spec::parse("1:klingon")};
+
+  space_station test("Guinea Pig", bays);
+
+  std::vector<ship> arrivals;
+  arrivals.emplace_back(ship::faction::klingon);
+  arrivals.emplace_back(ship::faction::klingon);
+  arrivals.emplace_back(ship::faction::human);
+
+  test.step(arrivals.begin(), arrivals.end());
+
+  // One Klingon waits, even though the human got the first bay
+  results.add_case(test.occupied_bay_count(), 2, "Wrong bays filled");
+  results.add_case(test.queue_size(), std::size_t {1},
+                   "Wrong queue size");
+
+  // The first bay never takes the waiting Klingon
+  for ( int i {0}; i != 100 && test.queue_size() != 0; ++i ) {
+    test.step(arrivals.end(), arrivals.end());
+
+    std::stringstream report;
+    test.display(report);
+    const std::string text {report.str()};
+    const std::size_t first_bay {text.find("Repair Bay #1")};
+    const std::size_t second_bay {text.find("Repair Bay #2")};
+
+    results.add_case(text.substr(first_bay, second_bay - first_bay)
+                             .find("Klingon")
+                         == std::string::npos,
+                     true, "Klingon docked in the wrong bay");
+  }
+
+  return results;
+}
+
+static auto test_part_events() -> ehanc::test
+{
+  ehanc::test results;
+
+  bay_spec tracked {};
+  tracked.track_parts = true;
+  space_station test("Guinea Pig", std::vector<bay_spec>(4, tracked),
+                     ship_queue::policy::fifo);
+
+  std::vector<ship> arrivals;
+  std::size_t part_count {0};
+  for ( std::size_t i {0}; i != 20; ++i ) {
+    arrivals.push_back(ship::construct_random_ship());
+    part_count += arrivals.back().get_damaged_parts_list().size();
+  }
+
+  test.step(arrivals.begin(), arrivals.end());
+  std::size_t events {test.last_part_events().size()};
+  while ( test.occupied_bay_count() != 0 || test.queue_size() != 0 ) {
+    test.step(arrivals.end(), arrivals.end());
+    events += test.last_part_events().size();
+  }
+
+  results.add_case(events, part_count,
+                   "Not one event for every damaged part");
+
+  std::stringstream report;
+  test.display(report);
+  results.add_case(report.str().find("parts repaired")
+                       != std::string::npos,
+                   true, "Report does not count parts");
+
+  return results;
+}
+
+static auto test_predict() -> ehanc::test
+{
+  ehanc::test results;
+
+  space_station test("Guinea Pig", 3);
+
+  // Idle bays take the ship right away
+  const ship candidate {ship::construct_random_ship()};
+  const space_station::prediction idle {test.predict(candidate)};
+  results.add_case(idle.dock_hour, std::uint64_t {1},
+                   "Not docked at once by an idle bay");
+  results.add_case(idle.departure_hour - idle.dock_hour,
+                   static_cast<std::uint64_t>(candidate.repair_time()),
+                   "Wrong repair time");
+
+  // Fill every bay, and queue one more ship
+  std::vector<ship> arrivals;
+  std::vector<std::uint64_t> free_hours;
+  for ( int i {0}; i != 4; ++i ) {
+    arrivals.push_back(ship::construct_random_ship());
+    free_hours.push_back(
+        1 + static_cast<std::uint64_t>(arrivals.back().repair_time()));
+  }
+  free_hours.pop_back();
+  std::sort(free_hours.begin(), free_hours.end());
+
+  test.step(arrivals.begin(), std::prev(arrivals.end()));
+  results.add_case(test.predict(candidate).dock_hour, free_hours[0],
+                   "Not docked when the first bay frees up");
+
+  test.step(std::prev(arrivals.end()), arrivals.end());
+  if ( test.queue_size() == 1 ) {
+    results.add_case(test.predict(candidate).dock_hour, free_hours[1],
+                     "Not docked when the second bay frees up");
+  }
+
+  // Predictions stay close to what happens, while the queue grows
+  space_station checked("Guinea Pig", 6);
+  checked.check_predictions(true);
+  for ( int i {0}; i != 3'000; ++i ) {
+    checked.step();
+  }
+
+  const space_station::prediction_stats& accuracy {
+      checked.prediction_accuracy()};
+  results.add_case(accuracy.ships > 1'000, true, "Too few predictions");
+  results.add_case(accuracy.mean_abs_error() < 5.0, true,
+                   "Predictions off by "
+                       + std::to_string(accuracy.mean_abs_error())
+                       + " hours");
+
+  return results;
+}
+
+// Runs the same arrivals through a station stepping its bays serially,
+// and one stepping them in shards
+static void compare_sharded(const std::vector<bay_spec>& bays,
+                            ehanc::test& results)
+{
+  const std::size_t bay_count {bays.size()};
+
+  space_station serial("Guinea Pig", bays, ship_queue::policy::fifo,
+                       bay_count + 1);
+  space_station sharded("Guinea Pig", bays, ship_queue::policy::fifo, 0);
+
+  std::vector<ship> arrivals;
+  std::vector<ship> copies;
+
+  for ( std::size_t step {0}; step != 60; ++step ) {
+    // A flood which overfills the bays, then a trickle
+    const std::size_t arrival_count {step == 0 ? bay_count + 5000 : 50};
+
+    arrivals.clear();
+    copies.clear();
+    for ( std::size_t i {0}; i != arrival_count; ++i ) {
+      arrivals.push_back(ship::construct_random_ship());
+      copies.push_back(arrivals.back().clone());
+    }
+
+    const space_station::step_summary expected {
+        serial.step(arrivals.begin(), arrivals.end())};
+    const space_station::step_summary actual {
+        sharded.step(copies.begin(), copies.end())};
+
+    results.add_case(actual.leaving_ships, expected.leaving_ships,
+                     "Different ships left");
+    results.add_case(sharded.queue_size(), serial.queue_size(),
+                     "Different queue size");
+    results.add_case(sharded.total_bay_time_remaining(),
+                     serial.total_bay_time_remaining(),
+                     "Different bay time remaining");
+    results.add_case(sharded.last_part_events().size(),
+                     serial.last_part_events().size(),
+                     "Different parts repaired");
+    results.add_case(
+        std::equal(sharded.last_part_events().cbegin(),
+                   sharded.last_part_events().cend(),
+                   serial.last_part_events().cbegin(),
+                   serial.last_part_events().cend(),
+                   [](const space_station::part_event& lhs,
+                      const space_station::part_event& rhs) {
+                     return lhs.bay == rhs.bay
+                            && lhs.ship_id == rhs.ship_id
+                            && lhs.part_id == rhs.part_id;
+                   }),
+        true, "Different part events");
+  }
+
+  // Every bay holds the very same ship
+  std::stringstream expected_report;
+  std::stringstream actual_report;
+  serial.display(expected_report);
+  sharded.display(actual_report);
+  results.add_case(actual_report.str() == expected_report.str(), true,
+                   "Different reports");
+}
+
+static auto test_sharded_bays() -> ehanc::test
+{
+  ehanc::test results;
+
+  // More than one shard, with the last one partly filled
+  const std::size_t bay_count {(2 * conf::bay_shard_size) + 100};
+  compare_sharded(std::vector<bay_spec>(bay_count), results);
+
+  // Some bays turn ships away
+  std::vector<bay_spec> specialized(bay_count);
+  for ( std::size_t i {0}; i < bay_count; i += 3 ) {
+    specialized[i] = *bay_spec::parse("2:klingon");
+  }
+  compare_sharded(specialized, results);
+
+  // Every bay reports its parts
+  for ( bay_spec& spec : specialized ) {
+    spec.track_parts = true;
+  }
+  compare_sharded(specialized, results);
+
+  return results;
+}
+
 void test_space_station()
 {
   ehanc::run_test("space_station::step", &test_step);
+  ehanc::run_test("space_station::step(first, last)",
+                  &test_step_with_arrivals);
+  ehanc::run_test("space_station specialized bays",
+                  &test_specialized_bays);
+  ehanc::run_test("space_station part events", &test_part_events);
+  ehanc::run_test("space_station::predict", &test_predict);
+  ehanc::run_test("space_station sharded bays", &test_sharded_bays);
 }